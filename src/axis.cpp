@@ -78,6 +78,7 @@ QCPGrid::QCPGrid(QCPAxis *parentAxis) :
 void QCPGrid::setSubGridVisible(bool visible)
 {
   mSubGridVisible = visible;
+  markLayerDirty();
 }
 
 /*!
@@ -86,6 +87,7 @@ void QCPGrid::setSubGridVisible(bool visible)
 void QCPGrid::setAntialiasedSubGrid(bool enabled)
 {
   mAntialiasedSubGrid = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -94,6 +96,7 @@ void QCPGrid::setAntialiasedSubGrid(bool enabled)
 void QCPGrid::setAntialiasedZeroLine(bool enabled)
 {
   mAntialiasedZeroLine = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -102,6 +105,7 @@ void QCPGrid::setAntialiasedZeroLine(bool enabled)
 void QCPGrid::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -110,6 +114,7 @@ void QCPGrid::setPen(const QPen &pen)
 void QCPGrid::setSubGridPen(const QPen &pen)
 {
   mSubGridPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -121,6 +126,7 @@ void QCPGrid::setSubGridPen(const QPen &pen)
 void QCPGrid::setZeroLinePen(const QPen &pen)
 {
   mZeroLinePen = pen;
+  markLayerDirty();
 }
 
 /*! \internal
@@ -410,10 +416,12 @@ QCPAxis::QCPAxis(QCPAxisRect *parent, AxisType type) :
   // internal members:
   mGrid(new QCPGrid(this)),
   mAxisPainter(new QCPAxisPainterPrivate(parent->parentPlot())),
+  mDateTimeFormatter(new QCPDateTimeFormatterPrivate(mDateTimeFormat, mDateTimeSpec)),
   mLowestVisibleTick(0),
   mHighestVisibleTick(-1),
   mCachedMarginValid(false),
-  mCachedMargin(0)
+  mCachedMargin(0),
+  mCachedMarginHasTicks(false)
 {
   mGrid->setVisible(false);
   setAntialiased(false);
@@ -441,6 +449,7 @@ QCPAxis::QCPAxis(QCPAxisRect *parent, AxisType type) :
 QCPAxis::~QCPAxis()
 {
   delete mAxisPainter;
+  delete mDateTimeFormatter;
 }
 
 /* No documentation as it is a property getter */
@@ -582,7 +591,6 @@ void QCPAxis::setRange(const QCPRange &range)
   {
     mRange = range.sanitizedForLinScale();
   }
-  mCachedMarginValid = false;
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -628,6 +636,7 @@ void QCPAxis::setSelectedParts(const SelectableParts &selected)
     mSelectedParts = selected;
     emit selectionChanged(mSelectedParts);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -655,7 +664,6 @@ void QCPAxis::setRange(double lower, double upper)
   {
     mRange = mRange.sanitizedForLinScale();
   }
-  mCachedMarginValid = false;
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -699,7 +707,6 @@ void QCPAxis::setRangeLower(double lower)
   {
     mRange = mRange.sanitizedForLinScale();
   }
-  mCachedMarginValid = false;
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -722,7 +729,6 @@ void QCPAxis::setRangeUpper(double upper)
   {
     mRange = mRange.sanitizedForLinScale();
   }
-  mCachedMarginValid = false;
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -767,6 +773,7 @@ void QCPAxis::setAutoTicks(bool on)
     mAutoTicks = on;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -791,6 +798,7 @@ void QCPAxis::setAutoTickCount(int approximateCount)
     } else
       qDebug() << Q_FUNC_INFO << "approximateCount must be greater than zero:" << approximateCount;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -815,6 +823,7 @@ void QCPAxis::setAutoTickLabels(bool on)
     mAutoTickLabels = on;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -836,6 +845,7 @@ void QCPAxis::setAutoTickStep(bool on)
     mAutoTickStep = on;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -854,6 +864,7 @@ void QCPAxis::setAutoSubTicks(bool on)
     mAutoSubTicks = on;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -869,6 +880,7 @@ void QCPAxis::setTicks(bool show)
     mTicks = show;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -881,6 +893,7 @@ void QCPAxis::setTickLabels(bool show)
     mTickLabels = show;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -894,6 +907,7 @@ void QCPAxis::setTickLabelPadding(int padding)
     mAxisPainter->tickLabelPadding = padding;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -924,6 +938,7 @@ void QCPAxis::setTickLabelType(LabelType type)
     mTickLabelType = type;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -938,6 +953,7 @@ void QCPAxis::setTickLabelFont(const QFont &font)
     mTickLabelFont = font;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -952,6 +968,7 @@ void QCPAxis::setTickLabelColor(const QColor &color)
     mTickLabelColor = color;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -970,6 +987,7 @@ void QCPAxis::setTickLabelRotation(double degrees)
     mAxisPainter->tickLabelRotation = qBound(-90.0, degrees, 90.0);
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -985,8 +1003,10 @@ void QCPAxis::setDateTimeFormat(const QString &format)
   if (mDateTimeFormat != format)
   {
     mDateTimeFormat = format;
+    mDateTimeFormatter->setFormat(format);
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1002,6 +1022,8 @@ void QCPAxis::setDateTimeFormat(const QString &format)
 void QCPAxis::setDateTimeSpec(const Qt::TimeSpec &timeSpec)
 {
   mDateTimeSpec = timeSpec;
+  mDateTimeFormatter->setTimeSpec(timeSpec);
+  markLayerDirty();
 }
 
 /*!
@@ -1048,6 +1070,7 @@ void QCPAxis::setNumberFormat(const QString &formatCode)
     return;
   }
   mCachedMarginValid = false;
+  markLayerDirty();
   
   // interpret first char as number format char:
   QString allowedFormatChars = "eEfgG";
@@ -1113,6 +1136,7 @@ void QCPAxis::setNumberPrecision(int precision)
     mNumberPrecision = precision;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1127,6 +1151,7 @@ void QCPAxis::setTickStep(double step)
     mTickStep = step;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1147,6 +1172,7 @@ void QCPAxis::setTickVector(const QVector<double> &vec)
   // don't check whether mTickVector != vec here, because it takes longer than we would save
   mTickVector = vec;
   mCachedMarginValid = false;
+  markLayerDirty();
 }
 
 /*!
@@ -1165,6 +1191,7 @@ void QCPAxis::setTickVectorLabels(const QVector<QString> &vec)
   // don't check whether mTickVectorLabels != vec here, because it takes longer than we would save
   mTickVectorLabels = vec;
   mCachedMarginValid = false;
+  markLayerDirty();
 }
 
 /*!
@@ -1179,6 +1206,7 @@ void QCPAxis::setTickLength(int inside, int outside)
 {
   setTickLengthIn(inside);
   setTickLengthOut(outside);
+  markLayerDirty();
 }
 
 /*!
@@ -1193,6 +1221,7 @@ void QCPAxis::setTickLengthIn(int inside)
   {
     mAxisPainter->tickLengthIn = inside;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1209,6 +1238,7 @@ void QCPAxis::setTickLengthOut(int outside)
     mAxisPainter->tickLengthOut = outside;
     mCachedMarginValid = false; // only outside tick length can change margin
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1225,6 +1255,7 @@ void QCPAxis::setTickLengthOut(int outside)
 void QCPAxis::setSubTickCount(int count)
 {
   mSubTickCount = count;
+  markLayerDirty();
 }
 
 /*!
@@ -1239,6 +1270,7 @@ void QCPAxis::setSubTickLength(int inside, int outside)
 {
   setSubTickLengthIn(inside);
   setSubTickLengthOut(outside);
+  markLayerDirty();
 }
 
 /*!
@@ -1253,6 +1285,7 @@ void QCPAxis::setSubTickLengthIn(int inside)
   {
     mAxisPainter->subTickLengthIn = inside;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1269,6 +1302,7 @@ void QCPAxis::setSubTickLengthOut(int outside)
     mAxisPainter->subTickLengthOut = outside;
     mCachedMarginValid = false; // only outside tick length can change margin
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1279,6 +1313,7 @@ void QCPAxis::setSubTickLengthOut(int outside)
 void QCPAxis::setBasePen(const QPen &pen)
 {
   mBasePen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -1289,6 +1324,7 @@ void QCPAxis::setBasePen(const QPen &pen)
 void QCPAxis::setTickPen(const QPen &pen)
 {
   mTickPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -1299,6 +1335,7 @@ void QCPAxis::setTickPen(const QPen &pen)
 void QCPAxis::setSubTickPen(const QPen &pen)
 {
   mSubTickPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -1313,6 +1350,7 @@ void QCPAxis::setLabelFont(const QFont &font)
     mLabelFont = font;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1323,6 +1361,7 @@ void QCPAxis::setLabelFont(const QFont &font)
 void QCPAxis::setLabelColor(const QColor &color)
 {
   mLabelColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -1336,6 +1375,7 @@ void QCPAxis::setLabel(const QString &str)
     mLabel = str;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1350,6 +1390,7 @@ void QCPAxis::setLabelPadding(int padding)
     mAxisPainter->labelPadding = padding;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1369,6 +1410,7 @@ void QCPAxis::setPadding(int padding)
     mPadding = padding;
     mCachedMarginValid = false;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1382,6 +1424,7 @@ void QCPAxis::setPadding(int padding)
 void QCPAxis::setOffset(int offset)
 {
   mAxisPainter->offset = offset;
+  markLayerDirty();
 }
 
 /*!
@@ -1396,6 +1439,7 @@ void QCPAxis::setSelectedTickLabelFont(const QFont &font)
     mSelectedTickLabelFont = font;
     // don't set mCachedMarginValid to false here because margin calculation is always done with non-selected fonts
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1407,6 +1451,7 @@ void QCPAxis::setSelectedLabelFont(const QFont &font)
 {
   mSelectedLabelFont = font;
   // don't set mCachedMarginValid to false here because margin calculation is always done with non-selected fonts
+  markLayerDirty();
 }
 
 /*!
@@ -1420,6 +1465,7 @@ void QCPAxis::setSelectedTickLabelColor(const QColor &color)
   {
     mSelectedTickLabelColor = color;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1430,6 +1476,7 @@ void QCPAxis::setSelectedTickLabelColor(const QColor &color)
 void QCPAxis::setSelectedLabelColor(const QColor &color)
 {
   mSelectedLabelColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -1440,6 +1487,7 @@ void QCPAxis::setSelectedLabelColor(const QColor &color)
 void QCPAxis::setSelectedBasePen(const QPen &pen)
 {
   mSelectedBasePen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -1450,6 +1498,7 @@ void QCPAxis::setSelectedBasePen(const QPen &pen)
 void QCPAxis::setSelectedTickPen(const QPen &pen)
 {
   mSelectedTickPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -1460,6 +1509,7 @@ void QCPAxis::setSelectedTickPen(const QPen &pen)
 void QCPAxis::setSelectedSubTickPen(const QPen &pen)
 {
   mSelectedSubTickPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -1475,6 +1525,7 @@ void QCPAxis::setSelectedSubTickPen(const QPen &pen)
 void QCPAxis::setLowerEnding(const QCPLineEnding &ending)
 {
   mAxisPainter->lowerEnding = ending;
+  markLayerDirty();
 }
 
 /*!
@@ -1490,6 +1541,7 @@ void QCPAxis::setLowerEnding(const QCPLineEnding &ending)
 void QCPAxis::setUpperEnding(const QCPLineEnding &ending)
 {
   mAxisPainter->upperEnding = ending;
+  markLayerDirty();
 }
 
 /*!
@@ -1511,7 +1563,6 @@ void QCPAxis::moveRange(double diff)
     mRange.lower *= diff;
     mRange.upper *= diff;
   }
-  mCachedMarginValid = false;
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -1544,7 +1595,6 @@ void QCPAxis::scaleRange(double factor, double center)
     } else
       qDebug() << Q_FUNC_INFO << "Center of scaling operation doesn't lie in same logarithmic sign domain as range:" << center;
   }
-  mCachedMarginValid = false;
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -1578,6 +1628,7 @@ void QCPAxis::setScaleRatio(const QCPAxis *otherAxis, double ratio)
   
   double newRangeSize = ratio*otherAxis->range().size()*ownPixelSize/(double)otherPixelSize;
   setRange(range().center(), newRangeSize, Qt::AlignCenter);
+  markLayerDirty();
 }
 
 /*!
@@ -1933,21 +1984,34 @@ void QCPAxis::setupTickVectors()
   {
     int vecsize = mTickVector.size();
     mTickVectorLabels.resize(vecsize);
-    if (mTickLabelType == ltNumber)
+    // labels of ticks that were already visible in the previous call (e.g. during a range drag) are
+    // reused, as long as the formatting parameters didn't change. Only new ticks are formatted:
+    QByteArray labelParameters = tickLabelParameters();
+    if (labelParameters != mLabeledTickParameters)
     {
-      for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
-        mTickVectorLabels[i] = mParentPlot->locale().toString(mTickVector.at(i), mNumberFormatChar, mNumberPrecision);
-    } else if (mTickLabelType == ltDateTime)
+      mLabeledTicks.clear();
+      mLabeledTickLabels.clear();
+      mLabeledTickParameters = labelParameters;
+    }
+    QVector<double> labeledTicks;
+    QVector<QString> labeledTickLabels;
+    labeledTicks.reserve(qMax(0, mHighestVisibleTick-mLowestVisibleTick+1));
+    labeledTickLabels.reserve(labeledTicks.capacity());
+    int reuseIndex = 0;
+    for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
     {
-      for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
-      {
-#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0) // use fromMSecsSinceEpoch function if available, to gain sub-second accuracy on tick labels (e.g. for format "hh:mm:ss:zzz")
-        mTickVectorLabels[i] = mParentPlot->locale().toString(QDateTime::fromTime_t(mTickVector.at(i)).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
-#else
-        mTickVectorLabels[i] = mParentPlot->locale().toString(QDateTime::fromMSecsSinceEpoch(mTickVector.at(i)*1000).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
-#endif
-      }
+      const double tick = mTickVector.at(i);
+      while (reuseIndex < mLabeledTicks.size() && mLabeledTicks.at(reuseIndex) < tick) // both vectors are ascending, so a single pass finds all matches
+        ++reuseIndex;
+      if (reuseIndex < mLabeledTicks.size() && mLabeledTicks.at(reuseIndex) == tick)
+        mTickVectorLabels[i] = mLabeledTickLabels.at(reuseIndex);
+      else
+        mTickVectorLabels[i] = formatTickLabel(tick);
+      labeledTicks.append(tick);
+      labeledTickLabels.append(mTickVectorLabels.at(i));
     }
+    mLabeledTicks = labeledTicks;
+    mLabeledTickLabels = labeledTickLabels;
   } else // mAutoTickLabels == false
   {
     if (mAutoTicks) // ticks generated automatically, but not ticklabels, so emit ticksRequest here for labels
@@ -1957,6 +2021,9 @@ void QCPAxis::setupTickVectors()
     // make sure provided tick label vector has correct (minimal) length:
     if (mTickVectorLabels.size() < mTickVector.size())
       mTickVectorLabels.resize(mTickVector.size());
+    // labels are provided externally, so the ones generated previously mustn't be reused later:
+    mLabeledTicks.clear();
+    mLabeledTickLabels.clear();
   }
 }
 
@@ -2244,6 +2311,49 @@ void QCPAxis::visibleTickBounds(int &lowIndex, int &highIndex) const
     highIndex = lowIndex-1;
 }
 
+/*! \internal
+  
+  Returns the tick label for the tick at coordinate \a tick, formatted according to the tick label
+  type (\ref setTickLabelType) and the respective number or date time format. Date time labels are
+  generated by the internal QCPDateTimeFormatterPrivate instance.
+  
+  \see setupTickVectors
+*/
+QString QCPAxis::formatTickLabel(double tick) const
+{
+  if (mTickLabelType == ltDateTime)
+    return mDateTimeFormatter->toString(tick, mParentPlot->locale());
+  else
+    return mParentPlot->locale().toString(tick, mNumberFormatChar, mNumberPrecision);
+}
+
+/*! \internal
+  
+  Returns a byte array that identifies all parameters which influence the result of \ref
+  formatTickLabel. \ref setupTickVectors compares it with the parameters of the previous call, to
+  determine whether already formatted tick labels may be reused.
+*/
+QByteArray QCPAxis::tickLabelParameters() const
+{
+  QByteArray result;
+  result.append(QByteArray::number((int)mTickLabelType));
+  result.append(' ');
+  if (mTickLabelType == ltDateTime)
+  {
+    result.append(mDateTimeFormat.toUtf8());
+    result.append(' ');
+    result.append(QByteArray::number((int)mDateTimeSpec));
+  } else
+  {
+    result.append(mNumberFormatChar);
+    result.append(QByteArray::number(mNumberPrecision));
+  }
+  result.append(' ');
+  result.append(mParentPlot->locale().name().toLatin1());
+  result.append(QByteArray::number((int)mParentPlot->locale().numberOptions()));
+  return result;
+}
+
 /*! \internal
   
   A log function with the base mScaleLogBase, used mostly for coordinate transforms in logarithmic
@@ -2350,34 +2460,39 @@ QColor QCPAxis::getLabelColor() const
   The margin consists of the outward tick length, tick label padding, tick label size, label
   padding, label size, and padding.
   
-  The margin is cached internally, so repeated calls while leaving the axis range, fonts, etc.
-  unchanged are very fast.
+  The margin is cached internally, so repeated calls while leaving fonts, paddings, etc. unchanged
+  are very fast. Range changes only require a new calculation if they change the visible tick
+  labels.
 */
 int QCPAxis::calculateMargin()
 {
   if (!mVisible) // if not visible, directly return 0, don't cache 0 because we can't react to setVisible in QCPAxis
     return 0;
   
-  if (mCachedMarginValid)
+  // the range only influences the margin via the visible ticks, so range changes don't invalidate
+  // the cached margin. Instead it is reused as long as the visible tick labels stay the same:
+  int lowTick, highTick;
+  visibleTickBounds(lowTick, highTick);
+  const bool hasTicks = mTicks && lowTick <= highTick;
+  QVector<QString> tickLabels; // the final vector passed to QCPAxisPainter
+  if (hasTicks && mTickLabels)
+  {
+    tickLabels.reserve(highTick-lowTick+1);
+    for (int i=lowTick; i<=highTick; ++i)
+      tickLabels.append(mTickVectorLabels.at(i));
+  }
+  if (mCachedMarginValid && hasTicks == mCachedMarginHasTicks && tickLabels == mCachedMarginTickLabels)
     return mCachedMargin;
   
   // run through similar steps as QCPAxis::draw, and caluclate margin needed to fit axis and its labels
   int margin = 0;
   
-  int lowTick, highTick;
-  visibleTickBounds(lowTick, highTick);
   QVector<double> tickPositions; // the final coordToPixel transformed vector passed to QCPAxisPainter
-  QVector<QString> tickLabels; // the final vector passed to QCPAxisPainter
-  tickPositions.reserve(highTick-lowTick+1);
-  tickLabels.reserve(highTick-lowTick+1);
-  if (mTicks)
+  if (hasTicks)
   {
+    tickPositions.reserve(highTick-lowTick+1);
     for (int i=lowTick; i<=highTick; ++i)
-    {
       tickPositions.append(coordToPixel(mTickVector.at(i)));
-      if (mTickLabels)
-        tickLabels.append(mTickVectorLabels.at(i));
-    }
   }
   // transfer all properties of this axis to QCPAxisPainterPrivate which it needs to calculate the size.
   // Note that some axis painter properties are already set by direct feed-through with QCPAxis setters
@@ -2394,6 +2509,8 @@ int QCPAxis::calculateMargin()
 
   mCachedMargin = margin;
   mCachedMarginValid = true;
+  mCachedMarginHasTicks = hasTicks;
+  mCachedMarginTickLabels = tickLabels;
   return margin;
 }
 
@@ -2443,8 +2560,7 @@ QCPAxisPainterPrivate::QCPAxisPainterPrivate(QCustomPlot *parentPlot) :
   offset(0),
   abbreviateDecimalPowers(false),
   reversedEndings(false),
-  mParentPlot(parentPlot),
-  mLabelCache(16) // cache at most 16 (tick) labels
+  mParentPlot(parentPlot)
 {
 }
 
@@ -2461,12 +2577,7 @@ QCPAxisPainterPrivate::~QCPAxisPainterPrivate()
 */
 void QCPAxisPainterPrivate::draw(QCPPainter *painter)
 {
-  QByteArray newHash = generateLabelParameterHash();
-  if (newHash != mLabelParameterHash)
-  {
-    mLabelCache.clear();
-    mLabelParameterHash = newHash;
-  }
+  mLabelParameterHash = generateLabelParameterHash()+QCPLabelCache::deviceParameters(painter->device());
   
   QPoint origin;
   switch (type)
@@ -2663,25 +2774,27 @@ int QCPAxisPainterPrivate::size() const
 
 /*! \internal
   
-  Clears the internal label cache. Upon the next \ref draw, all labels will be created new. This
-  method is called automatically in \ref draw, if any parameters have changed that invalidate the
-  cached labels, such as font, color, etc.
+  Removes the labels drawn with the current label parameters from the shared label cache (\ref
+  QCPLabelCache). Upon the next \ref draw, these labels will be created new. This isn't necessary
+  when parameters such as font or color change, because the parameters are part of the keys of the
+  cached labels.
 */
 void QCPAxisPainterPrivate::clearCache()
 {
-  mLabelCache.clear();
+  QCPLabelCache::instance()->remove(mLabelParameterHash);
 }
 
 /*! \internal
   
-  Returns a hash that allows uniquely identifying whether the label parameters have changed such
-  that the cached labels must be refreshed (\ref clearCache). It is used in \ref draw. If the
-  return value of this method hasn't changed since the last redraw, the respective label parameters
-  haven't changed and cached labels may be used.
+  Returns a hash that uniquely identifies the label parameters that influence the appearance and
+  placement of cached labels. It is used in \ref draw as part of the keys of the labels in the
+  shared \ref QCPLabelCache, so axes with equal parameters share their cached labels, even across
+  different QCustomPlot instances.
 */
 QByteArray QCPAxisPainterPrivate::generateLabelParameterHash() const
 {
   QByteArray result;
+  result.append(QByteArray::number((int)type)); // the draw offset of cached labels depends on the axis type
   result.append(QByteArray::number(tickLabelRotation));
   result.append(QByteArray::number((int)substituteExponent));
   result.append(QByteArray::number((int)numberMultiplyCross));
@@ -2724,35 +2837,37 @@ void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position,
   }
   if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching)) // label caching enabled
   {
-    if (!mLabelCache.contains(text))  // no cached label exists, create it
+    const QByteArray key = QCPLabelCache::labelKey(text, mLabelParameterHash);
+    QPixmap labelPixmap;
+    QPointF labelOffset;
+    if (!QCPLabelCache::instance()->find(key, &labelPixmap, &labelOffset))  // no cached label exists, create it
     {
-      CachedLabel *newCachedLabel = new CachedLabel;
       TickLabelData labelData = getTickLabelData(painter->font(), text);
       QPointF drawOffset = getTickLabelDrawOffset(labelData);
-      newCachedLabel->offset = drawOffset+labelData.rotatedTotalBounds.topLeft();
-      newCachedLabel->pixmap = QPixmap(labelData.rotatedTotalBounds.size());
-      newCachedLabel->pixmap.fill(Qt::transparent);
-      QCPPainter cachePainter(&newCachedLabel->pixmap);
+      labelOffset = drawOffset+labelData.rotatedTotalBounds.topLeft();
+      labelPixmap = QPixmap(labelData.rotatedTotalBounds.size());
+      labelPixmap.fill(Qt::transparent);
+      QCPPainter cachePainter(&labelPixmap);
       cachePainter.setPen(painter->pen());
       drawTickLabel(&cachePainter, -labelData.rotatedTotalBounds.topLeft().x(), -labelData.rotatedTotalBounds.topLeft().y(), labelData);
-      mLabelCache.insert(text, newCachedLabel, 1);
+      cachePainter.end();
+      QCPLabelCache::instance()->insert(key, labelPixmap, labelOffset);
     }
     // draw cached label:
-    const CachedLabel *cachedLabel = mLabelCache.object(text);
     // if label would be partly clipped by widget border on sides, don't draw it:
     if (QCPAxis::orientation(type) == Qt::Horizontal)
     {
-      if (labelAnchor.x()+cachedLabel->offset.x()+cachedLabel->pixmap.width() > viewportRect.right() ||
-          labelAnchor.x()+cachedLabel->offset.x() < viewportRect.left())
+      if (labelAnchor.x()+labelOffset.x()+labelPixmap.width() > viewportRect.right() ||
+          labelAnchor.x()+labelOffset.x() < viewportRect.left())
         return;
     } else
     {
-      if (labelAnchor.y()+cachedLabel->offset.y()+cachedLabel->pixmap.height() >viewportRect.bottom() ||
-          labelAnchor.y()+cachedLabel->offset.y() < viewportRect.top())
+      if (labelAnchor.y()+labelOffset.y()+labelPixmap.height() >viewportRect.bottom() ||
+          labelAnchor.y()+labelOffset.y() < viewportRect.top())
         return;
     }
-    painter->drawPixmap(labelAnchor+cachedLabel->offset, cachedLabel->pixmap);
-    finalSize = cachedLabel->pixmap.size();
+    painter->drawPixmap(labelAnchor+labelOffset, labelPixmap);
+    finalSize = labelPixmap.size();
   } else // label caching disabled, draw text directly on surface:
   {
     TickLabelData labelData = getTickLabelData(painter->font(), text);
@@ -2999,10 +3114,10 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
 {
   // note: this function must return the same tick label sizes as the placeTickLabel function.
   QSize finalSize;
-  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && mLabelCache.contains(text)) // label caching enabled and have cached label
+  QPixmap cachedPixmap;
+  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && QCPLabelCache::instance()->find(QCPLabelCache::labelKey(text, mLabelParameterHash), &cachedPixmap, 0)) // label caching enabled and have cached label
   {
-    const CachedLabel *cachedLabel = mLabelCache.object(text);
-    finalSize = cachedLabel->pixmap.size();
+    finalSize = cachedPixmap.size();
   } else // label caching disabled or no label with this text cached:
   {
     TickLabelData labelData = getTickLabelData(font, text);
@@ -3015,3 +3130,324 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
   if (finalSize.height() > tickLabelsSize->height())
     tickLabelsSize->setHeight(finalSize.height());
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPDateTimeFormatterPrivate
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPDateTimeFormatterPrivate
+
+  \internal
+  \brief (Private)
+  
+  This is a private class and not part of the public QCustomPlot interface.
+  
+  It is used by QCPAxis to generate the tick labels of \ref QCPAxis::ltDateTime axes. Instead of
+  constructing a QDateTime and interpreting the format string for every tick, the format is
+  compiled once into a sequence of tokens (see \ref setFormat). Labels are then assembled directly
+  from the key in seconds since epoch. The calendar decomposition (year, month, day) of the last
+  formatted day is kept, so consecutive ticks on the same day only need to split the time of day.
+  
+  The generated strings are identical to <tt>QLocale::toString(QDateTime, format)</tt>. Formats,
+  time specs, locales or keys the compiled path can't reproduce exactly (e.g. the am/pm and time
+  zone tokens, locales with non-latin digits, dates before 1970) fall back to the QDateTime path,
+  see \ref toStringQDateTime.
+*/
+
+/*!
+  Constructs a QCPDateTimeFormatterPrivate instance and compiles \a format for the time spec \a
+  timeSpec.
+*/
+QCPDateTimeFormatterPrivate::QCPDateTimeFormatterPrivate(const QString &format, Qt::TimeSpec timeSpec) :
+  mFormat(format),
+  mTimeSpec(timeSpec),
+  mCompiled(false),
+  mDayValid(false),
+  mDayStart(0),
+  mYear(0),
+  mMonth(0),
+  mDay(0),
+  mDayOfWeek(0)
+{
+  compile();
+}
+
+/*!
+  Sets the date time format, see QDateTime::toString for the syntax. The format is compiled
+  immediately, \ref isCompiled tells whether the fast path of \ref toString can be used with it.
+*/
+void QCPDateTimeFormatterPrivate::setFormat(const QString &format)
+{
+  if (mFormat != format)
+  {
+    mFormat = format;
+    compile();
+  }
+}
+
+/*!
+  Sets the time spec in which keys are displayed. Only <tt>Qt::UTC</tt> and <tt>Qt::LocalTime</tt>
+  are handled by the compiled path.
+*/
+void QCPDateTimeFormatterPrivate::setTimeSpec(Qt::TimeSpec timeSpec)
+{
+  if (mTimeSpec != timeSpec)
+  {
+    mTimeSpec = timeSpec;
+    compile();
+  }
+}
+
+/*!
+  Returns the label for \a key, given in seconds since epoch (1970-01-01T00:00:00 UTC), using the
+  month/day names of \a locale.
+  
+  If the format is compiled and the key lies within the supported range, the label is assembled
+  from the token program, otherwise this method forwards to \ref toStringQDateTime.
+*/
+QString QCPDateTimeFormatterPrivate::toString(double key, const QLocale &locale)
+{
+  if (!mCompiled || locale.zeroDigit() != QLatin1Char('0'))
+    return toStringQDateTime(key, locale);
+  const double msecsDouble = key*1000.0;
+  if (!(msecsDouble >= 0 && msecsDouble < 253402300800000.0)) // years 1970 to 9999, also catches NaN
+    return toStringQDateTime(key, locale);
+  const qint64 msecs = (qint64)msecsDouble; // truncation like in the implicit conversion of the QDateTime path
+  const qint64 seconds = msecs/1000;
+  if (!mDayValid || seconds < mDayStart || seconds >= mDayStart+86400)
+  {
+    if (!updateDay(seconds))
+      return toStringQDateTime(key, locale);
+  }
+  const int secondOfDay = seconds-mDayStart;
+  const int hour = secondOfDay/3600;
+  const int minute = (secondOfDay/60)%60;
+  const int second = secondOfDay%60;
+  const int msec = msecs%1000;
+  
+  QString result;
+  result.reserve(mFormat.size()+8);
+  for (int i=0; i<mProgram.size(); ++i)
+  {
+    const Token &token = mProgram.at(i);
+    switch (token.type)
+    {
+      case ttLiteral: result.append(token.text); break;
+      case ttDay: appendNumber(result, mDay, 1); break;
+      case ttDay2: appendNumber(result, mDay, 2); break;
+      case ttDayNameShort: result.append(locale.dayName(mDayOfWeek, QLocale::ShortFormat)); break;
+      case ttDayNameLong: result.append(locale.dayName(mDayOfWeek, QLocale::LongFormat)); break;
+      case ttMonth: appendNumber(result, mMonth, 1); break;
+      case ttMonth2: appendNumber(result, mMonth, 2); break;
+      case ttMonthNameShort: result.append(locale.monthName(mMonth, QLocale::ShortFormat)); break;
+      case ttMonthNameLong: result.append(locale.monthName(mMonth, QLocale::LongFormat)); break;
+      case ttYear2: appendNumber(result, mYear%100, 2); break;
+      case ttYear4: appendNumber(result, mYear, 4); break;
+      case ttHour: appendNumber(result, hour, 1); break;
+      case ttHour2: appendNumber(result, hour, 2); break;
+      case ttMinute: appendNumber(result, minute, 1); break;
+      case ttMinute2: appendNumber(result, minute, 2); break;
+      case ttSecond: appendNumber(result, second, 1); break;
+      case ttSecond2: appendNumber(result, second, 2); break;
+      case ttMillisecond3: appendNumber(result, msec, 3); break;
+    }
+  }
+  return result;
+}
+
+/*!
+  Returns the label for \a key by constructing a QDateTime and formatting it with \a locale. This
+  is the reference behaviour the compiled path of \ref toString reproduces.
+*/
+QString QCPDateTimeFormatterPrivate::toStringQDateTime(double key, const QLocale &locale) const
+{
+#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0) // use fromMSecsSinceEpoch function if available, to gain sub-second accuracy on tick labels (e.g. for format "hh:mm:ss:zzz")
+  return locale.toString(QDateTime::fromTime_t(key).toTimeSpec(mTimeSpec), mFormat);
+#else
+  return locale.toString(QDateTime::fromMSecsSinceEpoch(key*1000).toTimeSpec(mTimeSpec), mFormat);
+#endif
+}
+
+/*! \internal
+  
+  Translates mFormat into the token program mProgram, following the rules of
+  QDateTime::toString: runs of equal format characters form one token (excess characters start a
+  new token), text in single quotes is literal and two single quotes produce one literal quote.
+  
+  If the format contains tokens whose output differs between Qt versions or depends on time zone
+  data (am/pm markers, "H", "t", a single "z" or "y"), or the time spec isn't UTC or local time,
+  mCompiled is set to false and \ref toString always uses the QDateTime path.
+*/
+void QCPDateTimeFormatterPrivate::compile()
+{
+  mProgram.clear();
+  mDayValid = false;
+  mCompiled = false;
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+  if (mTimeSpec != Qt::UTC && mTimeSpec != Qt::LocalTime)
+    return;
+  
+  Token literal;
+  literal.type = ttLiteral;
+  const int n = mFormat.size();
+  int i = 0;
+  while (i < n)
+  {
+    const QChar c = mFormat.at(i);
+    if (c == QLatin1Char('\''))
+    {
+      ++i;
+      if (i < n && mFormat.at(i) == QLatin1Char('\'')) // two quotes outside of quoted text
+      {
+        literal.text.append(QLatin1Char('\''));
+        ++i;
+        continue;
+      }
+      while (i < n)
+      {
+        if (mFormat.at(i) == QLatin1Char('\''))
+        {
+          if (i+1 < n && mFormat.at(i+1) == QLatin1Char('\'')) // two quotes inside of quoted text
+          {
+            literal.text.append(QLatin1Char('\''));
+            i += 2;
+          } else
+            break;
+        } else
+          literal.text.append(mFormat.at(i++));
+      }
+      if (i < n) ++i; // skip closing quote
+      continue;
+    }
+    
+    int repeat = 1;
+    while (i+repeat < n && mFormat.at(i+repeat) == c)
+      ++repeat;
+    TokenType type = ttLiteral;
+    switch (c.unicode())
+    {
+      case 'd':
+      {
+        const TokenType types[] = {ttDay, ttDay2, ttDayNameShort, ttDayNameLong};
+        repeat = qMin(repeat, 4);
+        type = types[repeat-1];
+        break;
+      }
+      case 'M':
+      {
+        const TokenType types[] = {ttMonth, ttMonth2, ttMonthNameShort, ttMonthNameLong};
+        repeat = qMin(repeat, 4);
+        type = types[repeat-1];
+        break;
+      }
+      case 'y':
+      {
+        if (repeat == 1) return;
+        repeat = repeat >= 4 ? 4 : 2;
+        type = repeat == 4 ? ttYear4 : ttYear2;
+        break;
+      }
+      case 'h': repeat = qMin(repeat, 2); type = repeat == 2 ? ttHour2 : ttHour; break;
+      case 'm': repeat = qMin(repeat, 2); type = repeat == 2 ? ttMinute2 : ttMinute; break;
+      case 's': repeat = qMin(repeat, 2); type = repeat == 2 ? ttSecond2 : ttSecond; break;
+      case 'z':
+      {
+        if (repeat < 3) return;
+        repeat = 3;
+        type = ttMillisecond3;
+        break;
+      }
+      case 'a': case 'A': case 'H': case 't': return;
+      default: break;
+    }
+    if (type == ttLiteral)
+    {
+      literal.text.append(mFormat.mid(i, repeat));
+    } else
+    {
+      if (!literal.text.isEmpty())
+      {
+        mProgram.append(literal);
+        literal.text.clear();
+      }
+      Token token;
+      token.type = type;
+      mProgram.append(token);
+    }
+    i += repeat;
+  }
+  if (!literal.text.isEmpty())
+    mProgram.append(literal);
+  mCompiled = true;
+#endif
+}
+
+/*! \internal
+  
+  Decomposes the day that contains \a seconds (since epoch) in the current time spec into year,
+  month, day and day of week, and stores the UTC second at which that day begins in mDayStart.
+  
+  Returns false if the offset to UTC changes during that day (daylight saving time transitions),
+  then the day isn't cached and the caller must use the QDateTime path.
+*/
+bool QCPDateTimeFormatterPrivate::updateDay(qint64 seconds)
+{
+  mDayValid = false;
+  const qint64 offset = utcOffset(seconds);
+  const qint64 localSeconds = seconds+offset;
+  const qint64 localDay = localSeconds >= 0 ? localSeconds/86400 : (localSeconds-86399)/86400;
+  const qint64 dayStart = localDay*86400-offset;
+  if (mTimeSpec == Qt::LocalTime && (utcOffset(dayStart) != offset || utcOffset(dayStart+86399) != offset))
+    return false;
+  
+  // civil date from days since epoch, valid for the proleptic Gregorian calendar:
+  const qint64 z = localDay+719468;
+  const qint64 era = (z >= 0 ? z : z-146096)/146097;
+  const int dayOfEra = z-era*146097;
+  const int yearOfEra = (dayOfEra - dayOfEra/1460 + dayOfEra/36524 - dayOfEra/146096)/365;
+  const int dayOfYear = dayOfEra - (365*yearOfEra + yearOfEra/4 - yearOfEra/100);
+  const int monthIndex = (5*dayOfYear+2)/153; // counted from March
+  mDay = dayOfYear - (153*monthIndex+2)/5 + 1;
+  mMonth = monthIndex < 10 ? monthIndex+3 : monthIndex-9;
+  mYear = yearOfEra + era*400 + (mMonth <= 2 ? 1 : 0);
+  mDayOfWeek = ((localDay+3)%7+7)%7+1; // 1970-01-01 was a thursday, Qt counts monday as 1
+  mDayStart = dayStart;
+  mDayValid = true;
+  return true;
+}
+
+/*! \internal
+  
+  Returns the offset in seconds that has to be added to the UTC time \a seconds (since epoch) to
+  get the time in the current time spec.
+*/
+qint64 QCPDateTimeFormatterPrivate::utcOffset(qint64 seconds) const
+{
+  if (mTimeSpec == Qt::UTC)
+    return 0;
+#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0)
+  return 0; // compile() never enables the compiled path in this case
+#else
+  const QDateTime local = QDateTime::fromMSecsSinceEpoch(seconds*1000).toTimeSpec(mTimeSpec);
+  return QDateTime(local.date(), local.time(), Qt::UTC).toMSecsSinceEpoch()/1000-seconds;
+#endif
+}
+
+/*! \internal
+  
+  Appends the non-negative \a value to \a str in decimal, padded with leading zeros to at least \a
+  digits characters.
+*/
+void QCPDateTimeFormatterPrivate::appendNumber(QString &str, int value, int digits)
+{
+  QChar buffer[12];
+  int count = 0;
+  do
+  {
+    buffer[count++] = QLatin1Char(char('0'+value%10));
+    value /= 10;
+  } while (value > 0 || count < digits);
+  while (count > 0)
+    str.append(buffer[--count]);
+}
@@ -37,6 +37,7 @@ class QCustomPlot;
 class QCPAxis;
 class QCPAxisRect;
 class QCPAxisPainterPrivate;
+class QCPDateTimeFormatterPrivate;
 class QCPAbstractPlottable;
 class QCPGraph;
 class QCPAbstractItem;
@@ -376,12 +377,18 @@ protected:
   // non-property members:
   QCPGrid *mGrid;
   QCPAxisPainterPrivate *mAxisPainter;
+  QCPDateTimeFormatterPrivate *mDateTimeFormatter;
   int mLowestVisibleTick, mHighestVisibleTick;
   QVector<double> mTickVector;
   QVector<QString> mTickVectorLabels;
   QVector<double> mSubTickVector;
+  QVector<double> mLabeledTicks; // visible ticks of the previous setupTickVectors call, whose labels may be reused
+  QVector<QString> mLabeledTickLabels;
+  QByteArray mLabeledTickParameters;
   bool mCachedMarginValid;
   int mCachedMargin;
+  bool mCachedMarginHasTicks;
+  QVector<QString> mCachedMarginTickLabels; // visible tick labels the cached margin was calculated with
   
   // introduced virtual methods:
   virtual void setupTickVectors();
@@ -399,6 +406,8 @@ protected:
   
   // non-virtual methods:
   void visibleTickBounds(int &lowIndex, int &highIndex) const;
+  QString formatTickLabel(double tick) const;
+  QByteArray tickLabelParameters() const;
   double baseLog(double value) const;
   double basePow(double value) const;
   QPen getBasePen() const;
@@ -461,11 +470,6 @@ public:
   QVector<QString> tickLabels;
   
 protected:
-  struct CachedLabel
-  {
-    QPointF offset;
-    QPixmap pixmap;
-  };
   struct TickLabelData
   {
     QString basePart, expPart;
@@ -473,8 +477,7 @@ protected:
     QFont baseFont, expFont;
   };
   QCustomPlot *mParentPlot;
-  QByteArray mLabelParameterHash; // to determine whether mLabelCache needs to be cleared due to changed parameters
-  QCache<QString, CachedLabel> mLabelCache;
+  QByteArray mLabelParameterHash; // parameters of the tick labels as part of the keys in the shared QCPLabelCache
   QRect mAxisSelectionBox, mTickLabelsSelectionBox, mLabelSelectionBox;
   
   virtual QByteArray generateLabelParameterHash() const;
@@ -486,4 +489,51 @@ protected:
   virtual void getMaxTickLabelSize(const QFont &font, const QString &text, QSize *tickLabelsSize) const;
 };
 
+
+class QCPDateTimeFormatterPrivate
+{
+public:
+  QCPDateTimeFormatterPrivate(const QString &format, Qt::TimeSpec timeSpec);
+  
+  // getters:
+  QString format() const { return mFormat; }
+  Qt::TimeSpec timeSpec() const { return mTimeSpec; }
+  bool isCompiled() const { return mCompiled; }
+  
+  // setters:
+  void setFormat(const QString &format);
+  void setTimeSpec(Qt::TimeSpec timeSpec);
+  
+  // non-property methods:
+  QString toString(double key, const QLocale &locale);
+  QString toStringQDateTime(double key, const QLocale &locale) const;
+  
+protected:
+  enum TokenType { ttLiteral, ttDay, ttDay2, ttDayNameShort, ttDayNameLong, ttMonth, ttMonth2, ttMonthNameShort, ttMonthNameLong,
+                   ttYear2, ttYear4, ttHour, ttHour2, ttMinute, ttMinute2, ttSecond, ttSecond2, ttMillisecond3 };
+  struct Token
+  {
+    TokenType type;
+    QString text; // only used by ttLiteral
+  };
+  
+  // property members:
+  QString mFormat;
+  Qt::TimeSpec mTimeSpec;
+  
+  // non-property members:
+  QVector<Token> mProgram;
+  bool mCompiled;
+  // calendar decomposition of the day that was formatted last:
+  bool mDayValid;
+  qint64 mDayStart;
+  int mYear, mMonth, mDay, mDayOfWeek;
+  
+  // non-virtual methods:
+  void compile();
+  bool updateDay(qint64 seconds);
+  qint64 utcOffset(qint64 seconds) const;
+  static void appendNumber(QString &str, int value, int digits);
+};
+
 #endif // QCP_AXIS_H
@@ -66,7 +66,8 @@ QCPColorGradient::QCPColorGradient(GradientPreset preset) :
   mLevelCount(350),
   mColorInterpolation(ciRGB),
   mPeriodic(false),
-  mColorBufferInvalidated(true)
+  mColorBufferInvalidated(true),
+  mLookupTableLogarithmic(false)
 {
   mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
   loadPreset(preset);
@@ -162,7 +163,11 @@ void QCPColorGradient::setColorInterpolation(QCPColorGradient::ColorInterpolatio
 */
 void QCPColorGradient::setPeriodic(bool enabled)
 {
-  mPeriodic = enabled;
+  if (mPeriodic != enabled)
+  {
+    mPeriodic = enabled;
+    mLookupTable.clear();
+  }
 }
 
 /*!
@@ -193,56 +198,203 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
   if (mColorBufferInvalidated)
     updateColorBuffer();
   
+  const QRgb *colorBuffer = mColorBuffer.constData();
   if (!logarithmic)
   {
     const double posToIndexFactor = mLevelCount/range.size();
+    int i = 0;
+#ifdef QCP_SSE2
+    // convert four data values at a time to indices, using the same double arithmetic and
+    // truncating conversion as the scalar loops below, so the results are identical:
+    const __m128d lowerVec = _mm_set1_pd(range.lower);
+    const __m128d factorVec = _mm_set1_pd(posToIndexFactor);
+    int indices[4];
     if (mPeriodic)
     {
-      for (int i=0; i<n; ++i)
+      for (; i+3<n; i+=4)
+      {
+        _mm_storeu_si128((__m128i*)indices, colorIndicesSse2(data+dataIndexFactor*i, dataIndexFactor, lowerVec, factorVec));
+        for (int k=0; k<4; ++k)
+        {
+          int index = indices[k] % mLevelCount;
+          if (index < 0)
+            index += mLevelCount;
+          scanLine[i+k] = colorBuffer[index];
+        }
+      }
+    } else
+    {
+      const __m128i zeroVec = _mm_setzero_si128();
+      const __m128i maxIndexVec = _mm_set1_epi32(mLevelCount-1);
+      for (; i+3<n; i+=4)
+      {
+        __m128i indexVec = colorIndicesSse2(data+dataIndexFactor*i, dataIndexFactor, lowerVec, factorVec);
+        indexVec = _mm_andnot_si128(_mm_cmplt_epi32(indexVec, zeroVec), indexVec); // clamp to 0
+        const __m128i aboveMax = _mm_cmpgt_epi32(indexVec, maxIndexVec);
+        indexVec = _mm_or_si128(_mm_and_si128(aboveMax, maxIndexVec), _mm_andnot_si128(aboveMax, indexVec)); // clamp to mLevelCount-1
+        _mm_storeu_si128((__m128i*)indices, indexVec);
+        scanLine[i] = colorBuffer[indices[0]];
+        scanLine[i+1] = colorBuffer[indices[1]];
+        scanLine[i+2] = colorBuffer[indices[2]];
+        scanLine[i+3] = colorBuffer[indices[3]];
+      }
+    }
+#endif
+    // scalar conversion of the (remaining) data values:
+    if (mPeriodic)
+    {
+      for (; i<n; ++i)
       {
         int index = (int)((data[dataIndexFactor*i]-range.lower)*posToIndexFactor) % mLevelCount;
         if (index < 0)
           index += mLevelCount;
-        scanLine[i] = mColorBuffer.at(index);
+        scanLine[i] = colorBuffer[index];
       }
     } else
     {
-      for (int i=0; i<n; ++i)
+      for (; i<n; ++i)
       {
         int index = (data[dataIndexFactor*i]-range.lower)*posToIndexFactor;
         if (index < 0)
           index = 0;
         else if (index >= mLevelCount)
           index = mLevelCount-1;
-        scanLine[i] = mColorBuffer.at(index);
+        scanLine[i] = colorBuffer[index];
       }
     }
   } else // logarithmic == true
   {
+    const double logRange = qLn(range.upper/range.lower);
     if (mPeriodic)
     {
       for (int i=0; i<n; ++i)
       {
-        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*mLevelCount) % mLevelCount;
+        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)/logRange*mLevelCount) % mLevelCount;
         if (index < 0)
           index += mLevelCount;
-        scanLine[i] = mColorBuffer.at(index);
+        scanLine[i] = colorBuffer[index];
       }
     } else
     {
       for (int i=0; i<n; ++i)
       {
-        int index = qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*mLevelCount;
+        int index = qLn(data[dataIndexFactor*i]/range.lower)/logRange*mLevelCount;
         if (index < 0)
           index = 0;
         else if (index >= mLevelCount)
           index = mLevelCount-1;
-        scanLine[i] = mColorBuffer.at(index);
+        scanLine[i] = colorBuffer[index];
       }
     }
   }
 }
 
+/*! \overload
+  
+  Colorizes an array of single precision \a data. The values are converted to double in blocks and
+  mapped exactly like with the double precision version of this method.
+*/
+void QCPColorGradient::colorize(const float *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  
+  const int blockSize = 256;
+  double block[blockSize];
+  for (int i=0; i<n; i+=blockSize)
+  {
+    const int count = qMin(blockSize, n-i);
+    for (int k=0; k<count; ++k)
+      block[k] = data[dataIndexFactor*(i+k)];
+    colorize(block, range, scanLine+i, count, 1, logarithmic);
+  }
+}
+
+/*! \overload
+  
+  Colorizes an array of unsigned 16 bit integer \a data. Instead of calculating the color index of
+  every value, the colors of all 65536 possible values are calculated once and kept in a lookup
+  table, as long as \a range, \a logarithmic and the gradient stay the same. The result is
+  identical to colorizing the same values given as double.
+*/
+void QCPColorGradient::colorize(const quint16 *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  
+  const QRgb *table = lookupTable(65536, range, logarithmic);
+  for (int i=0; i<n; ++i)
+    scanLine[i] = table[data[dataIndexFactor*i]];
+}
+
+/*! \overload
+  
+  Colorizes an array of unsigned 8 bit integer \a data, using a lookup table of the colors of all
+  256 possible values, like the unsigned 16 bit integer version of this method.
+*/
+void QCPColorGradient::colorize(const quint8 *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  
+  const QRgb *table = lookupTable(256, range, logarithmic);
+  for (int i=0; i<n; ++i)
+    scanLine[i] = table[data[dataIndexFactor*i]];
+}
+
+#ifdef QCP_SSE2
+/*! \internal
+  
+  Converts the four data values <tt>data[0]</tt>, <tt>data[dataIndexFactor]</tt>,
+  <tt>data[2*dataIndexFactor]</tt> and <tt>data[3*dataIndexFactor]</tt> to unbounded color buffer
+  indices, i.e. <tt>(int)((value-lower)*factor)</tt>. Like the scalar conversion on x86-64, values
+  that can't be represented as int (including NaN) become the smallest int value.
+  
+  This is the vectorized part of \ref colorize. It is only available if QCP_SSE2 is defined, which
+  is the case on x86-64, unless QCP_NO_SIMD is defined.
+*/
+__m128i QCPColorGradient::colorIndicesSse2(const double *data, int dataIndexFactor, __m128d lower, __m128d factor)
+{
+  __m128d lo, hi;
+  if (dataIndexFactor == 1)
+  {
+    lo = _mm_loadu_pd(data);
+    hi = _mm_loadu_pd(data+2);
+  } else
+  {
+    lo = _mm_set_pd(data[dataIndexFactor], data[0]);
+    hi = _mm_set_pd(data[3*dataIndexFactor], data[2*dataIndexFactor]);
+  }
+  lo = _mm_mul_pd(_mm_sub_pd(lo, lower), factor);
+  hi = _mm_mul_pd(_mm_sub_pd(hi, lower), factor);
+  return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+}
+#endif
+
 /*! \internal
   
   This method is used to colorize a single data value given in \a position, to colors. The data
@@ -418,6 +570,9 @@ QCPColorGradient QCPColorGradient::inverted() const
   
   Updates the internal color buffer which will be used by \ref colorize and \ref color, to quickly
   convert positions to colors. This is where the interpolation between color stops is calculated.
+  
+  The lookup table of integer values (see \ref lookupTable) is discarded, since it was built from
+  the previous color buffer.
 */
 void QCPColorGradient::updateColorBuffer()
 {
@@ -478,4 +633,29 @@ void QCPColorGradient::updateColorBuffer()
     mColorBuffer.fill(qRgb(0, 0, 0));
   }
   mColorBufferInvalidated = false;
+  mLookupTable.clear(); // lookup table was built from the previous color buffer
+}
+
+/*! \internal
+  
+  Returns a lookup table with the colors of the integer values 0 to \a size-1, mapped with \a
+  range and \a logarithmic like in \ref colorize. The table is kept until the gradient or the
+  mapping parameters change, so colorizing integer data doesn't need to calculate color indices
+  per value.
+*/
+const QRgb *QCPColorGradient::lookupTable(int size, const QCPRange &range, bool logarithmic)
+{
+  if (mColorBufferInvalidated)
+    updateColorBuffer();
+  if (mLookupTable.size() != size || mLookupTableRange != range || mLookupTableLogarithmic != logarithmic)
+  {
+    QVector<double> values(size);
+    for (int i=0; i<size; ++i)
+      values[i] = i;
+    mLookupTable.resize(size);
+    colorize(values.constData(), range, mLookupTable.data(), size, 1, logarithmic);
+    mLookupTableRange = range;
+    mLookupTableLogarithmic = logarithmic;
+  }
+  return mLookupTable.constData();
 }
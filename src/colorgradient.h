@@ -81,6 +81,9 @@ public:
   
   // non-property methods:
   void colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const float *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const quint16 *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const quint8 *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
   QRgb color(double position, const QCPRange &range, bool logarithmic=false);
   void loadPreset(GradientPreset preset);
   void clearColorStops();
@@ -88,6 +91,10 @@ public:
   
 protected:
   void updateColorBuffer();
+  const QRgb *lookupTable(int size, const QCPRange &range, bool logarithmic);
+#ifdef QCP_SSE2
+  static __m128i colorIndicesSse2(const double *data, int dataIndexFactor, __m128d lower, __m128d factor);
+#endif
   
   // property members:
   int mLevelCount;
@@ -98,6 +105,9 @@ protected:
   // non-property members:
   QVector<QRgb> mColorBuffer;
   bool mColorBufferInvalidated;
+  QVector<QRgb> mLookupTable;
+  QCPRange mLookupTableRange;
+  bool mLookupTableLogarithmic;
 };
 
 #endif // QCP_COLORGRADIENT_H
@@ -262,6 +262,29 @@
   one cell with the main QCPAxisRect inside.
 */
 
+/*! \fn int QCustomPlot::queuedReplotRequests() const
+  
+  Returns the number of replot requests with \ref rpQueuedReplot since the construction of the plot
+  or the last call of \ref resetReplotStatistics.
+  
+  \see mergedReplotRequests
+*/
+
+/*! \fn int QCustomPlot::mergedReplotRequests() const
+  
+  Returns how many of the \ref queuedReplotRequests didn't cause a replot of their own, because a
+  queued replot was already pending.
+  
+  \see resetReplotStatistics
+*/
+
+/*! \fn QList<QCPReplotTiming> QCustomPlot::replotTimings() const
+  
+  Returns the timings of the last replots, ordered from the oldest to the most recent replot. The
+  number of kept timings is set with \ref setReplotTimingHistory. If replot timing is disabled,
+  the returned list is empty.
+*/
+
 /* end of documentation of inline functions */
 /* start of documentation of signals */
 
@@ -452,6 +475,15 @@
   \see replot, beforeReplot
 */
 
+/*! \fn void QCustomPlot::replotTimed(const QCPReplotTiming &timing)
+  
+  This signal is emitted at the end of each replot while replot timing is enabled (see \ref
+  setReplotTimingHistory), with the measured \a timing of that replot. It is emitted before \ref
+  afterReplot.
+  
+  \see replotTimings
+*/
+
 /* end of documentation of signals */
 /* start of documentation of public members */
 
@@ -551,9 +583,14 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mCurrentLayer(0),
   mPlottingHints(QCP::phCacheLabels|QCP::phForceRepaint),
   mMultiSelectModifier(Qt::ControlModifier),
+  mMaxReplotRate(0),
   mPaintBuffer(size()),
   mMouseEventElement(0),
-  mReplotting(false)
+  mReplotting(false),
+  mQueuedReplotTimer(new QTimer(this)),
+  mQueuedReplotRequests(0),
+  mMergedReplotRequests(0),
+  mReplotTimingHistory(0)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
@@ -561,6 +598,8 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   QLocale currentLocale = locale();
   currentLocale.setNumberOptions(QLocale::OmitGroupSeparator);
   setLocale(currentLocale);
+  mQueuedReplotTimer->setSingleShot(true);
+  connect(mQueuedReplotTimer, SIGNAL(timeout()), this, SLOT(processQueuedReplot()));
   
   // create initial layers:
   mLayers.append(new QCPLayer(this, "background"));
@@ -869,6 +908,23 @@ void QCustomPlot::setMultiSelectModifier(Qt::KeyboardModifier modifier)
   mMultiSelectModifier = modifier;
 }
 
+/*!
+  Sets the maximum number of replots per second that are performed for replot requests with \ref
+  rpQueuedReplot. If queued replots are requested more frequently, they are delayed and merged,
+  such that the time between two replots doesn't fall below 1/\a rate seconds.
+  
+  Set \a rate to zero (the default) to not limit the rate. Queued replot requests are then still
+  merged within one event loop iteration.
+  
+  Direct calls to \ref replot with other refresh priorities are not limited by this setting.
+  
+  \see replot, queuedReplotRequests
+*/
+void QCustomPlot::setMaxReplotRate(double rate)
+{
+  mMaxReplotRate = qMax(0.0, rate);
+}
+
 /*!
   Sets the viewport of this QCustomPlot. The Viewport is the area that the top level layout
   (QCustomPlot::plotLayout()) uses as its rect. Normally, the viewport is the entire widget rect.
@@ -1860,6 +1916,7 @@ void QCustomPlot::deselectAll()
   {
     foreach (QCPLayerable *layerable, layer->children())
       layerable->deselectEvent(0);
+    layer->markDirty();
   }
 }
 
@@ -1875,12 +1932,35 @@ void QCustomPlot::deselectAll()
   afterReplot is emitted. It is safe to mutually connect the replot slot with any of those two
   signals on two QCustomPlots to make them replot synchronously, it won't cause an infinite
   recursion.
+  
+  If \a refreshPriority is \ref rpQueuedReplot, the replot isn't performed immediately but when
+  control returns to the event loop. All queued replot requests until then are merged into a single
+  replot, and the time between replots is kept at or above the limit given by \ref
+  setMaxReplotRate. This is the preferred way to replot from slots that are invoked frequently, e.g.
+  by incoming data. A regular replot in the meantime also satisfies pending queued requests.
 */
 void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 {
+  if (refreshPriority == rpQueuedReplot)
+  {
+    ++mQueuedReplotRequests;
+    if (mQueuedReplotTimer->isActive())
+    {
+      ++mMergedReplotRequests;
+      return;
+    }
+    int delay = 0;
+    if (mMaxReplotRate > 0 && mLastReplotTime.isValid())
+      delay = qMax(0, qRound(1000.0/mMaxReplotRate-mLastReplotTime.elapsed()));
+    mQueuedReplotTimer->start(delay);
+    return;
+  }
+  
   if (mReplotting) // incase signals loop back to replot slot
     return;
   mReplotting = true;
+  mQueuedReplotTimer->stop(); // this replot also satisfies pending queued replot requests
+  mLastReplotTime.start();
   emit beforeReplot();
   
   mPaintBuffer.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
@@ -1904,6 +1984,47 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   mReplotting = false;
 }
 
+/*!
+  Resets the counters returned by \ref queuedReplotRequests and \ref mergedReplotRequests to zero.
+*/
+void QCustomPlot::resetReplotStatistics()
+{
+  mQueuedReplotRequests = 0;
+  mMergedReplotRequests = 0;
+}
+
+/*!
+  Enables the measurement of replot timings, if \a count is larger than zero. The timings of the
+  last \a count replots are then kept and can be retrieved with \ref replotTimings. Further, the
+  signal \ref replotTimed is emitted after each replot.
+  
+  The recorded timings include the layout phases, the background, each layer and each drawn
+  layerable, see \ref QCPReplotTiming. This allows finding out which plottable, axis or item is
+  expensive to draw, also in deployed applications.
+  
+  Setting \a count to zero (the default) disables the measurement. The regular replot then only has
+  the cost of a few null pointer comparisons: one per measured phase of the replot and up to three
+  per layer, independent of the number of layerables on the layer.
+  
+  \see clearReplotTimings
+*/
+void QCustomPlot::setReplotTimingHistory(int count)
+{
+  mReplotTimingHistory = qMax(0, count);
+  while (mReplotTimings.size() > mReplotTimingHistory)
+    mReplotTimings.removeFirst();
+}
+
+/*!
+  Removes all replot timings that were recorded so far.
+  
+  \see setReplotTimingHistory, replotTimings
+*/
+void QCustomPlot::clearReplotTimings()
+{
+  mReplotTimings.clear();
+}
+
 /*!
   Rescales the axes such that all plottables (like graphs) in the plot are fully visible.
   
@@ -2361,6 +2482,8 @@ void QCustomPlot::mouseReleaseEvent(QMouseEvent *event)
             {
               bool selChanged = false;
               layerable->deselectEvent(&selChanged);
+              if (selChanged)
+                layer->markDirty();
               selectionStateChanged |= selChanged;
             }
           }
@@ -2371,6 +2494,8 @@ void QCustomPlot::mouseReleaseEvent(QMouseEvent *event)
         // a layerable was actually clicked, call its selectEvent:
         bool selChanged = false;
         clickedLayerable->selectEvent(event, additive, details, &selChanged);
+        if (selChanged && clickedLayerable->layer())
+          clickedLayerable->layer()->markDirty();
         selectionStateChanged |= selChanged;
       }
       doReplot = true;
@@ -2431,31 +2556,68 @@ void QCustomPlot::wheelEvent(QWheelEvent *event)
   specified \a painter. Note that it does not fill the background with the background brush (as the
   user may specify with \ref setBackground(const QBrush &brush)), this is up to the respective
   functions calling this method (e.g. \ref replot, \ref toPixmap and \ref toPainter).
+  
+  If replot timing is enabled with \ref setReplotTimingHistory, replots additionally measure the
+  time taken by the individual steps. The result is added to the \ref replotTimings and emitted
+  with \ref replotTimed.
 */
 void QCustomPlot::draw(QCPPainter *painter)
 {
+  QCPReplotTiming timingData;
+  QCPReplotTiming *timing = mReplotTimingHistory > 0 && mReplotting ? &timingData : 0;
+  QCPReplotTimer totalTimer, timer;
+  if (timing)
+  {
+    totalTimer.start();
+    timer.start();
+  }
+  
   // run through layout phases:
   mPlotLayout->update(QCPLayoutElement::upPreparation);
+  if (timing)
+  {
+    timing->layoutPreparation = timer.elapsedMs();
+    timer.start();
+  }
   mPlotLayout->update(QCPLayoutElement::upMargins);
+  if (timing)
+  {
+    timing->layoutMargins = timer.elapsedMs();
+    timer.start();
+  }
   mPlotLayout->update(QCPLayoutElement::upLayout);
+  if (timing)
+    timing->layoutLayout = timer.elapsedMs();
+  
+  // prepare plot data of plottables concurrently, now that the axis rect geometry is final:
+  if (mPlottingHints.testFlag(QCP::phParallelPreparation))
+  {
+    if (timing)
+      timer.start();
+    preparePlottables();
+    if (timing)
+      timing->plottablePreparation = timer.elapsedMs();
+  }
   
   // draw viewport background pixmap:
+  if (timing)
+    timer.start();
   drawBackground(painter);
+  if (timing)
+    timing->background = timer.elapsedMs();
 
   // draw all layered objects (grid, axes, plottables, items, legend,...):
-  foreach (QCPLayer *layer, mLayers)
+  if (mReplotting)
+    updateLayerBufferState();
+  drawLayers(painter, timing);
+  
+  if (timing)
   {
-    foreach (QCPLayerable *child, layer->children())
-    {
-      if (child->realVisibility())
-      {
-        painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
-        child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
-      }
-    }
+    timing->total = totalTimer.elapsedMs();
+    mReplotTimings.append(*timing);
+    while (mReplotTimings.size() > mReplotTimingHistory)
+      mReplotTimings.removeFirst();
+    emit replotTimed(*timing);
   }
   
   /* Debug code to draw all layout element rects
@@ -2510,6 +2672,185 @@ void QCustomPlot::drawBackground(QCPPainter *painter)
 }
 
 
+/*! \internal
+  
+  Performs the replot that was scheduled by one or more calls of \ref replot with \ref
+  rpQueuedReplot.
+*/
+void QCustomPlot::processQueuedReplot()
+{
+  replot(rpHint);
+}
+
+/*! \internal
+  
+  Draws all layers from bottom to top with \a painter. Layers in \ref QCPLayer::lmBuffered mode
+  are only used with their paint buffer when replotting into the paint buffer of the plot, exports
+  like \ref toPixmap draw all layers directly.
+  
+  If \a timing is not 0, the drawing time of each layer and of the layerables that are drawn is
+  recorded in it.
+  
+  \see draw, compositeLayers
+*/
+void QCustomPlot::drawLayers(QCPPainter *painter, QCPReplotTiming *timing)
+{
+  QCPReplotTimer timer;
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (timing)
+      timer.start();
+    if (mReplotting && layer->mode() == QCPLayer::lmBuffered)
+    {
+      if (layer->visible())
+      {
+        layer->drawToPaintBuffer(mPaintBuffer.size(), timing);
+        painter->drawPixmap(0, 0, layer->mPaintBuffer);
+      }
+    } else
+      layer->draw(painter, timing);
+    if (timing)
+      timing->layers.append(qMakePair(layer->name(), timer.elapsedMs()));
+  }
+}
+
+/*! \internal
+  
+  Redraws the paint buffer of the plot from the current layer state, without running the layout
+  phases or preparing plottables like a full \ref replot does. Buffered layers that aren't dirty
+  are just composited, dirty buffered layers and layers in \ref QCPLayer::lmLogical mode are
+  redrawn. Finally, the widget is scheduled for repainting.
+  
+  The layer buffers are only valid for the plot state they were drawn with. So if the state
+  collected by \ref layerBufferState differs from the one of the last replot, e.g. because an axis
+  range was changed in the meantime, a full \ref replot is performed instead.
+  
+  This is used by \ref QCPLayer::replot.
+*/
+void QCustomPlot::compositeLayers()
+{
+  if (mReplotting)
+    return;
+  if (mLayerBufferState.isEmpty() || layerBufferState() != mLayerBufferState)
+  {
+    replot();
+    return;
+  }
+  mReplotting = true;
+  
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (layer->mode() == QCPLayer::lmBuffered)
+      layer->updateChildBufferState();
+  }
+  
+  mPaintBuffer.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
+  QCPPainter painter;
+  painter.begin(&mPaintBuffer);
+  if (painter.isActive())
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+      painter.fillRect(mViewport, mBackgroundBrush);
+    drawBackground(&painter);
+    drawLayers(&painter);
+    painter.end();
+    update();
+  } else
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer";
+  
+  mReplotting = false;
+}
+
+/*! \internal
+  
+  Collects the state of the plot that affects the appearance of all layers, i.e. the viewport, the
+  axis rect geometries, the axis ranges and scales, and the antialiasing settings. If it differs
+  from the state at the last replot, all layers are marked dirty, so buffered layers (\ref
+  QCPLayer::lmBuffered) are redrawn. Further, buffered layers check the state of their own
+  layerables, like the data revisions of graphs, see \ref QCPLayer::updateChildBufferState.
+  
+  This is called by \ref draw after the layout has been updated.
+*/
+void QCustomPlot::updateLayerBufferState()
+{
+  QVector<double> state = layerBufferState();
+  if (state != mLayerBufferState)
+  {
+    mLayerBufferState = state;
+    foreach (QCPLayer *layer, mLayers)
+      layer->markDirty();
+  }
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (layer->mode() == QCPLayer::lmBuffered)
+      layer->updateChildBufferState();
+  }
+}
+
+/*! \internal
+  
+  Returns the state of the plot that affects the appearance of all layers, see \ref
+  updateLayerBufferState.
+*/
+QVector<double> QCustomPlot::layerBufferState() const
+{
+  QVector<double> state;
+  state << mViewport.x() << mViewport.y() << mViewport.width() << mViewport.height();
+  state << (int)mAntialiasedElements << (int)mNotAntialiasedElements;
+  foreach (QCPAxisRect *rect, axisRects())
+  {
+    state << rect->left() << rect->top() << rect->width() << rect->height();
+    foreach (QCPAxis *axis, rect->axes())
+    {
+      state << axis->range().lower << axis->range().upper << axis->scaleType() << axis->scaleLogBase() << axis->rangeReversed();
+    }
+  }
+  return state;
+}
+
+/*! \internal
+  
+  Calls \ref QCPAbstractPlottable::preparePlotData for all visible plottables, distributed over
+  the threads of the global QThreadPool. The calling thread takes part in the work and the method
+  returns when all plottables are prepared.
+  
+  Only threads that are idle right away are used, so a thread pool which is busy with other tasks
+  doesn't stall the replot.
+  
+  This is called by \ref draw after the layout has been updated, if the plotting hint \ref
+  QCP::phParallelPreparation is set.
+*/
+void QCustomPlot::preparePlottables()
+{
+  QList<QCPAbstractPlottable*> plottables;
+  foreach (QCPAbstractPlottable *plottable, mPlottables)
+  {
+    if (plottable->realVisibility())
+      plottables.append(plottable);
+  }
+  if (plottables.isEmpty())
+    return;
+  
+  QAtomicInt nextIndex(0);
+  QSemaphore finished;
+  int startedTasks = 0;
+  const int maxTasks = qMin(plottables.size(), QThreadPool::globalInstance()->maxThreadCount())-1; // calling thread does work, too
+  for (int i=0; i<maxTasks; ++i)
+  {
+    QCPPlottablePreparationTask *task = new QCPPlottablePreparationTask(plottables, &nextIndex, &finished);
+    if (QThreadPool::globalInstance()->tryStart(task))
+      ++startedTasks;
+    else
+    {
+      delete task;
+      break;
+    }
+  }
+  QCPPlottablePreparationTask::prepareRemaining(plottables, &nextIndex);
+  finished.acquire(startedTasks);
+}
+
 /*! \internal
   
   This method is used by \ref QCPAxisRect::removeAxis to report removed axes to the QCustomPlot
@@ -2702,3 +3043,105 @@ void QCustomPlot::toPainter(QCPPainter *painter, int width, int height)
   } else
     qDebug() << Q_FUNC_INFO << "Passed painter is not active";
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPReplotTiming
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPReplotTiming
+  \brief Holds the time measurements of one replot.
+  
+  Replot timings are recorded by QCustomPlot if enabled with \ref
+  QCustomPlot::setReplotTimingHistory. They can be retrieved with \ref QCustomPlot::replotTimings
+  or via the signal \ref QCustomPlot::replotTimed.
+  
+  All durations are in milliseconds. The stored timings are:
+  \li \a total: the time of the entire drawing of the plot
+  \li \a layoutPreparation, \a layoutMargins, \a layoutLayout: the time of the three layout
+  phases (\ref QCPLayoutElement::upPreparation, \ref QCPLayoutElement::upMargins, \ref
+  QCPLayoutElement::upLayout)
+  \li \a plottablePreparation: the time of the concurrent plottable preparation, if \ref
+  QCP::phParallelPreparation is set
+  \li \a background: the time of drawing the viewport background pixmap
+  \li \a layers: the name and drawing time of each layer, bottom to top
+  \li \a layerables: each drawn layerable and its drawing time, in drawing order
+  
+  Layerables on a buffered layer (\ref QCPLayer::lmBuffered) only appear in \a layerables if the
+  layer buffer was redrawn during that replot. The layerable pointers become null if the layerable
+  is deleted.
+*/
+
+/*! \class QCPReplotTimer
+  \internal
+  \brief Measures the durations recorded in a QCPReplotTiming
+  
+  Uses the nanosecond resolution of QElapsedTimer where available (Qt 4.8 and later), and falls
+  back to millisecond resolution on older Qt versions.
+*/
+
+/*!
+  Constructs a replot timing with all durations set to zero.
+*/
+QCPReplotTiming::QCPReplotTiming() :
+  total(0),
+  layoutPreparation(0),
+  layoutMargins(0),
+  layoutLayout(0),
+  plottablePreparation(0),
+  background(0)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPlottablePreparationTask
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPlottablePreparationTask
+
+  \internal
+  \brief (Private)
+  
+  This is a private class and not part of the public QCustomPlot interface.
+  
+  It is used by QCustomPlot::preparePlottables to call QCPAbstractPlottable::preparePlotData on a
+  worker thread of the global QThreadPool. All tasks of one replot share a list of plottables and
+  an atomic index into it, so each task keeps taking the next unprepared plottable until none are
+  left. This balances the load even if the plottables differ a lot in their amount of data.
+*/
+
+/*!
+  Creates a task that prepares plottables of \a plottables, taking their indices from \a
+  nextIndex. When done, it releases one resource of \a finished.
+*/
+QCPPlottablePreparationTask::QCPPlottablePreparationTask(const QList<QCPAbstractPlottable*> &plottables, QAtomicInt *nextIndex, QSemaphore *finished) :
+  mPlottables(plottables),
+  mNextIndex(nextIndex),
+  mFinished(finished)
+{
+}
+
+/*!
+  Prepares plottables until all are taken, then signals that this task is finished.
+*/
+void QCPPlottablePreparationTask::run()
+{
+  prepareRemaining(mPlottables, mNextIndex);
+  mFinished->release();
+}
+
+/*!
+  Prepares the plottables of \a plottables one after another, each time taking the next index
+  from \a nextIndex, until the end of the list is reached. May be called from several threads with
+  the same arguments, each plottable is then prepared by exactly one of them.
+*/
+void QCPPlottablePreparationTask::prepareRemaining(const QList<QCPAbstractPlottable*> &plottables, QAtomicInt *nextIndex)
+{
+  int index = nextIndex->fetchAndAddOrdered(1);
+  while (index < plottables.size())
+  {
+    plottables.at(index)->preparePlotData();
+    index = nextIndex->fetchAndAddOrdered(1);
+  }
+}
@@ -38,6 +38,38 @@ class QCPGraph;
 class QCPPlotTitle;
 class QCPLegend;
 class QCPAbstractLegendItem;
+class QCPPlottablePreparationTask;
+
+class QCPReplotTimer
+{
+public:
+  void start() { mTimer.start(); }
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+  double elapsedMs() const { return mTimer.nsecsElapsed()/1.0e6; }
+#else
+  double elapsedMs() const { return mTimer.elapsed(); }
+#endif
+  
+private:
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+  QElapsedTimer mTimer;
+#else
+  QTime mTimer;
+#endif
+};
+
+class QCP_LIB_DECL QCPReplotTiming
+{
+public:
+  QCPReplotTiming();
+  double total;
+  double layoutPreparation, layoutMargins, layoutLayout;
+  double plottablePreparation;
+  double background;
+  QVector<QPair<QString, double> > layers;
+  QVector<QPair<QPointer<QCPLayerable>, double> > layerables;
+};
+Q_DECLARE_METATYPE(QCPReplotTiming)
 
 class QCP_LIB_DECL QCustomPlot : public QWidget
 {
@@ -52,6 +84,7 @@ class QCP_LIB_DECL QCustomPlot : public QWidget
   Q_PROPERTY(int selectionTolerance READ selectionTolerance WRITE setSelectionTolerance)
   Q_PROPERTY(bool noAntialiasingOnDrag READ noAntialiasingOnDrag WRITE setNoAntialiasingOnDrag)
   Q_PROPERTY(Qt::KeyboardModifier multiSelectModifier READ multiSelectModifier WRITE setMultiSelectModifier)
+  Q_PROPERTY(double maxReplotRate READ maxReplotRate WRITE setMaxReplotRate)
   /// \endcond
 public:
   /*!
@@ -72,6 +105,7 @@ public:
   enum RefreshPriority { rpImmediate ///< The QCustomPlot surface is immediately refreshed, by calling QWidget::repaint() after the replot
                          ,rpQueued   ///< Queues the refresh such that it is performed at a slightly delayed point in time after the replot, by calling QWidget::update() after the replot
                          ,rpHint     ///< Whether to use immediate repaint or queued update depends on whether the plotting hint \ref QCP::phForceRepaint is set, see \ref setPlottingHints.
+                         ,rpQueuedReplot ///< Doesn't replot right away, but queues the replot in the event loop. All queued replot requests until then are merged into one replot, which is delayed further if necessary to not exceed \ref setMaxReplotRate
                        };
   
   explicit QCustomPlot(QWidget *parent = 0);
@@ -91,6 +125,7 @@ public:
   bool noAntialiasingOnDrag() const { return mNoAntialiasingOnDrag; }
   QCP::PlottingHints plottingHints() const { return mPlottingHints; }
   Qt::KeyboardModifier multiSelectModifier() const { return mMultiSelectModifier; }
+  double maxReplotRate() const { return mMaxReplotRate; }
 
   // setters:
   void setViewport(const QRect &rect);
@@ -111,6 +146,7 @@ public:
   void setPlottingHints(const QCP::PlottingHints &hints);
   void setPlottingHint(QCP::PlottingHint hint, bool enabled=true);
   void setMultiSelectModifier(Qt::KeyboardModifier modifier);
+  void setMaxReplotRate(double rate);
   
   // non-property methods:
   // plottable interface:
@@ -182,6 +218,13 @@ public:
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpHint);
+  int queuedReplotRequests() const { return mQueuedReplotRequests; }
+  int mergedReplotRequests() const { return mMergedReplotRequests; }
+  void resetReplotStatistics();
+  int replotTimingHistory() const { return mReplotTimingHistory; }
+  void setReplotTimingHistory(int count);
+  QList<QCPReplotTiming> replotTimings() const { return mReplotTimings; }
+  void clearReplotTimings();
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
@@ -207,6 +250,7 @@ signals:
   void selectionChangedByUser();
   void beforeReplot();
   void afterReplot();
+  void replotTimed(const QCPReplotTiming &timing);
   
 protected:
   // property members:
@@ -229,12 +273,23 @@ protected:
   QCPLayer *mCurrentLayer;
   QCP::PlottingHints mPlottingHints;
   Qt::KeyboardModifier mMultiSelectModifier;
+  double mMaxReplotRate;
   
   // non-property members:
   QPixmap mPaintBuffer;
   QPoint mMousePressPos;
   QPointer<QCPLayoutElement> mMouseEventElement;
   bool mReplotting;
+  QTimer *mQueuedReplotTimer;
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+  QElapsedTimer mLastReplotTime;
+#else
+  QTime mLastReplotTime;
+#endif
+  int mQueuedReplotRequests, mMergedReplotRequests;
+  int mReplotTimingHistory;
+  QList<QCPReplotTiming> mReplotTimings;
+  QVector<double> mLayerBufferState;
   
   // reimplemented virtual methods:
   virtual QSize minimumSizeHint() const;
@@ -256,6 +311,12 @@ protected:
   void updateLayerIndices() const;
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
+  void drawLayers(QCPPainter *painter, QCPReplotTiming *timing=0);
+  void compositeLayers();
+  void preparePlottables();
+  void updateLayerBufferState();
+  QVector<double> layerBufferState() const;
+  Q_SLOT void processQueuedReplot();
   
   friend class QCPLegend;
   friend class QCPAxis;
@@ -263,4 +324,19 @@ protected:
   friend class QCPAxisRect;
 };
 
+
+class QCPPlottablePreparationTask : public QRunnable
+{
+public:
+  QCPPlottablePreparationTask(const QList<QCPAbstractPlottable*> &plottables, QAtomicInt *nextIndex, QSemaphore *finished);
+  
+  virtual void run();
+  static void prepareRemaining(const QList<QCPAbstractPlottable*> &plottables, QAtomicInt *nextIndex);
+  
+protected:
+  QList<QCPAbstractPlottable*> mPlottables;
+  QAtomicInt *mNextIndex;
+  QSemaphore *mFinished;
+};
+
 #endif // QCP_CORE_H
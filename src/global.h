@@ -44,8 +44,23 @@
 #include <QStack>
 #include <QCache>
 #include <QMargins>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QTimer>
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+#  include <QElapsedTimer>
+#else
+#  include <QTime>
+#endif
 #include <qmath.h>
 #include <limits>
+#include <algorithm>
+#if !defined(QCP_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64))
+#  define QCP_SSE2
+#  include <emmintrin.h>
+#endif
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #  include <qnumeric.h>
 #  include <QPrinter>
@@ -120,6 +135,8 @@ enum PlottingHint { phNone            = 0x000 ///< <tt>0x000</tt> No hints are s
                     ,phForceRepaint   = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpHint.
                                               ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phParallelPreparation = 0x008 ///< <tt>0x008</tt> the plot data of the visible plottables (e.g. the adaptively sampled pixel coordinates of graphs) is prepared
+                                              ///<                concurrently on the global QThreadPool before painting. Only the painting itself happens on the GUI thread.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -232,6 +232,7 @@ void QCPItemPosition::setType(QCPItemPosition::PositionType type)
 {
   if (mPositionType != type)
   {
+    mParentItem->markLayerDirty();
     // if switching from or to coordinate type that isn't valid (e.g. because axes or axis rect
     // were deleted), don't try to recover the pixelPoint() because it would output a qDebug warning.
     bool recoverPixelPosition = true;
@@ -316,6 +317,7 @@ bool QCPItemPosition::setParentAnchor(QCPItemAnchor *parentAnchor, bool keepPixe
   if (parentAnchor)
     parentAnchor->addChild(this);
   mParentAnchor = parentAnchor;
+  mParentItem->markLayerDirty();
   // restore pixel position under new parent:
   if (keepPixelPosition)
     setPixelPoint(pixelP);
@@ -339,8 +341,12 @@ bool QCPItemPosition::setParentAnchor(QCPItemAnchor *parentAnchor, bool keepPixe
 */
 void QCPItemPosition::setCoords(double key, double value)
 {
-  mKey = key;
-  mValue = value;
+  if (mKey != key || mValue != value)
+  {
+    mKey = key;
+    mValue = value;
+    mParentItem->markLayerDirty();
+  }
 }
 
 /*! \overload
@@ -465,6 +471,7 @@ void QCPItemPosition::setAxes(QCPAxis *keyAxis, QCPAxis *valueAxis)
 {
   mKeyAxis = keyAxis;
   mValueAxis = valueAxis;
+  mParentItem->markLayerDirty();
 }
 
 /*!
@@ -475,6 +482,7 @@ void QCPItemPosition::setAxes(QCPAxis *keyAxis, QCPAxis *valueAxis)
 void QCPItemPosition::setAxisRect(QCPAxisRect *axisRect)
 {
   mAxisRect = axisRect;
+  mParentItem->markLayerDirty();
 }
 
 /*!
@@ -781,8 +789,13 @@ QCPAbstractItem::QCPAbstractItem(QCustomPlot *parentPlot) :
 
 QCPAbstractItem::~QCPAbstractItem()
 {
-  // don't delete mPositions because every position is also an anchor and thus in mAnchors
-  qDeleteAll(mAnchors);
+  // don't delete mPositions because every position is also an anchor and thus in mAnchors.
+  // Detach the lists first, so anchor hierarchy traversals triggered while the anchors unregister
+  // at their children don't reach already deleted anchors of this item:
+  QList<QCPItemAnchor*> anchors = mAnchors;
+  mAnchors.clear();
+  mPositions.clear();
+  qDeleteAll(anchors);
 }
 
 /* can't make this a header inline function, because QPointer breaks with forward declared types, see QTBUG-29588 */
@@ -802,6 +815,7 @@ void QCPAbstractItem::setClipToAxisRect(bool clip)
   mClipToAxisRect = clip;
   if (mClipToAxisRect)
     setParentLayerable(mClipAxisRect.data());
+  markLayerDirty();
 }
 
 /*!
@@ -815,6 +829,7 @@ void QCPAbstractItem::setClipAxisRect(QCPAxisRect *rect)
   mClipAxisRect = rect;
   if (mClipToAxisRect)
     setParentLayerable(mClipAxisRect.data());
+  markLayerDirty();
 }
 
 /*!
@@ -856,6 +871,7 @@ void QCPAbstractItem::setSelected(bool selected)
     mSelected = selected;
     emit selectionChanged(mSelected);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -1128,6 +1144,34 @@ void QCPAbstractItem::deselectEvent(bool *selectionStateChanged)
   }
 }
 
+/*! \internal
+  
+  Reimplemented to also mark the layers of items whose positions have one of the anchors of this
+  item as parent anchor (\ref QCPItemPosition::setParentAnchor), since they move along with this
+  item.
+*/
+void QCPAbstractItem::markLayerDirty()
+{
+  // walk the anchor hierarchy iteratively, items may be anchored to each other mutually:
+  QSet<QCPAbstractItem*> visited;
+  QList<QCPAbstractItem*> pending;
+  pending << this;
+  while (!pending.isEmpty())
+  {
+    QCPAbstractItem *item = pending.takeLast();
+    if (visited.contains(item))
+      continue;
+    visited.insert(item);
+    if (item->layer())
+      item->layer()->markDirty();
+    foreach (QCPItemAnchor *anchor, item->mAnchors)
+    {
+      foreach (QCPItemPosition *child, anchor->mChildren)
+        pending << child->mParentItem;
+    }
+  }
+}
+
 /* inherits documentation from base class */
 QCP::Interaction QCPAbstractItem::selectionCategory() const
 {
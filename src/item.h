@@ -67,6 +67,7 @@ private:
   Q_DISABLE_COPY(QCPItemAnchor)
   
   friend class QCPItemPosition;
+  friend class QCPAbstractItem;
 };
 
 
@@ -185,6 +186,7 @@ protected:
   // events:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged);
   virtual void deselectEvent(bool *selectionStateChanged);
+  virtual void markLayerDirty();
   
   // introduced virtual methods:
   virtual QPointF anchorPixelPoint(int anchorId) const;
@@ -200,6 +202,7 @@ private:
   
   friend class QCustomPlot;
   friend class QCPItemAnchor;
+  friend class QCPItemPosition;
 };
 
 #endif // QCP_ITEM_H
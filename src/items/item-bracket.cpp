@@ -88,6 +88,7 @@ QCPItemBracket::~QCPItemBracket()
 void QCPItemBracket::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -98,6 +99,7 @@ void QCPItemBracket::setPen(const QPen &pen)
 void QCPItemBracket::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -111,6 +113,7 @@ void QCPItemBracket::setSelectedPen(const QPen &pen)
 void QCPItemBracket::setLength(double length)
 {
   mLength = length;
+  markLayerDirty();
 }
 
 /*!
@@ -121,6 +124,7 @@ void QCPItemBracket::setLength(double length)
 void QCPItemBracket::setStyle(QCPItemBracket::BracketStyle style)
 {
   mStyle = style;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
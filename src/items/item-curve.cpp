@@ -82,6 +82,7 @@ QCPItemCurve::~QCPItemCurve()
 void QCPItemCurve::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -92,6 +93,7 @@ void QCPItemCurve::setPen(const QPen &pen)
 void QCPItemCurve::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -105,6 +107,7 @@ void QCPItemCurve::setSelectedPen(const QPen &pen)
 void QCPItemCurve::setHead(const QCPLineEnding &head)
 {
   mHead = head;
+  markLayerDirty();
 }
 
 /*!
@@ -118,6 +121,7 @@ void QCPItemCurve::setHead(const QCPLineEnding &head)
 void QCPItemCurve::setTail(const QCPLineEnding &tail)
 {
   mTail = tail;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -80,6 +80,7 @@ QCPItemEllipse::~QCPItemEllipse()
 void QCPItemEllipse::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -90,6 +91,7 @@ void QCPItemEllipse::setPen(const QPen &pen)
 void QCPItemEllipse::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -101,6 +103,7 @@ void QCPItemEllipse::setSelectedPen(const QPen &pen)
 void QCPItemEllipse::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -112,6 +115,7 @@ void QCPItemEllipse::setBrush(const QBrush &brush)
 void QCPItemEllipse::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
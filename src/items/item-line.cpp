@@ -71,6 +71,7 @@ QCPItemLine::~QCPItemLine()
 void QCPItemLine::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -81,6 +82,7 @@ void QCPItemLine::setPen(const QPen &pen)
 void QCPItemLine::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -94,6 +96,7 @@ void QCPItemLine::setSelectedPen(const QPen &pen)
 void QCPItemLine::setHead(const QCPLineEnding &head)
 {
   mHead = head;
+  markLayerDirty();
 }
 
 /*!
@@ -107,6 +110,7 @@ void QCPItemLine::setHead(const QCPLineEnding &head)
 void QCPItemLine::setTail(const QCPLineEnding &tail)
 {
   mTail = tail;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -82,6 +82,7 @@ void QCPItemPixmap::setPixmap(const QPixmap &pixmap)
   mPixmap = pixmap;
   if (mPixmap.isNull())
     qDebug() << Q_FUNC_INFO << "pixmap is null";
+  markLayerDirty();
 }
 
 /*!
@@ -93,6 +94,7 @@ void QCPItemPixmap::setScaled(bool scaled, Qt::AspectRatioMode aspectRatioMode)
   mScaled = scaled;
   mAspectRatioMode = aspectRatioMode;
   updateScaledPixmap();
+  markLayerDirty();
 }
 
 /*!
@@ -103,6 +105,7 @@ void QCPItemPixmap::setScaled(bool scaled, Qt::AspectRatioMode aspectRatioMode)
 void QCPItemPixmap::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -113,6 +116,7 @@ void QCPItemPixmap::setPen(const QPen &pen)
 void QCPItemPixmap::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
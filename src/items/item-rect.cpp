@@ -77,6 +77,7 @@ QCPItemRect::~QCPItemRect()
 void QCPItemRect::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -87,6 +88,7 @@ void QCPItemRect::setPen(const QPen &pen)
 void QCPItemRect::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -98,6 +100,7 @@ void QCPItemRect::setSelectedPen(const QPen &pen)
 void QCPItemRect::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -109,6 +112,7 @@ void QCPItemRect::setBrush(const QBrush &brush)
 void QCPItemRect::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
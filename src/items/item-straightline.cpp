@@ -69,6 +69,7 @@ QCPItemStraightLine::~QCPItemStraightLine()
 void QCPItemStraightLine::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -79,6 +80,7 @@ void QCPItemStraightLine::setPen(const QPen &pen)
 void QCPItemStraightLine::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -44,6 +44,9 @@
   setTextAlignment.
   
   The text may be rotated around the \a position point with \ref setRotation.
+  
+  If the plotting hint \ref QCP::phCacheLabels is set, unrotated text is rendered once into a pixmap
+  of the shared \ref QCPLabelCache and drawn from there in subsequent replots.
 */
 
 /*!
@@ -88,6 +91,7 @@ QCPItemText::~QCPItemText()
 void QCPItemText::setColor(const QColor &color)
 {
   mColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -96,6 +100,7 @@ void QCPItemText::setColor(const QColor &color)
 void QCPItemText::setSelectedColor(const QColor &color)
 {
   mSelectedColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -107,6 +112,7 @@ void QCPItemText::setSelectedColor(const QColor &color)
 void QCPItemText::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -118,6 +124,7 @@ void QCPItemText::setPen(const QPen &pen)
 void QCPItemText::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -129,6 +136,7 @@ void QCPItemText::setSelectedPen(const QPen &pen)
 void QCPItemText::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -140,6 +148,7 @@ void QCPItemText::setBrush(const QBrush &brush)
 void QCPItemText::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -150,6 +159,7 @@ void QCPItemText::setSelectedBrush(const QBrush &brush)
 void QCPItemText::setFont(const QFont &font)
 {
   mFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -160,6 +170,7 @@ void QCPItemText::setFont(const QFont &font)
 void QCPItemText::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -171,6 +182,7 @@ void QCPItemText::setSelectedFont(const QFont &font)
 void QCPItemText::setText(const QString &text)
 {
   mText = text;
+  markLayerDirty();
 }
 
 /*!
@@ -188,6 +200,7 @@ void QCPItemText::setText(const QString &text)
 void QCPItemText::setPositionAlignment(Qt::Alignment alignment)
 {
   mPositionAlignment = alignment;
+  markLayerDirty();
 }
 
 /*!
@@ -196,6 +209,7 @@ void QCPItemText::setPositionAlignment(Qt::Alignment alignment)
 void QCPItemText::setTextAlignment(Qt::Alignment alignment)
 {
   mTextAlignment = alignment;
+  markLayerDirty();
 }
 
 /*!
@@ -205,6 +219,7 @@ void QCPItemText::setTextAlignment(Qt::Alignment alignment)
 void QCPItemText::setRotation(double degrees)
 {
   mRotation = degrees;
+  markLayerDirty();
 }
 
 /*!
@@ -214,6 +229,7 @@ void QCPItemText::setRotation(double degrees)
 void QCPItemText::setPadding(const QMargins &padding)
 {
   mPadding = padding;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -268,7 +284,31 @@ void QCPItemText::draw(QCPPainter *painter)
     }
     painter->setBrush(Qt::NoBrush);
     painter->setPen(QPen(mainColor()));
-    painter->drawText(textRect, Qt::TextDontClip|mTextAlignment, mText);
+    if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching) &&
+        transform.type() <= QTransform::TxTranslate && !textRect.isEmpty())
+    {
+      // unrotated and unscaled text is drawn from a pixmap of the shared label cache:
+      QByteArray parameters("itemtext");
+      parameters.append(painter->font().toString());
+      parameters.append(mainColor().name()+QByteArray::number(mainColor().alpha(), 16));
+      parameters.append(QByteArray::number((int)mTextAlignment));
+      parameters.append(QCPLabelCache::deviceParameters(painter->device()));
+      const QByteArray key = QCPLabelCache::labelKey(mText, parameters);
+      QPixmap textPixmap;
+      if (!QCPLabelCache::instance()->find(key, &textPixmap, 0))
+      {
+        textPixmap = QPixmap(textRect.size());
+        textPixmap.fill(Qt::transparent);
+        QCPPainter cachePainter(&textPixmap);
+        cachePainter.setFont(painter->font());
+        cachePainter.setPen(painter->pen());
+        cachePainter.drawText(QRect(QPoint(0, 0), textRect.size()), Qt::TextDontClip|mTextAlignment, mText);
+        cachePainter.end();
+        QCPLabelCache::instance()->insert(key, textPixmap, QPointF());
+      }
+      painter->drawPixmap(textRect.topLeft(), textPixmap);
+    } else
+      painter->drawText(textRect, Qt::TextDontClip|mTextAlignment, mText);
   }
 }
 
@@ -97,6 +97,7 @@ QCPItemTracer::~QCPItemTracer()
 void QCPItemTracer::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -107,6 +108,7 @@ void QCPItemTracer::setPen(const QPen &pen)
 void QCPItemTracer::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -117,6 +119,7 @@ void QCPItemTracer::setSelectedPen(const QPen &pen)
 void QCPItemTracer::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -127,6 +130,7 @@ void QCPItemTracer::setBrush(const QBrush &brush)
 void QCPItemTracer::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -136,6 +140,7 @@ void QCPItemTracer::setSelectedBrush(const QBrush &brush)
 void QCPItemTracer::setSize(double size)
 {
   mSize = size;
+  markLayerDirty();
 }
 
 /*!
@@ -147,6 +152,7 @@ void QCPItemTracer::setSize(double size)
 void QCPItemTracer::setStyle(QCPItemTracer::TracerStyle style)
 {
   mStyle = style;
+  markLayerDirty();
 }
 
 /*!
@@ -175,6 +181,7 @@ void QCPItemTracer::setGraph(QCPGraph *graph)
   {
     mGraph = 0;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -189,6 +196,7 @@ void QCPItemTracer::setGraph(QCPGraph *graph)
 void QCPItemTracer::setGraphKey(double key)
 {
   mGraphKey = key;
+  markLayerDirty();
 }
 
 /*!
@@ -205,6 +213,7 @@ void QCPItemTracer::setGraphKey(double key)
 void QCPItemTracer::setInterpolating(bool enabled)
 {
   mInterpolating = enabled;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -329,41 +338,41 @@ void QCPItemTracer::updatePosition()
   {
     if (mParentPlot->hasPlottable(mGraph))
     {
-      if (mGraph->data()->size() > 1)
+      QCPDataContainer *data = mGraph->data();
+      if (data->size() > 1)
       {
-        QCPDataMap::const_iterator first = mGraph->data()->constBegin();
-        QCPDataMap::const_iterator last = mGraph->data()->constEnd()-1;
-        if (mGraphKey < first.key())
-          position->setCoords(first.key(), first.value().value);
-        else if (mGraphKey > last.key())
-          position->setCoords(last.key(), last.value().value);
+        int first = 0;
+        int last = data->size()-1;
+        if (mGraphKey < data->key(first))
+          position->setCoords(data->key(first), data->value(first));
+        else if (mGraphKey > data->key(last))
+          position->setCoords(data->key(last), data->value(last));
         else
         {
-          QCPDataMap::const_iterator it = mGraph->data()->lowerBound(mGraphKey);
-          if (it != first) // mGraphKey is somewhere between iterators
+          int it = data->findBegin(mGraphKey);
+          if (it != first) // mGraphKey is somewhere between indices
           {
-            QCPDataMap::const_iterator prevIt = it-1;
+            int prevIt = it-1;
             if (mInterpolating)
             {
-              // interpolate between iterators around mGraphKey:
+              // interpolate between data points around mGraphKey:
               double slope = 0;
-              if (!qFuzzyCompare((double)it.key(), (double)prevIt.key()))
-                slope = (it.value().value-prevIt.value().value)/(it.key()-prevIt.key());
-              position->setCoords(mGraphKey, (mGraphKey-prevIt.key())*slope+prevIt.value().value);
+              if (!qFuzzyCompare(data->key(it), data->key(prevIt)))
+                slope = (data->value(it)-data->value(prevIt))/(data->key(it)-data->key(prevIt));
+              position->setCoords(mGraphKey, (mGraphKey-data->key(prevIt))*slope+data->value(prevIt));
             } else
             {
-              // find iterator with key closest to mGraphKey:
-              if (mGraphKey < (prevIt.key()+it.key())*0.5)
+              // find data point with key closest to mGraphKey:
+              if (mGraphKey < (data->key(prevIt)+data->key(it))*0.5)
                 it = prevIt;
-              position->setCoords(it.key(), it.value().value);
+              position->setCoords(data->key(it), data->value(it));
             }
-          } else // mGraphKey is exactly on first iterator
-            position->setCoords(it.key(), it.value().value);
+          } else // mGraphKey is exactly on first data point
+            position->setCoords(data->key(it), data->value(it));
         }
-      } else if (mGraph->data()->size() == 1)
+      } else if (data->size() == 1)
       {
-        QCPDataMap::const_iterator it = mGraph->data()->constBegin();
-        position->setCoords(it.key(), it.value().value);
+        position->setCoords(data->key(0), data->value(0));
       } else
         qDebug() << Q_FUNC_INFO << "graph has no data";
     } else
@@ -72,6 +72,26 @@
   
   When a layer is deleted, the objects on it are not deleted with it, but fall on the layer below
   the deleted layer, see QCustomPlot::removeLayer.
+  
+  \section layermodes Buffered layers
+  
+  By default, a layer only defines the rendering order and all its layerables are redrawn on every
+  replot (\ref lmLogical). If a layer contains many objects that rarely change, it can be switched
+  to \ref lmBuffered with \ref setMode. The layer then keeps its own paint buffer, which is only
+  redrawn when the layer is marked as dirty, and is otherwise just composited onto the plot. This
+  makes replots cheap that only change objects on other layers, e.g. a cursor or tracer on a
+  separate layer above a layer of large, static graphs.
+  
+  Layers are marked dirty automatically when layerables are added or removed, a property of one of
+  their layerables is changed with its setter (e.g. a new pen or selection state), or the plot
+  geometry, axis ranges, axis scales or antialiasing settings change. The data of graphs, curves
+  and color maps is tracked as well, so adding data points with e.g. \ref QCPGraph::addData or
+  directly via \ref QCPGraph::data is picked up at the next replot. Only changes that bypass the
+  interface of a layerable, like modifying the map returned by \ref QCPBars::data, must be
+  announced by calling \ref markDirty on the layer before the next replot.
+  
+  A single buffered layer can also be redrawn on its own with \ref replot, which skips the layout
+  update and just recomposites the plot from the layer buffers.
 */
 
 /* start documentation of inline functions */
@@ -90,6 +110,14 @@
   Layers with higher indices will be drawn above layers with lower indices.
 */
 
+/*! \fn bool QCPLayer::isDirty() const
+  
+  Returns whether the paint buffer of this layer needs to be redrawn at the next replot. This is
+  only relevant if the layer is in \ref lmBuffered mode.
+  
+  \see markDirty, setMode
+*/
+
 /* end documentation of inline functions */
 
 /*!
@@ -105,7 +133,9 @@ QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mParentPlot(parentPlot),
   mName(layerName),
   mIndex(-1), // will be set to a proper value by the QCustomPlot layer creation function
-  mVisible(true)
+  mVisible(true),
+  mMode(lmLogical),
+  mDirty(true)
 {
   // Note: no need to make sure layerName is unique, because layer
   // management is done with QCustomPlot functions.
@@ -136,6 +166,172 @@ QCPLayer::~QCPLayer()
 void QCPLayer::setVisible(bool visible)
 {
   mVisible = visible;
+  markDirty();
+}
+
+/*!
+  Sets how this layer is rendered during a replot.
+  
+  In \ref lmLogical mode (the default), the layerables are drawn directly into the paint buffer of
+  the parent plot on every replot. In \ref lmBuffered mode, the layer keeps a paint buffer of its
+  own, which is only redrawn when the layer is dirty, see \ref markDirty.
+  
+  Buffered layers are only used for regular replots. Exports like \ref QCustomPlot::savePdf or
+  \ref QCustomPlot::toPixmap always draw the layerables directly.
+*/
+void QCPLayer::setMode(QCPLayer::LayerMode mode)
+{
+  if (mMode != mode)
+  {
+    mMode = mode;
+    if (mMode == lmLogical)
+      mPaintBuffer = QPixmap(); // release memory of buffer that isn't used anymore
+    markDirty();
+  }
+}
+
+/*!
+  Marks the paint buffer of this layer as outdated, so it is redrawn at the next replot. This has
+  no effect if the layer is in \ref lmLogical mode.
+  
+  Call this function after changing a layerable on a buffered layer in a way that isn't tracked
+  automatically, e.g. after modifying the data map of a QCPBars directly. See the class
+  documentation for the changes that mark layers dirty automatically.
+  
+  \see isDirty, setMode
+*/
+void QCPLayer::markDirty()
+{
+  mDirty = true;
+}
+
+/*!
+  Redraws only this layer and updates the plot widget, without a full \ref QCustomPlot::replot.
+  
+  If the layer is in \ref lmBuffered mode, its layerables are drawn into the paint buffer of the
+  layer and the plot image is recomposited from the buffers of all layers. The layout of the plot
+  isn't updated and the plottables on other layers aren't prepared again, which makes this much
+  cheaper than a full replot. This is useful for frequently updated overlays, like a tracer or text
+  item following the mouse cursor, on a layer above layers with large plottables. For best
+  performance, the other layers should be in \ref lmBuffered mode too, because layers in \ref
+  lmLogical mode have no buffer and are drawn again.
+  
+  Since the layout isn't updated, changes that affect the plot geometry, like new axis ranges or
+  tick labels that need more space, only take effect at the next full \ref QCustomPlot::replot. The
+  signals \ref QCustomPlot::beforeReplot and \ref QCustomPlot::afterReplot are not emitted.
+  
+  If the layer is in \ref lmLogical mode, the parent plot hasn't been replotted yet, or the plot
+  state the layer buffers were drawn with has changed since the last replot (e.g. the viewport,
+  axis rect geometries or axis ranges), this function performs a full \ref QCustomPlot::replot.
+*/
+void QCPLayer::replot()
+{
+  if (mMode == lmBuffered && !mParentPlot->mLayerBufferState.isEmpty() && mParentPlot->layerBufferState() == mParentPlot->mLayerBufferState)
+  {
+    markDirty();
+    mParentPlot->compositeLayers();
+  } else
+    mParentPlot->replot();
+}
+
+/*! \internal
+  
+  Draws all visible layerables of this layer with \a painter, in the order of \ref children.
+  
+  If \a timing is not 0, the time each layerable takes to draw is appended to its layerable
+  timings (see \ref QCustomPlot::setReplotTimingHistory).
+  
+  \see drawToPaintBuffer
+*/
+void QCPLayer::draw(QCPPainter *painter, QCPReplotTiming *timing)
+{
+  if (!timing)
+  {
+    foreach (QCPLayerable *child, mChildren)
+    {
+      if (child->realVisibility())
+        drawChild(painter, child);
+    }
+    return;
+  }
+  
+  QCPReplotTimer timer;
+  foreach (QCPLayerable *child, mChildren)
+  {
+    if (child->realVisibility())
+    {
+      timer.start();
+      drawChild(painter, child);
+      timing->layerables.append(qMakePair(QPointer<QCPLayerable>(child), timer.elapsedMs()));
+    }
+  }
+}
+
+/*! \internal
+  
+  Draws the single layerable \a child with \a painter, using the clip rect and antialiasing hint
+  of the layerable.
+*/
+void QCPLayer::drawChild(QCPPainter *painter, QCPLayerable *child)
+{
+  painter->save();
+  painter->setClipRect(child->clipRect().translated(0, -1));
+  child->applyDefaultAntialiasingHint(painter);
+  child->draw(painter);
+  painter->restore();
+}
+
+/*! \internal
+  
+  Makes sure the paint buffer of this layer has the given \a size and contains the current
+  appearance of the layer. The buffer is only redrawn if the layer is dirty or the size changed,
+  otherwise the contents of the last call are kept.
+  
+  If \a timing is not 0, the time each layerable takes to draw into the buffer is recorded in it.
+  
+  This is used by \ref QCustomPlot::draw for layers in \ref lmBuffered mode.
+*/
+void QCPLayer::drawToPaintBuffer(const QSize &size, QCPReplotTiming *timing)
+{
+  if (mPaintBuffer.size() != size)
+  {
+    mPaintBuffer = QPixmap(size);
+    mDirty = true;
+  }
+  if (!mDirty)
+    return;
+  
+  mPaintBuffer.fill(Qt::transparent);
+  QCPPainter painter;
+  painter.begin(&mPaintBuffer);
+  if (painter.isActive())
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    draw(&painter, timing);
+    painter.end();
+    mDirty = false;
+  } else
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on layer buffer";
+}
+
+/*! \internal
+  
+  Collects the buffer state of all layerables on this layer (see \ref
+  QCPLayerable::appendBufferState), e.g. the data revisions of graphs. If it differs from the
+  state collected the last time, the layer is marked dirty.
+  
+  This is called by \ref QCustomPlot::updateLayerBufferState for layers in \ref lmBuffered mode.
+*/
+void QCPLayer::updateChildBufferState()
+{
+  QVector<double> state;
+  foreach (QCPLayerable *child, mChildren)
+    child->appendBufferState(state);
+  if (state != mChildBufferState)
+  {
+    mChildBufferState = state;
+    markDirty();
+  }
 }
 
 /*! \internal
@@ -156,6 +352,7 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
       mChildren.prepend(layerable);
     else
       mChildren.append(layerable);
+    markDirty();
   } else
     qDebug() << Q_FUNC_INFO << "layerable is already child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
@@ -171,7 +368,9 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
 */
 void QCPLayer::removeChild(QCPLayerable *layerable)
 {
-  if (!mChildren.removeOne(layerable))
+  if (mChildren.removeOne(layerable))
+    markDirty();
+  else
     qDebug() << Q_FUNC_INFO << "layerable is not child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
 
@@ -315,6 +514,7 @@ QCPLayerable::~QCPLayerable()
 void QCPLayerable::setVisible(bool on)
 {
   mVisible = on;
+  markLayerDirty();
 }
 
 /*!
@@ -359,6 +559,7 @@ bool QCPLayerable::setLayer(const QString &layerName)
 void QCPLayerable::setAntialiased(bool enabled)
 {
   mAntialiased = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -518,6 +719,21 @@ void QCPLayerable::applyAntialiasingHint(QCPPainter *painter, bool localAntialia
     painter->setAntialiasing(localAntialiased);
 }
 
+/*! \internal
+  
+  Marks the layer of this layerable as dirty (see \ref QCPLayer::markDirty), so a buffered layer
+  is redrawn at the next replot. Subclasses call this from every setter that changes the
+  appearance of the layerable.
+  
+  Reimplementations additionally mark the layers of other layerables whose appearance depends on
+  this layerable, e.g. the legend item of a plottable.
+*/
+void QCPLayerable::markLayerDirty()
+{
+  if (mLayer)
+    mLayer->markDirty();
+}
+
 /*! \internal
 
   This function is called by \ref initializeParentPlot, to allow subclasses to react on the setting
@@ -572,6 +788,21 @@ QRect QCPLayerable::clipRect() const
     return QRect();
 }
 
+/*! \internal
+  
+  Appends values to \a state which change whenever the appearance of this layerable changes in a
+  way that isn't announced with \ref markLayerDirty, typically the revision of data that can be
+  modified directly by the user, like \ref QCPDataContainer::revision.
+  
+  Layers in \ref QCPLayer::lmBuffered mode compare the collected state of their layerables at
+  every replot, and redraw their paint buffer if it changed. The default implementation appends
+  nothing.
+*/
+void QCPLayerable::appendBufferState(QVector<double> &state) const
+{
+  Q_UNUSED(state)
+}
+
 /*! \internal
   
   This event is called when the layerable shall be selected, as a consequence of a click by the
@@ -33,6 +33,7 @@ class QCustomPlot;
 class QCPLayerable;
 class QCPLayoutElement;
 class QCPLayout;
+class QCPReplotTiming;
 
 class QCP_LIB_DECL QCPLayer : public QObject
 {
@@ -43,8 +44,19 @@ class QCP_LIB_DECL QCPLayer : public QObject
   Q_PROPERTY(int index READ index)
   Q_PROPERTY(QList<QCPLayerable*> children READ children)
   Q_PROPERTY(bool visible READ visible WRITE setVisible)
+  Q_PROPERTY(LayerMode mode READ mode WRITE setMode)
   /// \endcond
 public:
+  /*!
+    Defines how the layer is rendered during a replot.
+    
+    \see setMode
+  */
+  enum LayerMode { lmLogical   ///< Layer is only used for rendering order, its layerables are drawn directly into the plot's paint buffer on every replot
+                   ,lmBuffered ///< Layer has its own paint buffer, which is only redrawn when the layer is dirty (see \ref markDirty) and is otherwise reused
+                 };
+  Q_ENUMS(LayerMode)
+  
   QCPLayer(QCustomPlot* parentPlot, const QString &layerName);
   ~QCPLayer();
   
@@ -54,9 +66,16 @@ public:
   int index() const { return mIndex; }
   QList<QCPLayerable*> children() const { return mChildren; }
   bool visible() const { return mVisible; }
+  LayerMode mode() const { return mMode; }
+  bool isDirty() const { return mDirty; }
   
   // setters:
   void setVisible(bool visible);
+  void setMode(LayerMode mode);
+  
+  // non-property methods:
+  void markDirty();
+  void replot();
   
 protected:
   // property members:
@@ -65,8 +84,18 @@ protected:
   int mIndex;
   QList<QCPLayerable*> mChildren;
   bool mVisible;
+  LayerMode mMode;
+  
+  // non-property members:
+  QPixmap mPaintBuffer;
+  bool mDirty;
+  QVector<double> mChildBufferState;
   
   // non-virtual methods:
+  void draw(QCPPainter *painter, QCPReplotTiming *timing=0);
+  void drawChild(QCPPainter *painter, QCPLayerable *child);
+  void drawToPaintBuffer(const QSize &size, QCPReplotTiming *timing=0);
+  void updateChildBufferState();
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
   
@@ -127,6 +156,8 @@ protected:
   virtual QRect clipRect() const;
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const = 0;
   virtual void draw(QCPPainter *painter) = 0;
+  virtual void markLayerDirty();
+  virtual void appendBufferState(QVector<double> &state) const;
   // events:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged);
   virtual void deselectEvent(bool *selectionStateChanged);
@@ -142,6 +173,7 @@ private:
   
   friend class QCustomPlot;
   friend class QCPAxisRect;
+  friend class QCPLayer;
 };
 
 #endif // QCP_LAYER_H
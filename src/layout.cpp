@@ -437,6 +437,8 @@ void QCPLayoutElement::setMargins(const QMargins &margins)
   {
     mMargins = margins;
     mRect = mOuterRect.adjusted(mMargins.left(), mMargins.top(), -mMargins.right(), -mMargins.bottom());
+    if (mParentLayout) // margins may be part of the size hints
+      mParentLayout->invalidateLayout();
   }
 }
 
@@ -573,11 +575,27 @@ void QCPLayoutElement::setMarginGroup(QCP::MarginSides sides, QCPMarginGroup *gr
   elements, and pass the current \a phase unchanged.
   
   The default implementation executes the automatic margin mechanism in the \ref upMargins phase.
-  Subclasses should make sure to call the base class implementation.
+  In the \ref upPreparation phase, it compares the current \ref minimumSizeHint and \ref
+  maximumSizeHint with the ones of the previous call, and invalidates the parent layout if they
+  changed (see \ref QCPLayout::invalidateLayout). Subclasses should make sure to call the base
+  class implementation.
 */
 void QCPLayoutElement::update(UpdatePhase phase)
 {
-  if (phase == upMargins)
+  if (phase == upPreparation)
+  {
+    if (mParentLayout)
+    {
+      const QSize minimumHint = minimumSizeHint();
+      const QSize maximumHint = maximumSizeHint();
+      if (minimumHint != mReportedMinimumSizeHint || maximumHint != mReportedMaximumSizeHint)
+      {
+        mReportedMinimumSizeHint = minimumHint;
+        mReportedMaximumSizeHint = maximumHint;
+        mParentLayout->invalidateLayout();
+      }
+    }
+  } else if (phase == upMargins)
   {
     if (mAutoMargins != QCP::msNone)
     {
@@ -669,6 +687,17 @@ double QCPLayoutElement::selectTest(const QPointF &pos, bool onlySelectable, QVa
     return -1;
 }
 
+/*! \internal
+  
+  Appends the inner and outer rect of this layout element, so a buffered layer is redrawn when the
+  layout placed the element differently.
+*/
+void QCPLayoutElement::appendBufferState(QVector<double> &state) const
+{
+  state << mRect.x() << mRect.y() << mRect.width() << mRect.height();
+  state << mOuterRect.x() << mOuterRect.y() << mOuterRect.width() << mOuterRect.height();
+}
+
 /*! \internal
   
   propagates the parent plot initialization to all child elements, by calling \ref
@@ -774,13 +803,15 @@ int QCPLayoutElement::calculateAutoMargin(QCP::MarginSide side)
   Creates an instance of QCPLayout and sets default values. Note that since QCPLayout
   is an abstract base class, it can't be instantiated directly.
 */
-QCPLayout::QCPLayout()
+QCPLayout::QCPLayout() :
+  mLayoutValid(false)
 {
 }
 
 /*!
   First calls the QCPLayoutElement::update base class implementation to update the margins on this
-  layout.
+  layout. (The size hint comparison of the \ref upPreparation phase is skipped, because layouts
+  report changes of their size hints via \ref invalidateLayout directly.)
   
   Then calls \ref updateLayout which subclasses reimplement to reposition and resize their cells.
   
@@ -788,7 +819,8 @@ QCPLayout::QCPLayout()
 */
 void QCPLayout::update(UpdatePhase phase)
 {
-  QCPLayoutElement::update(phase);
+  if (phase != upPreparation)
+    QCPLayoutElement::update(phase);
   
   // set child element rects according to layout:
   if (phase == upLayout)
@@ -888,16 +920,37 @@ void QCPLayout::clear()
   simplify();
 }
 
+/*!
+  Marks the arrangement of the child elements as outdated, so it is recalculated by \ref
+  updateLayout upon the next replot. Since the size hints of this layout may change along with its
+  elements, the parent layout (if any) is invalidated as well.
+  
+  Layouts only recalculate their arrangement if their own \ref rect, the structure of the layout,
+  or size constraints and size hints of their elements changed. The built-in layouts and layout
+  elements call this method automatically. If the size hints of a custom layout element change
+  for other reasons than a change of its margins, minimum or maximum size, they are detected in
+  the \ref QCPLayoutElement::upPreparation phase of the next replot. Calling this method is only
+  necessary if a custom layout depends on parameters that aren't covered by that.
+*/
+void QCPLayout::invalidateLayout()
+{
+  mLayoutValid = false;
+  if (QCPLayout *l = qobject_cast<QCPLayout*>(parent()))
+    l->invalidateLayout();
+}
+
 /*!
   Subclasses call this method to report changed (minimum/maximum) size constraints.
   
-  If the parent of this layout is again a QCPLayout, forwards the call to the parent's \ref
+  Marks the arrangement of the child elements as outdated (see \ref invalidateLayout). If the
+  parent of this layout is again a QCPLayout, forwards the call to the parent's \ref
   sizeConstraintsChanged. If the parent is a QWidget (i.e. is the \ref QCustomPlot::plotLayout of
   QCustomPlot), calls QWidget::updateGeometry, so if the QCustomPlot widget is inside a Qt QLayout,
   it may update itself and resize cells accordingly.
 */
 void QCPLayout::sizeConstraintsChanged() const
 {
+  mLayoutValid = false;
   if (QWidget *w = qobject_cast<QWidget*>(parent()))
     w->updateGeometry();
   else if (QCPLayout *l = qobject_cast<QCPLayout*>(parent()))
@@ -920,6 +973,47 @@ void QCPLayout::updateLayout()
 {
 }
 
+/*! \internal
+  
+  Returns whether the arrangement of the child elements is still the one of the last call to \ref
+  validateLayout, i.e. whether this layout wasn't invalidated (\ref invalidateLayout), its inner
+  \ref rect is unchanged and no child element was moved or resized by something other than this
+  layout. Subclasses may skip the recalculation in \ref updateLayout in that case.
+*/
+bool QCPLayout::layoutValid() const
+{
+  if (!mLayoutValid || mLayoutRect != mRect)
+    return false;
+  const int elCount = elementCount();
+  if (mLayoutOuterRects.size() != elCount)
+    return false;
+  for (int i=0; i<elCount; ++i)
+  {
+    QCPLayoutElement *el = elementAt(i);
+    if ((el ? el->outerRect() : QRect()) != mLayoutOuterRects.at(i))
+      return false;
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Subclasses call this method at the end of \ref updateLayout, to remember the arrangement of the
+  child elements for \ref layoutValid.
+*/
+void QCPLayout::validateLayout()
+{
+  const int elCount = elementCount();
+  mLayoutOuterRects.resize(elCount);
+  for (int i=0; i<elCount; ++i)
+  {
+    QCPLayoutElement *el = elementAt(i);
+    mLayoutOuterRects[i] = el ? el->outerRect() : QRect();
+  }
+  mLayoutRect = mRect;
+  mLayoutValid = true;
+}
+
 
 /*! \internal
   
@@ -942,6 +1036,7 @@ void QCPLayout::adoptElement(QCPLayoutElement *el)
     el->setParent(this);
     if (!el->parentPlot())
       el->initializeParentPlot(mParentPlot);
+    invalidateLayout();
   } else
     qDebug() << Q_FUNC_INFO << "Null element passed";
 }
@@ -963,6 +1058,7 @@ void QCPLayout::releaseElement(QCPLayoutElement *el)
     el->mParentLayout = 0;
     el->setParentLayerable(0);
     el->setParent(mParentPlot);
+    invalidateLayout();
     // Note: Don't initializeParentPlot(0) here, because layout element will stay in same parent plot
   } else
     qDebug() << Q_FUNC_INFO << "Null element passed";
@@ -1254,8 +1350,10 @@ void QCPLayoutGrid::setColumnStretchFactor(int column, double factor)
   if (column >= 0 && column < columnCount())
   {
     if (factor > 0)
+    {
       mColumnStretchFactors[column] = factor;
-    else
+      invalidateLayout();
+    } else
       qDebug() << Q_FUNC_INFO << "Invalid stretch factor, must be positive:" << factor;
   } else
     qDebug() << Q_FUNC_INFO << "Invalid column:" << column;
@@ -1285,6 +1383,7 @@ void QCPLayoutGrid::setColumnStretchFactors(const QList<double> &factors)
         mColumnStretchFactors[i] = 1;
       }
     }
+    invalidateLayout();
   } else
     qDebug() << Q_FUNC_INFO << "Column count not equal to passed stretch factor count:" << factors;
 }
@@ -1305,8 +1404,10 @@ void QCPLayoutGrid::setRowStretchFactor(int row, double factor)
   if (row >= 0 && row < rowCount())
   {
     if (factor > 0)
+    {
       mRowStretchFactors[row] = factor;
-    else
+      invalidateLayout();
+    } else
       qDebug() << Q_FUNC_INFO << "Invalid stretch factor, must be positive:" << factor;
   } else
     qDebug() << Q_FUNC_INFO << "Invalid row:" << row;
@@ -1336,6 +1437,7 @@ void QCPLayoutGrid::setRowStretchFactors(const QList<double> &factors)
         mRowStretchFactors[i] = 1;
       }
     }
+    invalidateLayout();
   } else
     qDebug() << Q_FUNC_INFO << "Row count not equal to passed stretch factor count:" << factors;
 }
@@ -1347,7 +1449,11 @@ void QCPLayoutGrid::setRowStretchFactors(const QList<double> &factors)
 */
 void QCPLayoutGrid::setColumnSpacing(int pixels)
 {
-  mColumnSpacing = pixels;
+  if (mColumnSpacing != pixels)
+  {
+    mColumnSpacing = pixels;
+    invalidateLayout();
+  }
 }
 
 /*!
@@ -1357,7 +1463,11 @@ void QCPLayoutGrid::setColumnSpacing(int pixels)
 */
 void QCPLayoutGrid::setRowSpacing(int pixels)
 {
-  mRowSpacing = pixels;
+  if (mRowSpacing != pixels)
+  {
+    mRowSpacing = pixels;
+    invalidateLayout();
+  }
 }
 
 /*!
@@ -1391,6 +1501,7 @@ void QCPLayoutGrid::expandTo(int newRowCount, int newColumnCount)
   }
   while (mColumnStretchFactors.size() < newColCount)
     mColumnStretchFactors.append(1);
+  invalidateLayout();
 }
 
 /*!
@@ -1417,6 +1528,7 @@ void QCPLayoutGrid::insertRow(int newIndex)
   for (int col=0; col<columnCount(); ++col)
     newRow.append((QCPLayoutElement*)0);
   mElements.insert(newIndex, newRow);
+  invalidateLayout();
 }
 
 /*!
@@ -1441,11 +1553,20 @@ void QCPLayoutGrid::insertColumn(int newIndex)
   mColumnStretchFactors.insert(newIndex, 1);
   for (int row=0; row<rowCount(); ++row)
     mElements[row].insert(newIndex, (QCPLayoutElement*)0);
+  invalidateLayout();
 }
 
-/* inherits documentation from base class */
+/*! \internal
+  
+  Sets the outer rects of the cells according to the size constraints of the elements, the stretch
+  factors and the spacing. If nothing changed since the last call (see \ref QCPLayout::layoutValid),
+  the current arrangement is kept and the size hints of the elements aren't queried.
+*/
 void QCPLayoutGrid::updateLayout()
 {
+  if (layoutValid())
+    return;
+  
   QVector<int> minColWidths, minRowHeights, maxColWidths, maxRowHeights;
   getMinimumRowColSizes(&minColWidths, &minRowHeights);
   getMaximumRowColSizes(&maxColWidths, &maxRowHeights);
@@ -1470,6 +1591,7 @@ void QCPLayoutGrid::updateLayout()
         mElements.at(row).at(col)->setOuterRect(QRect(xOffset, yOffset, colWidths.at(col), rowHeights.at(row)));
     }
   }
+  validateLayout();
 }
 
 /* inherits documentation from base class */
@@ -1594,6 +1716,7 @@ void QCPLayoutGrid::simplify()
         mElements[row].removeAt(col);
     }
   }
+  invalidateLayout();
 }
 
 /* inherits documentation from base class */
@@ -1793,8 +1916,10 @@ QRectF QCPLayoutInset::insetRect(int index) const
 void QCPLayoutInset::setInsetPlacement(int index, QCPLayoutInset::InsetPlacement placement)
 {
   if (elementAt(index))
+  {
     mInsetPlacement[index] = placement;
-  else
+    invalidateLayout();
+  } else
     qDebug() << Q_FUNC_INFO << "Invalid element index:" << index;
 }
 
@@ -1809,8 +1934,10 @@ void QCPLayoutInset::setInsetPlacement(int index, QCPLayoutInset::InsetPlacement
 void QCPLayoutInset::setInsetAlignment(int index, Qt::Alignment alignment)
 {
   if (elementAt(index))
+  {
     mInsetAlignment[index] = alignment;
-  else
+    invalidateLayout();
+  } else
     qDebug() << Q_FUNC_INFO << "Invalid element index:" << index;
 }
 
@@ -1828,14 +1955,23 @@ void QCPLayoutInset::setInsetAlignment(int index, Qt::Alignment alignment)
 void QCPLayoutInset::setInsetRect(int index, const QRectF &rect)
 {
   if (elementAt(index))
+  {
     mInsetRect[index] = rect;
-  else
+    invalidateLayout();
+  } else
     qDebug() << Q_FUNC_INFO << "Invalid element index:" << index;
 }
 
-/* inherits documentation from base class */
+/*! \internal
+  
+  Places the inset elements according to their placement, alignment and inset rect. If nothing
+  changed since the last call (see \ref QCPLayout::layoutValid), the current arrangement is kept.
+*/
 void QCPLayoutInset::updateLayout()
 {
+  if (layoutValid())
+    return;
+  
   for (int i=0; i<mElements.size(); ++i)
   {
     QRect insetRect;
@@ -1873,6 +2009,7 @@ void QCPLayoutInset::updateLayout()
     }
     mElements.at(i)->setOuterRect(insetRect);
   }
+  validateLayout();
 }
 
 /* inherits documentation from base class */
@@ -128,6 +128,8 @@ protected:
   QMargins mMargins, mMinimumMargins;
   QCP::MarginSides mAutoMargins;
   QHash<QCP::MarginSide, QCPMarginGroup*> mMarginGroups;
+  // non-property members:
+  QSize mReportedMinimumSizeHint, mReportedMaximumSizeHint; // size hints the parent layout was last laid out with
   
   // introduced virtual methods:
   virtual int calculateAutoMargin(QCP::MarginSide side);
@@ -142,6 +144,7 @@ protected:
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const { Q_UNUSED(painter) }
   virtual void draw(QCPPainter *painter) { Q_UNUSED(painter) }
   virtual void parentPlotInitialized(QCustomPlot *parentPlot);
+  virtual void appendBufferState(QVector<double> &state) const;
 
 private:
   Q_DISABLE_COPY(QCPLayoutElement)
@@ -173,13 +176,21 @@ public:
   bool removeAt(int index);
   bool remove(QCPLayoutElement* element);
   void clear();
+  void invalidateLayout();
   
 protected:
+  // non-property members:
+  mutable bool mLayoutValid;
+  QRect mLayoutRect;
+  QVector<QRect> mLayoutOuterRects;
+  
   // introduced virtual methods:
   virtual void updateLayout();
   
   // non-virtual methods:
   void sizeConstraintsChanged() const;
+  bool layoutValid() const;
+  void validateLayout();
   void adoptElement(QCPLayoutElement *el);
   void releaseElement(QCPLayoutElement *el);
   QVector<int> getSectionSizes(QVector<int> maxSizes, QVector<int> minSizes, QVector<double> stretchFactors, int totalSize) const;
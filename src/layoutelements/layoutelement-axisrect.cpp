@@ -602,6 +602,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm)
 {
   mBackgroundPixmap = pm;
   mScaledBackgroundPixmap = QPixmap();
+  markLayerDirty();
 }
 
 /*! \overload
@@ -620,6 +621,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm)
 void QCPAxisRect::setBackground(const QBrush &brush)
 {
   mBackgroundBrush = brush;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -635,6 +637,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm, bool scaled, Qt::AspectRatioM
   mScaledBackgroundPixmap = QPixmap();
   mBackgroundScaled = scaled;
   mBackgroundScaledMode = mode;
+  markLayerDirty();
 }
 
 /*!
@@ -650,6 +653,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm, bool scaled, Qt::AspectRatioM
 void QCPAxisRect::setBackgroundScaled(bool scaled)
 {
   mBackgroundScaled = scaled;
+  markLayerDirty();
 }
 
 /*!
@@ -660,6 +664,7 @@ void QCPAxisRect::setBackgroundScaled(bool scaled)
 void QCPAxisRect::setBackgroundScaledMode(Qt::AspectRatioMode mode)
 {
   mBackgroundScaledMode = mode;
+  markLayerDirty();
 }
 
 /*!
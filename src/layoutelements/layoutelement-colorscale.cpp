@@ -203,6 +203,7 @@ void QCPColorScale::setType(QCPAxis::AxisType type)
   if (mType != type)
   {
     mType = type;
+    markLayerDirty();
     QCPRange rangeTransfer(0, 6);
     double logBaseTransfer = 10;
     QString labelTransfer;
@@ -231,6 +232,7 @@ void QCPColorScale::setType(QCPAxis::AxisType type)
     connect(mColorAxis.data(), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
     mAxisRect.data()->setRangeDragAxes(QCPAxis::orientation(mType) == Qt::Horizontal ? mColorAxis.data() : 0,
                                        QCPAxis::orientation(mType) == Qt::Vertical ? mColorAxis.data() : 0);
+    mAxisRect.data()->mGradientImageInvalidated = true; // gradient strip orientation might have changed
   }
 }
 
@@ -252,6 +254,7 @@ void QCPColorScale::setDataRange(const QCPRange &dataRange)
       mColorAxis.data()->setRange(mDataRange);
     emit dataRangeChanged(mDataRange);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -275,6 +278,7 @@ void QCPColorScale::setDataScaleType(QCPAxis::ScaleType scaleType)
       setDataRange(mDataRange.sanitizedForLogScale());
     emit dataScaleTypeChanged(mDataScaleType);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -293,6 +297,7 @@ void QCPColorScale::setGradient(const QCPColorGradient &gradient)
       mAxisRect.data()->mGradientImageInvalidated = true;
     emit gradientChanged(mGradient);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -317,6 +322,7 @@ void QCPColorScale::setLabel(const QString &str)
 void QCPColorScale::setBarWidth(int width)
 {
   mBarWidth = width;
+  markLayerDirty();
 }
 
 /*!
@@ -537,6 +543,11 @@ void QCPColorScale::wheelEvent(QWheelEvent *event)
   This is a private class and not part of the public QCustomPlot interface.
   
   It provides the axis rect functionality for the QCPColorScale class.
+  
+  The color gradient is drawn from a strip image that is only one pixel thick and is stretched to
+  the axis rect when drawing. So resizing the color scale doesn't require colorizing the gradient
+  again. The strips are cached per gradient and shared between all color scales with an equal
+  gradient (see \ref gradientStrip).
 */
 
 
@@ -592,50 +603,73 @@ void QCPColorScaleAxisRectPrivate::draw(QCPPainter *painter)
     mirrorVert = mParentColorScale->mColorAxis.data()->rangeReversed() && (mParentColorScale->type() == QCPAxis::atLeft || mParentColorScale->type() == QCPAxis::atRight);
   }
   
-  painter->drawImage(rect(), mGradientImage.mirrored(mirrorHorz, mirrorVert));
+  // stretch the gradient strip over the axis rect, mirroring with the painter transform:
+  QTransform transformBackup = painter->transform();
+  if (mirrorHorz || mirrorVert)
+  {
+    const QPointF center = QRectF(rect()).center();
+    painter->translate(center);
+    painter->scale(mirrorHorz ? -1 : 1, mirrorVert ? -1 : 1);
+    painter->translate(-center);
+  }
+  painter->drawImage(rect(), mGradientImage);
+  painter->setTransform(transformBackup);
   QCPAxisRect::draw(painter);
 }
 
 /*! \internal
 
-  Uses the current gradient of the parent \ref QCPColorScale (specified in the constructor) to
-  generate a gradient image. This gradient image will be used in the \ref draw method.
+  Takes the gradient strip for the current gradient and orientation of the parent \ref
+  QCPColorScale (specified in the constructor) from the shared cache (see \ref gradientStrip). This
+  gradient image will be used in the \ref draw method.
 */
 void QCPColorScaleAxisRectPrivate::updateGradientImage()
 {
-  if (rect().isEmpty())
-    return;
+  mGradientImage = gradientStrip(mParentColorScale->mGradient, QCPAxis::orientation(mParentColorScale->mType));
+  mGradientImageInvalidated = false;
+}
+
+/*! \internal
   
-  int n = mParentColorScale->mGradient.levelCount();
-  int w, h;
-  QVector<double> data(n);
-  for (int i=0; i<n; ++i)
-    data[i] = i;
-  if (mParentColorScale->mType == QCPAxis::atBottom || mParentColorScale->mType == QCPAxis::atTop)
-  {
-    w = n;
-    h = rect().height();
-    mGradientImage = QImage(w, h, QImage::Format_RGB32);
-    QVector<QRgb*> pixels;
-    for (int y=0; y<h; ++y)
-      pixels.append(reinterpret_cast<QRgb*>(mGradientImage.scanLine(y)));
-    mParentColorScale->mGradient.colorize(data.constData(), QCPRange(0, n-1), pixels.first(), n);
-    for (int y=1; y<h; ++y)
-      memcpy(pixels.at(y), pixels.first(), n*sizeof(QRgb));
-  } else
+  Returns an image of \a gradient with one pixel per color level. For \a orientation
+  Qt::Horizontal, the image is one pixel high and the levels increase from left to right. For
+  Qt::Vertical, it is one pixel wide and the levels increase from bottom to top.
+  
+  The strips of the most recently used gradients are cached, so color scales with equal gradients
+  share the same image data and changing between gradients doesn't colorize them again.
+*/
+QImage QCPColorScaleAxisRectPrivate::gradientStrip(const QCPColorGradient &gradient, Qt::Orientation orientation)
+{
+  static QList<GradientStrips> cache; // most recently used first
+  const int maxCacheSize = 16;
+  
+  for (int i=0; i<cache.size(); ++i)
   {
-    w = rect().width();
-    h = n;
-    mGradientImage = QImage(w, h, QImage::Format_RGB32);
-    for (int y=0; y<h; ++y)
+    if (cache.at(i).gradient == gradient)
     {
-      QRgb *pixels = reinterpret_cast<QRgb*>(mGradientImage.scanLine(y));
-      const QRgb lineColor = mParentColorScale->mGradient.color(data[h-1-y], QCPRange(0, n-1));
-      for (int x=0; x<w; ++x)
-        pixels[x] = lineColor;
+      if (i > 0)
+        cache.move(i, 0);
+      return orientation == Qt::Horizontal ? cache.first().horizontal : cache.first().vertical;
     }
   }
-  mGradientImageInvalidated = false;
+  
+  GradientStrips entry;
+  entry.gradient = gradient;
+  const int n = gradient.levelCount();
+  QVector<double> data(n);
+  for (int i=0; i<n; ++i)
+    data[i] = i;
+  entry.horizontal = QImage(n, 1, QImage::Format_RGB32);
+  entry.gradient.colorize(data.constData(), QCPRange(0, n-1), reinterpret_cast<QRgb*>(entry.horizontal.scanLine(0)), n);
+  entry.vertical = QImage(1, n, QImage::Format_RGB32);
+  const QRgb *levelColors = reinterpret_cast<const QRgb*>(entry.horizontal.constScanLine(0));
+  for (int y=0; y<n; ++y)
+    *reinterpret_cast<QRgb*>(entry.vertical.scanLine(y)) = levelColors[n-1-y];
+  
+  cache.prepend(entry);
+  while (cache.size() > maxCacheSize)
+    cache.removeLast();
+  return orientation == Qt::Horizontal ? entry.horizontal : entry.vertical;
 }
 
 /*! \internal
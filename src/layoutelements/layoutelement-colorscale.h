@@ -44,6 +44,12 @@ class QCPColorScaleAxisRectPrivate : public QCPAxisRect
 public:
   explicit QCPColorScaleAxisRectPrivate(QCPColorScale *parentColorScale);
 protected:
+  struct GradientStrips
+  {
+    QCPColorGradient gradient;
+    QImage horizontal, vertical;
+  };
+  
   QCPColorScale *mParentColorScale;
   QImage mGradientImage;
   bool mGradientImageInvalidated;
@@ -56,6 +62,7 @@ protected:
   using QCPAxisRect::update;
   virtual void draw(QCPPainter *painter);
   void updateGradientImage();
+  static QImage gradientStrip(const QCPColorGradient &gradient, Qt::Orientation orientation);
   Q_SLOT void axisSelectionChanged(QCPAxis::SelectableParts selectedParts);
   Q_SLOT void axisSelectableChanged(QCPAxis::SelectableParts selectableParts);
   friend class QCPColorScale;
@@ -93,6 +93,7 @@ QCPAbstractLegendItem::QCPAbstractLegendItem(QCPLegend *parent) :
 void QCPAbstractLegendItem::setFont(const QFont &font)
 {
   mFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -103,6 +104,7 @@ void QCPAbstractLegendItem::setFont(const QFont &font)
 void QCPAbstractLegendItem::setTextColor(const QColor &color)
 {
   mTextColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -114,6 +116,7 @@ void QCPAbstractLegendItem::setTextColor(const QColor &color)
 void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -125,6 +128,7 @@ void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 void QCPAbstractLegendItem::setSelectedTextColor(const QColor &color)
 {
   mSelectedTextColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -156,6 +160,7 @@ void QCPAbstractLegendItem::setSelected(bool selected)
     mSelected = selected;
     emit selectionChanged(mSelected);
   }
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -249,7 +254,8 @@ void QCPAbstractLegendItem::deselectEvent(bool *selectionStateChanged)
 */
 QCPPlottableLegendItem::QCPPlottableLegendItem(QCPLegend *parent, QCPAbstractPlottable *plottable) :
   QCPAbstractLegendItem(parent),
-  mPlottable(plottable)
+  mPlottable(plottable),
+  mTextSizeIconHeight(0)
 {
 }
 
@@ -317,17 +323,28 @@ void QCPPlottableLegendItem::draw(QCPPainter *painter)
   
   Calculates and returns the size of this item. This includes the icon, the text and the padding in
   between.
+  
+  The size of the text is cached, it is only measured again if the plottable name, the font or the
+  icon height changed. This makes it cheap for the layout system to check this size hint on every
+  replot.
 */
 QSize QCPPlottableLegendItem::minimumSizeHint() const
 {
   if (!mPlottable) return QSize();
   QSize result(0, 0);
-  QRect textRect;
-  QFontMetrics fontMetrics(getFont());
   QSize iconSize = mParentLegend->iconSize();
-  textRect = fontMetrics.boundingRect(0, 0, 0, iconSize.height(), Qt::TextDontClip, mPlottable->name());
-  result.setWidth(iconSize.width() + mParentLegend->iconTextPadding() + textRect.width() + mMargins.left() + mMargins.right());
-  result.setHeight(qMax(textRect.height(), iconSize.height()) + mMargins.top() + mMargins.bottom());
+  const QString text = mPlottable->name();
+  const QFont font = getFont();
+  if (!mTextSize.isValid() || mTextSizeIconHeight != iconSize.height() || mTextSizeText != text || mTextSizeFont != font)
+  {
+    QFontMetrics fontMetrics(font);
+    mTextSize = fontMetrics.boundingRect(0, 0, 0, iconSize.height(), Qt::TextDontClip, text).size();
+    mTextSizeText = text;
+    mTextSizeFont = font;
+    mTextSizeIconHeight = iconSize.height();
+  }
+  result.setWidth(iconSize.width() + mParentLegend->iconTextPadding() + mTextSize.width() + mMargins.left() + mMargins.right());
+  result.setHeight(qMax(mTextSize.height(), iconSize.height()) + mMargins.top() + mMargins.bottom());
   return result;
 }
 
@@ -432,6 +449,7 @@ QCPLegend::SelectableParts QCPLegend::selectedParts() const
 void QCPLegend::setBorderPen(const QPen &pen)
 {
   mBorderPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -440,6 +458,7 @@ void QCPLegend::setBorderPen(const QPen &pen)
 void QCPLegend::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -459,6 +478,7 @@ void QCPLegend::setFont(const QFont &font)
     if (item(i))
       item(i)->setFont(mFont);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -478,6 +498,7 @@ void QCPLegend::setTextColor(const QColor &color)
     if (item(i))
       item(i)->setTextColor(color);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -487,6 +508,7 @@ void QCPLegend::setTextColor(const QColor &color)
 void QCPLegend::setIconSize(const QSize &size)
 {
   mIconSize = size;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -495,6 +517,7 @@ void QCPLegend::setIconSize(int width, int height)
 {
   mIconSize.setWidth(width);
   mIconSize.setHeight(height);
+  markLayerDirty();
 }
 
 /*!
@@ -505,6 +528,7 @@ void QCPLegend::setIconSize(int width, int height)
 void QCPLegend::setIconTextPadding(int padding)
 {
   mIconTextPadding = padding;
+  markLayerDirty();
 }
 
 /*!
@@ -516,6 +540,7 @@ void QCPLegend::setIconTextPadding(int padding)
 void QCPLegend::setIconBorderPen(const QPen &pen)
 {
   mIconBorderPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -581,6 +606,7 @@ void QCPLegend::setSelectedParts(const SelectableParts &selected)
     mSelectedParts = newSelected;
     emit selectionChanged(mSelectedParts);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -592,6 +618,7 @@ void QCPLegend::setSelectedParts(const SelectableParts &selected)
 void QCPLegend::setSelectedBorderPen(const QPen &pen)
 {
   mSelectedBorderPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -602,6 +629,7 @@ void QCPLegend::setSelectedBorderPen(const QPen &pen)
 void QCPLegend::setSelectedIconBorderPen(const QPen &pen)
 {
   mSelectedIconBorderPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -613,6 +641,7 @@ void QCPLegend::setSelectedIconBorderPen(const QPen &pen)
 void QCPLegend::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -630,6 +659,7 @@ void QCPLegend::setSelectedFont(const QFont &font)
     if (item(i))
       item(i)->setSelectedFont(font);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -647,6 +677,7 @@ void QCPLegend::setSelectedTextColor(const QColor &color)
     if (item(i))
       item(i)->setSelectedTextColor(color);
   }
+  markLayerDirty();
 }
 
 /*!
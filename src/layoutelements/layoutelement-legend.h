@@ -111,6 +111,11 @@ public:
 protected:
   // property members:
   QCPAbstractPlottable *mPlottable;
+  // non-property members:
+  mutable QString mTextSizeText; // text, font and icon height of the cached text size mTextSize
+  mutable QFont mTextSizeFont;
+  mutable int mTextSizeIconHeight;
+  mutable QSize mTextSize;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
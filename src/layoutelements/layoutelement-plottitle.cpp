@@ -111,6 +111,8 @@ QCPPlotTitle::QCPPlotTitle(QCustomPlot *parentPlot, const QString &text) :
 void QCPPlotTitle::setText(const QString &text)
 {
   mText = text;
+  mTextSize = QSize();
+  markLayerDirty();
 }
 
 /*!
@@ -121,6 +123,8 @@ void QCPPlotTitle::setText(const QString &text)
 void QCPPlotTitle::setFont(const QFont &font)
 {
   mFont = font;
+  mTextSize = QSize();
+  markLayerDirty();
 }
 
 /*!
@@ -131,6 +135,7 @@ void QCPPlotTitle::setFont(const QFont &font)
 void QCPPlotTitle::setTextColor(const QColor &color)
 {
   mTextColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -141,6 +146,7 @@ void QCPPlotTitle::setTextColor(const QColor &color)
 void QCPPlotTitle::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -151,6 +157,7 @@ void QCPPlotTitle::setSelectedFont(const QFont &font)
 void QCPPlotTitle::setSelectedTextColor(const QColor &color)
 {
   mSelectedTextColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -182,6 +189,7 @@ void QCPPlotTitle::setSelected(bool selected)
     mSelected = selected;
     emit selectionChanged(mSelected);
   }
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -201,8 +209,7 @@ void QCPPlotTitle::draw(QCPPainter *painter)
 /* inherits documentation from base class */
 QSize QCPPlotTitle::minimumSizeHint() const
 {
-  QFontMetrics metrics(mFont);
-  QSize result = metrics.boundingRect(0, 0, 0, 0, Qt::AlignCenter, mText).size();
+  QSize result = textSize();
   result.rwidth() += mMargins.left() + mMargins.right();
   result.rheight() += mMargins.top() + mMargins.bottom();
   return result;
@@ -211,8 +218,7 @@ QSize QCPPlotTitle::minimumSizeHint() const
 /* inherits documentation from base class */
 QSize QCPPlotTitle::maximumSizeHint() const
 {
-  QFontMetrics metrics(mFont);
-  QSize result = metrics.boundingRect(0, 0, 0, 0, Qt::AlignCenter, mText).size();
+  QSize result = textSize();
   result.rheight() += mMargins.top() + mMargins.bottom();
   result.setWidth(QWIDGETSIZE_MAX);
   return result;
@@ -257,6 +263,19 @@ double QCPPlotTitle::selectTest(const QPointF &pos, bool onlySelectable, QVarian
     return -1;
 }
 
+/*! \internal
+  
+  Returns the size of the bounding rect of the text in mFont, which the size hints are based on.
+  The size is measured only once and reused until the text or font changes, so the layout system
+  can query the size hints on every replot cheaply.
+*/
+QSize QCPPlotTitle::textSize() const
+{
+  if (!mTextSize.isValid())
+    mTextSize = QFontMetrics(mFont).boundingRect(0, 0, 0, 0, Qt::AlignCenter, mText).size();
+  return mTextSize;
+}
+
 /*! \internal
   
   Returns the main font to be used. This is mSelectedFont if \ref setSelected is set to
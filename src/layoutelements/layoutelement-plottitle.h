@@ -83,6 +83,8 @@ protected:
   QColor mSelectedTextColor;
   QRect mTextBoundingRect;
   bool mSelectable, mSelected;
+  // non-property members:
+  mutable QSize mTextSize; // cached by textSize, reset by setText and setFont
   
   // reimplemented virtual methods:
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const;
@@ -94,6 +96,7 @@ protected:
   virtual void deselectEvent(bool *selectionStateChanged);
   
   // non-virtual methods:
+  QSize textSize() const;
   QFont mainFont() const;
   QColor mainTextColor() const;
   
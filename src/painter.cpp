@@ -673,3 +673,171 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPLabelCache
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPLabelCache
+  \brief A process-wide cache of pre-rendered text labels
+  
+  Drawing text is expensive compared to drawing a pixmap. So if the plotting hint \ref
+  QCP::phCacheLabels is set, the tick labels of axes (and QCPItemText items with unrotated text)
+  are rendered once into pixmaps, which are then reused in subsequent replots.
+  
+  This cache is shared by all axes and items of all QCustomPlot instances in the application, so
+  e.g. many small plots with equal fonts render each distinct label only once. It is accessed via
+  \ref instance. Each label is identified by its text and a byte array of all parameters that
+  influence its appearance, such as font, color, rotation and device pixel ratio (see \ref
+  labelKey).
+  
+  The memory occupied by the cached pixmaps is limited to \ref setMaximumCost bytes. When the limit
+  is exceeded, the least recently used labels are discarded. The number of successful and failed
+  lookups can be retrieved with \ref hits and \ref misses, e.g. to choose a suitable budget.
+  
+  The cache must only be used from the GUI thread, since it holds QPixmaps.
+*/
+
+QCPLabelCache *QCPLabelCache::mInstance = 0;
+
+/*! \internal
+  
+  Creates the cache with a budget of 4 MB. Use \ref instance to access the shared cache.
+*/
+QCPLabelCache::QCPLabelCache() :
+  mCache(4*1024*1024),
+  mHits(0),
+  mMisses(0)
+{
+}
+
+/*!
+  Returns the process-wide label cache. It is created on first use and destroyed together with the
+  QCoreApplication instance.
+*/
+QCPLabelCache *QCPLabelCache::instance()
+{
+  if (!mInstance)
+  {
+    mInstance = new QCPLabelCache;
+    qAddPostRoutine(deleteInstance);
+  }
+  return mInstance;
+}
+
+/*! \internal
+  
+  Destroys the shared instance. This is registered as post routine of the QCoreApplication, so
+  the cached pixmaps are released before the application object is gone.
+*/
+void QCPLabelCache::deleteInstance()
+{
+  delete mInstance;
+  mInstance = 0;
+}
+
+/*!
+  Sets the memory budget of the cached label pixmaps to \a bytes. If the cache currently holds more
+  than that, the least recently used labels are discarded immediately.
+*/
+void QCPLabelCache::setMaximumCost(int bytes)
+{
+  mCache.setMaxCost(bytes);
+}
+
+/*!
+  Looks up the label identified by \a key (see \ref labelKey). If it exists, its pixmap and the
+  offset at which it must be drawn relative to the label anchor are returned in \a pixmap and \a
+  offset, and this method returns true. Otherwise it returns false.
+  
+  Each call counts as a hit or a miss of the cache statistics.
+*/
+bool QCPLabelCache::find(const QByteArray &key, QPixmap *pixmap, QPointF *offset)
+{
+  const CachedLabel *cachedLabel = mCache.object(key);
+  if (!cachedLabel)
+  {
+    ++mMisses;
+    return false;
+  }
+  ++mHits;
+  if (pixmap)
+    *pixmap = cachedLabel->pixmap;
+  if (offset)
+    *offset = cachedLabel->offset;
+  return true;
+}
+
+/*!
+  Inserts a label with the given \a key (see \ref labelKey), \a pixmap and drawing \a offset
+  relative to the label anchor. The cost of the label is the memory size of \a pixmap. If the
+  label doesn't fit into the budget (\ref setMaximumCost) at all, it isn't cached.
+*/
+void QCPLabelCache::insert(const QByteArray &key, const QPixmap &pixmap, const QPointF &offset)
+{
+  CachedLabel *cachedLabel = new CachedLabel;
+  cachedLabel->pixmap = pixmap;
+  cachedLabel->offset = offset;
+  mCache.insert(key, cachedLabel, qMax(1, pixmap.width()*pixmap.height()*4)); // takes ownership, also if the label is rejected
+}
+
+/*!
+  Removes all labels whose key was created with \a parameters (see \ref labelKey).
+*/
+void QCPLabelCache::remove(const QByteArray &parameters)
+{
+  const QByteArray prefix = labelKey(QString(), parameters);
+  QList<QByteArray> keys = mCache.keys();
+  for (int i=0; i<keys.size(); ++i)
+  {
+    if (keys.at(i).startsWith(prefix))
+      mCache.remove(keys.at(i));
+  }
+}
+
+/*!
+  Removes all cached labels.
+*/
+void QCPLabelCache::clear()
+{
+  mCache.clear();
+}
+
+/*!
+  Sets the counters returned by \ref hits and \ref misses to zero.
+*/
+void QCPLabelCache::resetStatistics()
+{
+  mHits = 0;
+  mMisses = 0;
+}
+
+/*!
+  Returns the key of the label with the given \a text. \a parameters must uniquely describe
+  everything else that influences the appearance of the pixmap and its offset, e.g. font, color,
+  rotation and the device parameters (see \ref deviceParameters).
+*/
+QByteArray QCPLabelCache::labelKey(const QString &text, const QByteArray &parameters)
+{
+  QByteArray result;
+  result.reserve(parameters.size()+1+text.size()*2);
+  result.append(parameters);
+  result.append('\n');
+  result.append(text.toUtf8());
+  return result;
+}
+
+/*!
+  Returns a byte array that identifies the properties of the paint \a device that influence the
+  rendering of label pixmaps, i.e. its device pixel ratio. It should be part of the parameters
+  passed to \ref labelKey.
+*/
+QByteArray QCPLabelCache::deviceParameters(const QPaintDevice *device)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+  if (device)
+    return "dpr"+QByteArray::number(device->devicePixelRatio());
+#else
+  Q_UNUSED(device)
+#endif
+  return "dpr1";
+}
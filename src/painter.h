@@ -160,4 +160,47 @@ protected:
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCPPainter::PainterModes)
 
+
+class QCP_LIB_DECL QCPLabelCache
+{
+public:
+  static QCPLabelCache *instance();
+  
+  // getters:
+  int maximumCost() const { return mCache.maxCost(); }
+  int totalCost() const { return mCache.totalCost(); }
+  int count() const { return mCache.count(); }
+  int hits() const { return mHits; }
+  int misses() const { return mMisses; }
+  
+  // setters:
+  void setMaximumCost(int bytes);
+  
+  // non-property methods:
+  bool find(const QByteArray &key, QPixmap *pixmap, QPointF *offset);
+  void insert(const QByteArray &key, const QPixmap &pixmap, const QPointF &offset);
+  void remove(const QByteArray &parameters);
+  void clear();
+  void resetStatistics();
+  static QByteArray labelKey(const QString &text, const QByteArray &parameters);
+  static QByteArray deviceParameters(const QPaintDevice *device);
+  
+protected:
+  struct CachedLabel
+  {
+    QPointF offset;
+    QPixmap pixmap;
+  };
+  
+  QCache<QByteArray, CachedLabel> mCache;
+  int mHits, mMisses;
+  static QCPLabelCache *mInstance;
+  
+  QCPLabelCache();
+  static void deleteInstance();
+  
+private:
+  Q_DISABLE_COPY(QCPLabelCache)
+};
+
 #endif // QCP_PAINTER_H
@@ -205,6 +205,7 @@ QCPAbstractPlottable::QCPAbstractPlottable(QCPAxis *keyAxis, QCPAxis *valueAxis)
 void QCPAbstractPlottable::setName(const QString &name)
 {
   mName = name;
+  markLayerDirty();
 }
 
 /*!
@@ -216,6 +217,7 @@ void QCPAbstractPlottable::setName(const QString &name)
 void QCPAbstractPlottable::setAntialiasedFill(bool enabled)
 {
   mAntialiasedFill = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -227,6 +229,7 @@ void QCPAbstractPlottable::setAntialiasedFill(bool enabled)
 void QCPAbstractPlottable::setAntialiasedScatters(bool enabled)
 {
   mAntialiasedScatters = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -238,6 +241,7 @@ void QCPAbstractPlottable::setAntialiasedScatters(bool enabled)
 void QCPAbstractPlottable::setAntialiasedErrorBars(bool enabled)
 {
   mAntialiasedErrorBars = enabled;
+  markLayerDirty();
 }
 
 
@@ -253,6 +257,7 @@ void QCPAbstractPlottable::setAntialiasedErrorBars(bool enabled)
 void QCPAbstractPlottable::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -264,6 +269,7 @@ void QCPAbstractPlottable::setPen(const QPen &pen)
 void QCPAbstractPlottable::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -278,6 +284,7 @@ void QCPAbstractPlottable::setSelectedPen(const QPen &pen)
 void QCPAbstractPlottable::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -289,6 +296,7 @@ void QCPAbstractPlottable::setBrush(const QBrush &brush)
 void QCPAbstractPlottable::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -305,6 +313,7 @@ void QCPAbstractPlottable::setSelectedBrush(const QBrush &brush)
 void QCPAbstractPlottable::setKeyAxis(QCPAxis *axis)
 {
   mKeyAxis = axis;
+  markLayerDirty();
 }
 
 /*!
@@ -321,6 +330,7 @@ void QCPAbstractPlottable::setKeyAxis(QCPAxis *axis)
 void QCPAbstractPlottable::setValueAxis(QCPAxis *axis)
 {
   mValueAxis = axis;
+  markLayerDirty();
 }
 
 /*!
@@ -362,6 +372,7 @@ void QCPAbstractPlottable::setSelected(bool selected)
     mSelected = selected;
     emit selectionChanged(mSelected);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -521,6 +532,24 @@ QCP::Interaction QCPAbstractPlottable::selectionCategory() const
   return QCP::iSelectPlottables;
 }
 
+/*! \internal
+  
+  Called by QCustomPlot before the plottable is drawn, if the plotting hint \ref
+  QCP::phParallelPreparation is set. Plottables which need to process their data before drawing
+  (e.g. transforming it to pixel coordinates) may reimplement this method to do the processing and
+  cache the result, which \ref draw then uses.
+  
+  This method is called from a worker thread, concurrently with the preparation of other
+  plottables. So it must not paint, and must only read state that isn't modified during the replot.
+  Reading the axes and the plottable's own data is safe.
+  
+  The default implementation does nothing, so the plottable processes its data in \ref draw as
+  usual.
+*/
+void QCPAbstractPlottable::preparePlotData()
+{
+}
+
 /*! \internal
   
   Convenience function for transforming a key/value pair to pixels on the QCustomPlot surface,
@@ -744,3 +773,21 @@ void QCPAbstractPlottable::deselectEvent(bool *selectionStateChanged)
       *selectionStateChanged = mSelected != selBefore;
   }
 }
+
+/*! \internal
+  
+  Reimplemented to also mark the layer of the legend item that represents this plottable in the
+  default legend, since its name and legend icon depend on the properties of this plottable.
+*/
+void QCPAbstractPlottable::markLayerDirty()
+{
+  QCPLayerable::markLayerDirty();
+  if (mParentPlot && mParentPlot->legend)
+  {
+    if (QCPPlottableLegendItem *item = mParentPlot->legend->itemWithPlottable(this))
+    {
+      if (item->layer())
+        item->layer()->markDirty();
+    }
+  }
+}
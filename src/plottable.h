@@ -121,11 +121,13 @@ protected:
   // events:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged);
   virtual void deselectEvent(bool *selectionStateChanged);
+  virtual void markLayerDirty();
   
   // introduced virtual methods:
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const = 0;
   virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const = 0;
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const = 0;
+  virtual void preparePlotData();
   
   // non-virtual methods:
   void coordsToPixels(double key, double value, double &x, double &y) const;
@@ -145,6 +147,7 @@ private:
   friend class QCustomPlot;
   friend class QCPAxis;
   friend class QCPPlottableLegendItem;
+  friend class QCPPlottablePreparationTask;
 };
 
 #endif // QCP_PLOTTABLE_H
@@ -154,6 +154,7 @@ QCPBars::~QCPBars()
 void QCPBars::setWidth(double width)
 {
   mWidth = width;
+  markLayerDirty();
 }
 
 /*!
@@ -173,6 +174,7 @@ void QCPBars::setData(QCPBarDataMap *data, bool copy)
     delete mData;
     mData = data;
   }
+  markLayerDirty();
 }
 
 /*! \overload
@@ -193,6 +195,7 @@ void QCPBars::setData(const QVector<double> &key, const QVector<double> &value)
     newData.value = value[i];
     mData->insertMulti(newData.key, newData);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -217,6 +220,7 @@ void QCPBars::moveBelow(QCPBars *bars)
     qDebug() << Q_FUNC_INFO << "passed QCPBars* doesn't have same key and value axis as this QCPBars";
     return;
   }
+  markLayerDirty(); // bars stacked above this one so far move down
   // remove from stacking:
   connectBars(mBarBelow.data(), mBarAbove.data()); // Note: also works if one (or both) of them is 0
   // if new bar given, insert this bar below it:
@@ -226,6 +230,7 @@ void QCPBars::moveBelow(QCPBars *bars)
       connectBars(bars->mBarBelow.data(), this);
     connectBars(this, bars);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -250,6 +255,7 @@ void QCPBars::moveAbove(QCPBars *bars)
     qDebug() << Q_FUNC_INFO << "passed QCPBars* doesn't have same key and value axis as this QCPBars";
     return;
   }
+  markLayerDirty(); // bars stacked above this one so far move down
   // remove from stacking:
   connectBars(mBarBelow.data(), mBarAbove.data()); // Note: also works if one (or both) of them is 0
   // if new bar given, insert this bar above it:
@@ -259,6 +265,7 @@ void QCPBars::moveAbove(QCPBars *bars)
       connectBars(this, bars->mBarAbove.data());
     connectBars(bars, this);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -268,6 +275,7 @@ void QCPBars::moveAbove(QCPBars *bars)
 void QCPBars::addData(const QCPBarDataMap &dataMap)
 {
   mData->unite(dataMap);
+  markLayerDirty();
 }
 
 /*! \overload
@@ -277,6 +285,7 @@ void QCPBars::addData(const QCPBarDataMap &dataMap)
 void QCPBars::addData(const QCPBarData &data)
 {
   mData->insertMulti(data.key, data);
+  markLayerDirty();
 }
 
 /*! \overload
@@ -289,6 +298,7 @@ void QCPBars::addData(double key, double value)
   newData.key = key;
   newData.value = value;
   mData->insertMulti(newData.key, newData);
+  markLayerDirty();
 }
 
 /*! \overload
@@ -306,6 +316,7 @@ void QCPBars::addData(const QVector<double> &keys, const QVector<double> &values
     newData.value = values[i];
     mData->insertMulti(newData.key, newData);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -317,6 +328,7 @@ void QCPBars::removeDataBefore(double key)
   QCPBarDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < key)
     it = mData->erase(it);
+  markLayerDirty();
 }
 
 /*!
@@ -329,6 +341,7 @@ void QCPBars::removeDataAfter(double key)
   QCPBarDataMap::iterator it = mData->upperBound(key);
   while (it != mData->end())
     it = mData->erase(it);
+  markLayerDirty();
 }
 
 /*!
@@ -345,6 +358,7 @@ void QCPBars::removeData(double fromKey, double toKey)
   QCPBarDataMap::iterator itEnd = mData->upperBound(toKey);
   while (it != itEnd)
     it = mData->erase(it);
+  markLayerDirty();
 }
 
 /*! \overload
@@ -358,6 +372,7 @@ void QCPBars::removeData(double fromKey, double toKey)
 void QCPBars::removeData(double key)
 {
   mData->remove(key);
+  markLayerDirty();
 }
 
 /*!
@@ -367,6 +382,24 @@ void QCPBars::removeData(double key)
 void QCPBars::clearData()
 {
   mData->clear();
+  markLayerDirty();
+}
+
+/*! \internal
+  
+  Reimplemented to also mark the layers of the bars stacked above this bars plottable, since their
+  base values depend on the data of this one.
+*/
+void QCPBars::markLayerDirty()
+{
+  QCPAbstractPlottable::markLayerDirty();
+  QCPBars *bars = mBarAbove.data();
+  while (bars)
+  {
+    if (bars->layer())
+      bars->layer()->markDirty();
+    bars = bars->mBarAbove.data();
+  }
 }
 
 /* inherits documentation from base class */
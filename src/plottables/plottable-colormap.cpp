@@ -59,6 +59,21 @@
   true current minimum and maximum. The method QCPColorMap::rescaleDataRange offers a convenience
   parameter \a recalculateDataBounds which may be set to true to automatically call \ref
   recalculateDataBounds internally.
+  
+  For continuously updated maps, exact bounds can be maintained with \ref setBoundsTracking
+  instead. The minimum and maximum are then tracked per row, and only rows whose extreme value was
+  overwritten are scanned again, when the bounds are requested the next time.
+  
+  The cells are stored as double by default. If memory footprint or bandwidth matters, e.g. for
+  images of integer sensors, a smaller \ref CellType can be chosen at construction. Values are
+  then converted when they are set, integer types round and clamp them to their representable
+  range. QCPColorMap colorizes integer cells through a lookup table of all representable values
+  (see QCPColorGradient::colorize).
+  
+  Changes of single cells with \ref setCell or \ref setData are tracked as a modified rectangle of
+  cells. At the next replot, the QCPColorMap then only recolorizes this rectangle instead of the
+  whole map, which makes e.g. updating one row of a waterfall display cheap. Note that changing
+  cells far apart from each other between two replots enlarges the rectangle to span all of them.
 */
 
 /* start of documentation of inline functions */
@@ -76,16 +91,23 @@
   and \a valueSize cells in the value direction. These cells will be displayed by the \ref QCPColorMap
   at the coordinates \a keyRange and \a valueRange.
   
+  The cells are stored in the data type \a cellType, which can't be changed later.
+  
   \see setSize, setKeySize, setValueSize, setRange, setKeyRange, setValueRange
 */
-QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &keyRange, const QCPRange &valueRange) :
+QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &keyRange, const QCPRange &valueRange, CellType cellType) :
   mKeySize(0),
   mValueSize(0),
   mKeyRange(keyRange),
   mValueRange(valueRange),
   mIsEmpty(true),
+  mCellType(cellType),
+  mBoundsTracking(false),
   mData(0),
-  mDataModified(true)
+  mBoundsOutdated(false),
+  mDataModified(true),
+  mRevision(0),
+  mRowOffset(0)
 {
   setSize(keySize, valueSize);
   fill(0);
@@ -98,20 +120,26 @@ QCPColorMapData::~QCPColorMapData()
 }
 
 /*!
-  Constructs a new QCPColorMapData instance copying the data and range of \a other.
+  Constructs a new QCPColorMapData instance copying the data, range and cell type of \a other.
 */
 QCPColorMapData::QCPColorMapData(const QCPColorMapData &other) :
   mKeySize(0),
   mValueSize(0),
   mIsEmpty(true),
+  mCellType(other.mCellType),
+  mBoundsTracking(false),
   mData(0),
-  mDataModified(true)
+  mBoundsOutdated(false),
+  mDataModified(true),
+  mRevision(0),
+  mRowOffset(0)
 {
   *this = other;
 }
 
 /*!
-  Overwrites this color map data instance with the data stored in \a other.
+  Overwrites this color map data instance with the data stored in \a other. This instance also
+  takes over the cell type of \a other.
 */
 QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
 {
@@ -119,23 +147,50 @@ QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
   {
     const int keySize = other.keySize();
     const int valueSize = other.valueSize();
+    if (mCellType != other.mCellType)
+    {
+      clear(); // storage must be reallocated for the new cell type
+      mCellType = other.mCellType;
+    }
     setSize(keySize, valueSize);
     setRange(other.keyRange(), other.valueRange());
-    if (!mIsEmpty)
-      memcpy(mData, other.mData, sizeof(mData[0])*keySize*valueSize);
+    if (!mIsEmpty && mData && other.mData)
+      memcpy(mData, other.mData, (size_t)cellTypeSize(mCellType)*keySize*valueSize);
+    mRowOffset = other.mRowOffset;
     mDataBounds = other.mDataBounds;
+    mBoundsTracking = other.mBoundsTracking;
+    mRowMinimum = other.mRowMinimum;
+    mRowMaximum = other.mRowMaximum;
+    mDirtyRows = other.mDirtyRows;
+    mBoundsOutdated = other.mBoundsOutdated;
     mDataModified = true;
+    ++mRevision;
   }
   return *this;
 }
 
+/*!
+  Returns the minimum and maximum value of the data.
+  
+  Without bounds tracking, these are the buffered bounds which are only expanded by new values (see
+  the class description). If bounds tracking is enabled (\ref setBoundsTracking), the exact bounds
+  are returned. Rows whose extreme values were overwritten since the last call are scanned again to
+  achieve this, so the cost is proportional to the number of rows plus the number of changed cells.
+*/
+QCPRange QCPColorMapData::dataBounds() const
+{
+  if (mBoundsTracking && mBoundsOutdated)
+    updateTrackedBounds();
+  return mDataBounds;
+}
+
 /* undocumented getter */
 double QCPColorMapData::data(double key, double value)
 {
   int keyCell = (key-mKeyRange.lower)/(mKeyRange.upper-mKeyRange.lower)*(mKeySize-1)+0.5;
   int valueCell = (1.0-(value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower))*(mValueSize-1)+0.5;
-  if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
-    return mData[valueCell*mKeySize + keyCell];
+  if (mData && keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
+    return cellValue(physicalRow(valueCell)*mKeySize + keyCell);
   else
     return 0;
 }
@@ -143,8 +198,8 @@ double QCPColorMapData::data(double key, double value)
 /* undocumented getter */
 double QCPColorMapData::cell(int keyIndex, int valueIndex)
 {
-  if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mData[valueIndex*mKeySize + keyIndex];
+  if (mData && keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
+    return cellValue(physicalRow(valueIndex)*mKeySize + keyIndex);
   else
     return 0;
 }
@@ -172,20 +227,37 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
     mIsEmpty = mKeySize == 0 || mValueSize == 0;
     if (!mIsEmpty)
     {
+      // cells are addressed with int indices, and the byte count must fit the address space:
+      const quint64 cellCount = (quint64)mKeySize*(quint64)mValueSize;
+      const quint64 byteCount = cellCount*cellTypeSize(mCellType);
+      mData = 0;
+      if (cellCount <= (quint64)std::numeric_limits<int>::max() && byteCount <= (quint64)std::numeric_limits<size_t>::max())
+      {
 #ifdef __EXCEPTIONS
-      try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
+        try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
 #endif
-      mData = new double[mKeySize*mValueSize];
+        mData = new uchar[(size_t)byteCount];
 #ifdef __EXCEPTIONS
-      } catch (...) { mData = 0; }
+        } catch (...) { mData = 0; }
 #endif
+      }
       if (mData)
         fill(0);
       else
         qDebug() << Q_FUNC_INFO << "out of memory for data dimensions "<< mKeySize << "*" << mValueSize;
     } else
       mData = 0;
+    mRowOffset = 0;
     mDataModified = true;
+    ++mRevision;
+    if (mBoundsTracking && !mData)
+    {
+      // tracking data of allocated rows is set up by fill, here the map is empty or invalid:
+      mRowMinimum.fill(0, mValueSize);
+      mRowMaximum.fill(0, mValueSize);
+      mDirtyRows.fill(true, mValueSize);
+      mBoundsOutdated = true;
+    }
   }
 }
 
@@ -275,14 +347,23 @@ void QCPColorMapData::setData(double key, double value, double z)
 {
   int keyCell = (key-mKeyRange.lower)/(mKeyRange.upper-mKeyRange.lower)*(mKeySize-1)+0.5;
   int valueCell = (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5;
-  if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
+  if (mData && keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
   {
-    mData[valueCell*mKeySize + keyCell] = z;
+    const int row = physicalRow(valueCell);
+    const int index = row*mKeySize + keyCell;
+    if (mBoundsTracking)
+    {
+      const double oldZ = cellValue(index);
+      z = storeCell(index, z);
+      trackCell(row, oldZ, z);
+    } else
+      z = storeCell(index, z);
     if (z < mDataBounds.lower)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    mModifiedCells |= QRect(keyCell, row, 1, 1);
+    ++mRevision;
   }
 }
 
@@ -299,17 +380,247 @@ void QCPColorMapData::setData(double key, double value, double z)
 */
 void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
 {
-  if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
+  if (mData && keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
   {
-    mData[valueIndex*mKeySize + keyIndex] = z;
+    const int row = physicalRow(valueIndex);
+    const int index = row*mKeySize + keyIndex;
+    if (mBoundsTracking)
+    {
+      const double oldZ = cellValue(index);
+      z = storeCell(index, z);
+      trackCell(row, oldZ, z);
+    } else
+      z = storeCell(index, z);
     if (z < mDataBounds.lower)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    mModifiedCells |= QRect(keyIndex, row, 1, 1);
+    ++mRevision;
+  }
+}
+
+/*!
+  Sets all cells with value index \a valueIndex to the values in \a data, which must hold \ref
+  keySize elements, with a distance of \a stride elements between consecutive key indices.
+  
+  This is equivalent to calling \ref setCell for each cell of the row, but the bounds check, the
+  update of the data bounds and the tracking of modified cells is done once for the whole row.
+  
+  \see setColumn, setBlock
+*/
+void QCPColorMapData::setRow(int valueIndex, const double *data, int stride)
+{
+  setBlockData(0, valueIndex, mKeySize, 1, data, ctDouble, stride, 0);
+}
+
+/*! \overload
+  
+  Sets a row from single precision \a data.
+*/
+void QCPColorMapData::setRow(int valueIndex, const float *data, int stride)
+{
+  setBlockData(0, valueIndex, mKeySize, 1, data, ctFloat, stride, 0);
+}
+
+/*! \overload
+  
+  Sets a row from unsigned 16 bit integer \a data.
+*/
+void QCPColorMapData::setRow(int valueIndex, const quint16 *data, int stride)
+{
+  setBlockData(0, valueIndex, mKeySize, 1, data, ctUInt16, stride, 0);
+}
+
+/*! \overload
+  
+  Sets a row from unsigned 8 bit integer \a data.
+*/
+void QCPColorMapData::setRow(int valueIndex, const quint8 *data, int stride)
+{
+  setBlockData(0, valueIndex, mKeySize, 1, data, ctUInt8, stride, 0);
+}
+
+/*!
+  Sets all cells with key index \a keyIndex to the values in \a data, which must hold \ref
+  valueSize elements, with a distance of \a stride elements between consecutive value indices.
+  
+  This is equivalent to calling \ref setCell for each cell of the column, but the bounds check,
+  the update of the data bounds and the tracking of modified cells is done once for the whole
+  column.
+  
+  \see setRow, setBlock
+*/
+void QCPColorMapData::setColumn(int keyIndex, const double *data, int stride)
+{
+  setBlockData(keyIndex, 0, 1, mValueSize, data, ctDouble, 1, stride);
+}
+
+/*! \overload
+  
+  Sets a column from single precision \a data.
+*/
+void QCPColorMapData::setColumn(int keyIndex, const float *data, int stride)
+{
+  setBlockData(keyIndex, 0, 1, mValueSize, data, ctFloat, 1, stride);
+}
+
+/*! \overload
+  
+  Sets a column from unsigned 16 bit integer \a data.
+*/
+void QCPColorMapData::setColumn(int keyIndex, const quint16 *data, int stride)
+{
+  setBlockData(keyIndex, 0, 1, mValueSize, data, ctUInt16, 1, stride);
+}
+
+/*! \overload
+  
+  Sets a column from unsigned 8 bit integer \a data.
+*/
+void QCPColorMapData::setColumn(int keyIndex, const quint8 *data, int stride)
+{
+  setBlockData(keyIndex, 0, 1, mValueSize, data, ctUInt8, 1, stride);
+}
+
+/*!
+  Sets the rectangular block of \a keyCount times \a valueCount cells, whose cell with the lowest
+  indices is at \a keyIndex and \a valueIndex, to the values in \a data.
+  
+  The value for the cell at <tt>(keyIndex+k, valueIndex+v)</tt> is taken from
+  <tt>data[v*valueStride + k*keyStride]</tt>. If \a valueStride is 0, the rows of the block are
+  expected to follow each other directly, i.e. \a valueStride is <tt>keyCount*keyStride</tt>. This
+  allows copying e.g. a sub image of a larger frame buffer, or transposed data.
+  
+  Parts of the block that lie outside the map are ignored. The values are converted to the cell
+  type of this instance (see \ref CellType). If \a data has the same type as the cells and is
+  contiguous in the key dimension, each row of the block is copied with a single memcpy.
+  
+  This is equivalent to calling \ref setCell for each cell of the block, but the bounds check, the
+  update of the data bounds and the tracking of modified cells is done once per row of the block.
+  
+  \see setRow, setColumn
+*/
+void QCPColorMapData::setBlock(int keyIndex, int valueIndex, int keyCount, int valueCount, const double *data, int keyStride, int valueStride)
+{
+  setBlockData(keyIndex, valueIndex, keyCount, valueCount, data, ctDouble, keyStride, valueStride);
+}
+
+/*! \overload
+  
+  Sets a block of cells from single precision \a data.
+*/
+void QCPColorMapData::setBlock(int keyIndex, int valueIndex, int keyCount, int valueCount, const float *data, int keyStride, int valueStride)
+{
+  setBlockData(keyIndex, valueIndex, keyCount, valueCount, data, ctFloat, keyStride, valueStride);
+}
+
+/*! \overload
+  
+  Sets a block of cells from unsigned 16 bit integer \a data.
+*/
+void QCPColorMapData::setBlock(int keyIndex, int valueIndex, int keyCount, int valueCount, const quint16 *data, int keyStride, int valueStride)
+{
+  setBlockData(keyIndex, valueIndex, keyCount, valueCount, data, ctUInt16, keyStride, valueStride);
+}
+
+/*! \overload
+  
+  Sets a block of cells from unsigned 8 bit integer \a data.
+*/
+void QCPColorMapData::setBlock(int keyIndex, int valueIndex, int keyCount, int valueCount, const quint8 *data, int keyStride, int valueStride)
+{
+  setBlockData(keyIndex, valueIndex, keyCount, valueCount, data, ctUInt8, keyStride, valueStride);
+}
+
+/*!
+  Sets whether the exact minimum and maximum of the data shall be tracked.
+  
+  By default, the data bounds returned by \ref dataBounds are only expanded when cells are set, and
+  \ref recalculateDataBounds must scan all cells to find the exact bounds after values decreased
+  (see the class description). With \a enabled set to true, the minimum and maximum of each row are
+  kept additionally. Setting a cell only marks its row for rescanning if the cell held an extreme
+  value of the row which is now moved inward. \ref dataBounds and \ref recalculateDataBounds then
+  only scan these rows and combine the row bounds, which makes e.g. \ref
+  QCPColorMap::rescaleDataRange or QCPColorScale::rescaleDataRange cheap for continuously updated
+  maps, where only few cells change between two replots.
+  
+  Tracking slightly increases the cost of \ref setCell and \ref setData, and needs two doubles of
+  memory per row.
+*/
+void QCPColorMapData::setBoundsTracking(bool enabled)
+{
+  if (mBoundsTracking == enabled)
+    return;
+  mBoundsTracking = enabled;
+  if (mBoundsTracking)
+  {
+    mRowMinimum.fill(0, mValueSize);
+    mRowMaximum.fill(0, mValueSize);
+    mDirtyRows.fill(true, mValueSize);
+    mBoundsOutdated = true;
+  } else
+  {
+    mRowMinimum.clear();
+    mRowMaximum.clear();
+    mDirtyRows.clear();
+    mBoundsOutdated = false;
   }
 }
 
+/*!
+  Scrolls the data by one row in the value dimension and sets the new top row to the \a row array,
+  which must hold \ref keySize values. All cells move down by one value index, the cells with value
+  index 0 are discarded and the cells with value index valueSize-1 are set to \a row.
+  
+  This is the typical operation of a waterfall display or spectrogram, where each new spectrum is
+  added as a row. The rows are kept in a ring internally, so adding a row only copies the values of
+  one row, instead of moving all data. Accordingly, the QCPColorMap only colorizes the new row at
+  the next replot, and composites its map image from the two parts of the ring.
+  
+  The data bounds are extended by the new values, like with \ref setCell.
+  
+  \see setCell
+*/
+void QCPColorMapData::addRow(const double *row)
+{
+  if (mIsEmpty || !mData)
+    return;
+  if (!row)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as row";
+    return;
+  }
+  
+  // the physical row of the current bottom row becomes the new top row:
+  const int newRow = mRowOffset;
+  mRowOffset = mRowOffset+1 < mValueSize ? mRowOffset+1 : 0;
+  const int target = newRow*mKeySize;
+  double rowMinimum = 0, rowMaximum = 0;
+  for (int i=0; i<mKeySize; ++i)
+  {
+    const double z = storeCell(target+i, row[i]);
+    if (z < mDataBounds.lower)
+      mDataBounds.lower = z;
+    if (z > mDataBounds.upper)
+      mDataBounds.upper = z;
+    if (i == 0 || z < rowMinimum)
+      rowMinimum = z;
+    if (i == 0 || z > rowMaximum)
+      rowMaximum = z;
+  }
+  if (mBoundsTracking)
+  {
+    // the bounds of the new row are known, but the discarded row might have held the extremes:
+    mRowMinimum[newRow] = rowMinimum;
+    mRowMaximum[newRow] = rowMaximum;
+    mDirtyRows[newRow] = false;
+    mBoundsOutdated = true;
+  }
+  mModifiedCells |= QRect(0, newRow, mKeySize, 1);
+  ++mRevision;
+}
+
 /*!
   Goes through the data and updates the buffered minimum and maximum data values.
   
@@ -322,20 +633,28 @@ void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
   Note that the method \ref QCPColorMap::rescaleDataRange provides a parameter \a
   recalculateDataBounds for convenience. Setting this to true will call this method for you, before
   doing the rescale.
+  
+  If bounds tracking is enabled (\ref setBoundsTracking), only the rows whose extreme values were
+  overwritten are scanned.
 */
 void QCPColorMapData::recalculateDataBounds()
 {
-  if (mKeySize > 0 && mValueSize > 0)
+  if (mBoundsTracking)
+  {
+    if (mBoundsOutdated)
+      updateTrackedBounds();
+  } else if (mKeySize > 0 && mValueSize > 0)
   {
-    double minHeight = mData[0];
-    double maxHeight = mData[0];
+    double minHeight = cellValue(0);
+    double maxHeight = minHeight;
     const int dataCount = mValueSize*mKeySize;
     for (int i=0; i<dataCount; ++i)
     {
-      if (mData[i] > maxHeight)
-        maxHeight = mData[i];
-      if (mData[i] < minHeight)
-        minHeight = mData[i];
+      const double z = cellValue(i);
+      if (z > maxHeight)
+        maxHeight = z;
+      if (z < minHeight)
+        minHeight = z;
     }
     mDataBounds.lower = minHeight;
     mDataBounds.upper = maxHeight;
@@ -358,9 +677,229 @@ void QCPColorMapData::clear()
 void QCPColorMapData::fill(double z)
 {
   const int dataCount = mValueSize*mKeySize;
-  for (int i=0; i<dataCount; ++i)
-    mData[i] = z;
+  if (dataCount > 0 && mData)
+  {
+    z = storeCell(0, z);
+    switch (mCellType)
+    {
+      case ctDouble: qFill(reinterpret_cast<double*>(mData), reinterpret_cast<double*>(mData)+dataCount, z); break;
+      case ctFloat: qFill(reinterpret_cast<float*>(mData), reinterpret_cast<float*>(mData)+dataCount, (float)z); break;
+      case ctUInt16: qFill(reinterpret_cast<quint16*>(mData), reinterpret_cast<quint16*>(mData)+dataCount, (quint16)z); break;
+      case ctUInt8: memset(mData, (quint8)z, dataCount); break;
+    }
+  }
   mDataBounds = QCPRange(z, z);
+  mDataModified = true;
+  ++mRevision;
+  if (mBoundsTracking)
+  {
+    mRowMinimum.fill(z, mValueSize);
+    mRowMaximum.fill(z, mValueSize);
+    mDirtyRows.fill(false, mValueSize);
+    mBoundsOutdated = false;
+  }
+}
+
+/*! \internal
+  
+  Converts \a z to the storage type and writes it to the cell at the linear \a index of the
+  internal data array. Returns the value that was actually stored, i.e. \a z after rounding and
+  clamping to the cell type.
+*/
+double QCPColorMapData::storeCell(int index, double z)
+{
+  switch (mCellType)
+  {
+    case ctDouble:
+    {
+      reinterpret_cast<double*>(mData)[index] = z;
+      return z;
+    }
+    case ctFloat:
+    {
+      const float stored = z;
+      reinterpret_cast<float*>(mData)[index] = stored;
+      return stored;
+    }
+    case ctUInt16:
+    {
+      const quint16 stored = qRound(qBound(0.0, z, 65535.0));
+      reinterpret_cast<quint16*>(mData)[index] = stored;
+      return stored;
+    }
+    case ctUInt8:
+    {
+      const quint8 stored = qRound(qBound(0.0, z, 255.0));
+      mData[index] = stored;
+      return stored;
+    }
+  }
+  return 0;
+}
+
+/*! \internal
+  
+  Returns the number of bytes one cell of type \a cellType occupies.
+*/
+int QCPColorMapData::cellTypeSize(CellType cellType)
+{
+  switch (cellType)
+  {
+    case ctDouble: return sizeof(double);
+    case ctFloat: return sizeof(float);
+    case ctUInt16: return sizeof(quint16);
+    case ctUInt8: return sizeof(quint8);
+  }
+  return sizeof(double);
+}
+
+/*! \internal
+  
+  Updates the row bounds used by bounds tracking (\ref setBoundsTracking), after a cell in the
+  physical \a row changed from \a oldZ to \a z. If the cell held the row minimum or maximum and
+  moved inward, the exact row bounds are unknown and the row is marked for rescanning.
+*/
+void QCPColorMapData::trackCell(int row, double oldZ, double z)
+{
+  if (mDirtyRows.at(row))
+    return;
+  if ((oldZ == mRowMinimum.at(row) && z > oldZ) || (oldZ == mRowMaximum.at(row) && z < oldZ))
+  {
+    mDirtyRows[row] = true;
+    mBoundsOutdated = true;
+  } else
+  {
+    if (z < mRowMinimum.at(row))
+      mRowMinimum[row] = z;
+    if (z > mRowMaximum.at(row))
+      mRowMaximum[row] = z;
+  }
+}
+
+/*! \internal
+  
+  Implements \ref setRow, \ref setColumn and \ref setBlock for source \a data with elements of
+  type \a dataType. See \ref setBlock for the meaning of the parameters.
+*/
+void QCPColorMapData::setBlockData(int keyIndex, int valueIndex, int keyCount, int valueCount, const void *data, CellType dataType, int keyStride, int valueStride)
+{
+  if (mIsEmpty || !mData)
+    return;
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (valueStride == 0)
+    valueStride = keyCount*keyStride;
+  
+  // clip the block to the map, skipping the corresponding source elements:
+  const int sourceElementSize = cellTypeSize(dataType);
+  const uchar *source = static_cast<const uchar*>(data);
+  if (keyIndex < 0)
+  {
+    source -= (ptrdiff_t)keyIndex*keyStride*sourceElementSize;
+    keyCount += keyIndex;
+    keyIndex = 0;
+  }
+  if (valueIndex < 0)
+  {
+    source -= (ptrdiff_t)valueIndex*valueStride*sourceElementSize;
+    valueCount += valueIndex;
+    valueIndex = 0;
+  }
+  keyCount = qMin(keyCount, mKeySize-keyIndex);
+  valueCount = qMin(valueCount, mValueSize-valueIndex);
+  if (keyCount <= 0 || valueCount <= 0)
+    return;
+  
+  const bool copyRows = dataType == mCellType && keyStride == 1;
+  const bool wholeRows = keyCount == mKeySize;
+  for (int v=0; v<valueCount; ++v)
+  {
+    const int row = physicalRow(valueIndex+v);
+    const int rowStart = row*mKeySize;
+    const uchar *sourceRow = source + (ptrdiff_t)v*valueStride*sourceElementSize;
+    if (copyRows)
+      memcpy(mData+(size_t)(rowStart+keyIndex)*sourceElementSize, sourceRow, (size_t)keyCount*sourceElementSize);
+    else
+    {
+      for (int k=0; k<keyCount; ++k)
+        storeCell(rowStart+keyIndex+k, sourceValue(sourceRow, dataType, k*keyStride));
+    }
+    
+    // bounds of the written part of the row, as stored:
+    double minimum = cellValue(rowStart+keyIndex);
+    double maximum = minimum;
+    for (int i=rowStart+keyIndex+1; i<rowStart+keyIndex+keyCount; ++i)
+    {
+      const double z = cellValue(i);
+      if (z < minimum)
+        minimum = z;
+      if (z > maximum)
+        maximum = z;
+    }
+    if (minimum < mDataBounds.lower)
+      mDataBounds.lower = minimum;
+    if (maximum > mDataBounds.upper)
+      mDataBounds.upper = maximum;
+    if (mBoundsTracking)
+    {
+      if (wholeRows)
+      {
+        mRowMinimum[row] = minimum;
+        mRowMaximum[row] = maximum;
+        mDirtyRows[row] = false;
+      } else
+        mDirtyRows[row] = true; // the overwritten cells might have held the extremes of the row
+      mBoundsOutdated = true;
+    }
+    mModifiedCells |= QRect(keyIndex, row, keyCount, 1);
+    ++mRevision;
+  }
+}
+
+/*! \internal
+  
+  Rescans the rows that are marked dirty by bounds tracking and combines the bounds of all rows to
+  the exact data bounds.
+  
+  \see setBoundsTracking
+*/
+void QCPColorMapData::updateTrackedBounds() const
+{
+  if (mKeySize > 0 && mValueSize > 0 && mData)
+  {
+    for (int row=0; row<mValueSize; ++row)
+    {
+      if (!mDirtyRows.at(row))
+        continue;
+      const int rowStart = row*mKeySize;
+      double minimum = cellValue(rowStart);
+      double maximum = minimum;
+      for (int i=rowStart+1; i<rowStart+mKeySize; ++i)
+      {
+        const double z = cellValue(i);
+        if (z < minimum)
+          minimum = z;
+        if (z > maximum)
+          maximum = z;
+      }
+      mRowMinimum[row] = minimum;
+      mRowMaximum[row] = maximum;
+      mDirtyRows[row] = false;
+    }
+    mDataBounds.lower = mRowMinimum.at(0);
+    mDataBounds.upper = mRowMaximum.at(0);
+    for (int row=1; row<mValueSize; ++row)
+    {
+      if (mRowMinimum.at(row) < mDataBounds.lower)
+        mDataBounds.lower = mRowMinimum.at(row);
+      if (mRowMaximum.at(row) > mDataBounds.upper)
+        mDataBounds.upper = mRowMaximum.at(row);
+    }
+  }
+  mBoundsOutdated = false;
 }
 
 /*!
@@ -406,6 +945,20 @@ void QCPColorMapData::cellToCoord(int keyIndex, int valueIndex, double *key, dou
 //////////////////// QCPColorMap
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/*! \internal
+  
+  Color maps with at least this number of cells are colorized on several threads of the global
+  QThreadPool in \ref QCPColorMap::updateMapImage. Smaller maps are colorized on the calling thread,
+  because distributing the work would cost more than it saves.
+*/
+static const int qcpParallelColorizeMinCells = 256*1024;
+
+/*! \internal
+  
+  The number of image lines a thread takes at a time when a color map is colorized concurrently.
+*/
+static const int qcpColorizeBlockLines = 16;
+
 /*! \class QCPColorMap
   \brief A plottable representing a two-dimensional color map in a plot.
 
@@ -527,7 +1080,11 @@ QCPColorMap::QCPColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mMapData(new QCPColorMapData(10, 10, QCPRange(0, 5), QCPRange(0, 5))),
   mInterpolate(true),
   mTightBoundary(false),
-  mMapImageInvalidated(true)
+  mViewportResampling(vrNone),
+  mMapImageInvalidated(true),
+  mResampledImageInvalidated(true),
+  mLogDataSign(1),
+  mLogDataInvalidated(true)
 {
 }
 
@@ -554,6 +1111,9 @@ void QCPColorMap::setData(QCPColorMapData *data, bool copy)
     mMapData = data;
   }
   mMapImageInvalidated = true;
+  mResampledImageInvalidated = true;
+  mLogDataInvalidated = true;
+  markLayerDirty();
 }
 
 /*!
@@ -574,6 +1134,8 @@ void QCPColorMap::setDataRange(const QCPRange &dataRange)
     else
       mDataRange = dataRange.sanitizedForLinScale();
     mMapImageInvalidated = true;
+    mResampledImageInvalidated = true;
+    markLayerDirty();
     emit dataRangeChanged(mDataRange);
   }
 }
@@ -581,6 +1143,12 @@ void QCPColorMap::setDataRange(const QCPRange &dataRange)
 /*!
   Sets whether the data is correlated with the color gradient linearly or logarithmically.
   
+  For logarithmic scaling of floating point cells, the color map keeps a copy of the logarithms of
+  the cell values, which is only updated for cells that changed. Recolorizing the map after a
+  change of the data range or gradient is then as cheap as with linear scaling. Integer cells don't
+  need this copy, since they are colorized through a lookup table (see \ref
+  QCPColorMapData::CellType).
+  
   \see QCPColorScale::setDataScaleType
 */
 void QCPColorMap::setDataScaleType(QCPAxis::ScaleType scaleType)
@@ -589,10 +1157,12 @@ void QCPColorMap::setDataScaleType(QCPAxis::ScaleType scaleType)
   {
     mDataScaleType = scaleType;
     mMapImageInvalidated = true;
+    mResampledImageInvalidated = true;
     emit dataScaleTypeChanged(mDataScaleType);
     if (mDataScaleType == QCPAxis::stLogarithmic)
       setDataRange(mDataRange.sanitizedForLogScale());
   }
+  markLayerDirty();
 }
 
 /*!
@@ -612,8 +1182,10 @@ void QCPColorMap::setGradient(const QCPColorGradient &gradient)
   {
     mGradient = gradient;
     mMapImageInvalidated = true;
+    mResampledImageInvalidated = true;
     emit gradientChanged(mGradient);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -625,6 +1197,7 @@ void QCPColorMap::setGradient(const QCPColorGradient &gradient)
 void QCPColorMap::setInterpolate(bool enabled)
 {
   mInterpolate = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -641,6 +1214,34 @@ void QCPColorMap::setInterpolate(bool enabled)
 void QCPColorMap::setTightBoundary(bool enabled)
 {
   mTightBoundary = enabled;
+  markLayerDirty();
+}
+
+/*!
+  Sets how the color map is drawn if it has more cells than the number of screen pixels it covers,
+  in the key or value dimension.
+  
+  With \ref vrNone (the default), the entire map is colorized at full data resolution and the
+  resulting image is scaled down by QPainter. For very large maps, this wastes time and memory on
+  cells that are either not visible or merged into a single pixel anyway.
+  
+  The other modes only colorize the part of the map that is visible inside the axis rect, with one
+  image pixel per screen pixel. Each pixel is colored by the minimum (\ref vrMinimum), maximum (\ref
+  vrMaximum) or mean (\ref vrMean) of the cells it covers. Minimum and maximum keep narrow peaks
+  visible that would otherwise disappear when scaling down. The resampled image is cached and only
+  recalculated when the axis ranges, the plot geometry, the data or the color settings change.
+  
+  If the map has fewer cells than pixels in both dimensions, it is drawn as with \ref vrNone.
+  Interpolation (\ref setInterpolate) has no effect on resampled images.
+*/
+void QCPColorMap::setViewportResampling(QCPColorMap::ViewportResampling resampling)
+{
+  if (mViewportResampling != resampling)
+  {
+    mViewportResampling = resampling;
+    mResampledImageInvalidated = true;
+  }
+  markLayerDirty();
 }
 
 /*!
@@ -681,6 +1282,7 @@ void QCPColorMap::setColorScale(QCPColorScale *colorScale)
     connect(mColorScale.data(), SIGNAL(gradientChanged(QCPColorGradient)), this, SLOT(setGradient(QCPColorGradient)));
     connect(mColorScale.data(), SIGNAL(dataScaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
   }
+  markLayerDirty();
 }
 
 /*!
@@ -699,7 +1301,8 @@ void QCPColorMap::setColorScale(QCPColorScale *colorScale)
   true minimum and maximum by explicitly looking at each cell, the method
   QCPColorMapData::recalculateDataBounds can be used. For convenience, setting the parameter \a
   recalculateDataBounds calls this method before setting the data range to the buffered minimum and
-  maximum.
+  maximum. If the data has bounds tracking enabled (\ref QCPColorMapData::setBoundsTracking), the
+  buffered bounds are always exact and the recalculation only needs to look at changed rows.
   
   \see setDataRange
 */
@@ -764,6 +1367,18 @@ double QCPColorMap::selectTest(const QPointF &pos, bool onlySelectable, QVariant
   return -1;
 }
 
+/*! \internal
+  
+  Appends the revision of the cell data and the coordinate ranges of the map data, so a buffered
+  layer is redrawn when cells or ranges were changed via the \ref data object.
+*/
+void QCPColorMap::appendBufferState(QVector<double> &state) const
+{
+  state << mMapData->mRevision << mMapData->keySize() << mMapData->valueSize();
+  state << mMapData->keyRange().lower << mMapData->keyRange().upper;
+  state << mMapData->valueRange().lower << mMapData->valueRange().upper;
+}
+
 /*! \internal
   
   Updates the internal map image buffer by going through the internal \ref QCPColorMapData and
@@ -772,6 +1387,9 @@ double QCPColorMap::selectTest(const QPointF &pos, bool onlySelectable, QVariant
   This method is called by \ref QCPColorMap::draw if either the data has been modified or the map image
   has been invalidated for a different reason (e.g. a change of the data range with \ref
   setDataRange).
+  
+  Large maps are colorized concurrently, by the calling thread together with idle threads of the
+  global QThreadPool (see \ref colorizeRegion).
 */
 void QCPColorMap::updateMapImage()
 {
@@ -784,32 +1402,382 @@ void QCPColorMap::updateMapImage()
   else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.size().width() != mMapData->valueSize() || mMapImage.size().height() != mMapData->keySize()))
     mMapImage = QImage(QSize(mMapData->valueSize(), mMapData->keySize()), QImage::Format_RGB32);
   
+  if (usesLogData())
+  {
+    if (mMapData->mDataModified)
+      mLogDataInvalidated = true;
+    updateLogData(mMapData->mModifiedCells);
+  } else if (mMapData->mDataModified || !mMapData->mModifiedCells.isEmpty())
+    mLogDataInvalidated = true;
+  
+  const bool keyHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  if (keyHorizontal)
+    colorizeRegion(keyHorizontal, 0, mMapData->valueSize(), 0, mMapData->keySize());
+  else
+    colorizeRegion(keyHorizontal, 0, mMapData->keySize(), 0, mMapData->valueSize());
+  
+  mMapData->mDataModified = false;
+  mMapData->mModifiedCells = QRect();
+  mMapImageInvalidated = false;
+}
+
+/*! \internal
+  
+  Recolorizes only the data cells within \a cells of the map image, where the x coordinate of
+  \a cells is the key index and the y coordinate is the physical row in the data array (which
+  differs from the value index after \ref QCPColorMapData::addRow). This is used by \ref draw
+  instead of \ref updateMapImage, when single cells were changed since the last update (see \ref
+  QCPColorMapData::setCell), but neither the data size nor the data range or gradient changed.
+  
+  If the map image doesn't match the data dimensions, a full \ref updateMapImage is performed
+  instead.
+*/
+void QCPColorMap::updateMapImageCells(const QRect &cells)
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis) return;
+  
+  const bool keyHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  const QSize imageSize = keyHorizontal ? QSize(mMapData->keySize(), mMapData->valueSize()) : QSize(mMapData->valueSize(), mMapData->keySize());
+  if (mMapImage.size() != imageSize)
+  {
+    updateMapImage();
+    return;
+  }
+  
+  const QRect validCells = cells & QRect(0, 0, mMapData->keySize(), mMapData->valueSize());
+  if (usesLogData())
+    updateLogData(validCells);
+  else
+    mLogDataInvalidated = true;
+  if (!validCells.isEmpty())
+  {
+    if (keyHorizontal)
+      colorizeRegion(keyHorizontal, validCells.top(), validCells.bottom()+1, validCells.left(), validCells.right()+1);
+    else
+      colorizeRegion(keyHorizontal, validCells.left(), validCells.right()+1, validCells.top(), validCells.bottom()+1);
+  }
+  mMapData->mModifiedCells = QRect();
+}
+
+/*! \internal
+  
+  Colorizes the image lines \a beginLine up to (excluding) \a endLine of \ref mMapImage, and in
+  each line the pixels \a beginRow up to (excluding) \a endRow. See \ref colorizeLines for the
+  meaning of lines and rows.
+  
+  Large regions are colorized concurrently, by the calling thread together with idle threads of the
+  global QThreadPool.
+*/
+void QCPColorMap::colorizeRegion(bool keyHorizontal, int beginLine, int endLine, int beginRow, int endRow)
+{
+  uchar *bits = mMapImage.bits(); // detaches the image once here, so the scanlines can be written from several threads
+  const int bytesPerLine = mMapImage.bytesPerLine();
+  const int lineCount = endLine-beginLine;
+  
+  const int maxThreads = QThreadPool::globalInstance()->maxThreadCount();
+  if (lineCount*(endRow-beginRow) < qcpParallelColorizeMinCells || maxThreads < 2 || lineCount < 2*qcpColorizeBlockLines)
+  {
+    colorizeLines(bits, bytesPerLine, keyHorizontal, beginLine, endLine, beginRow, endRow);
+  } else
+  {
+    // the first line is colorized before the threads start, this also brings the color buffer of
+    // mGradient up to date, so the threads only read from it:
+    colorizeLines(bits, bytesPerLine, keyHorizontal, beginLine, beginLine+1, beginRow, endRow);
+    QAtomicInt nextLine(beginLine+1);
+    QSemaphore finished;
+    int startedTasks = 0;
+    const int maxTasks = qMin(maxThreads, (lineCount-1)/qcpColorizeBlockLines)-1; // calling thread does work, too
+    for (int i=0; i<maxTasks; ++i)
+    {
+      QCPColorMapColorizeTask *task = new QCPColorMapColorizeTask(this, bits, bytesPerLine, keyHorizontal, endLine, beginRow, endRow, &nextLine, &finished);
+      if (QThreadPool::globalInstance()->tryStart(task))
+        ++startedTasks;
+      else
+      {
+        delete task;
+        break;
+      }
+    }
+    QCPColorMapColorizeTask::colorizeRemaining(this, bits, bytesPerLine, keyHorizontal, endLine, beginRow, endRow, &nextLine);
+    finished.acquire(startedTasks);
+  }
+}
+
+/*! \internal
+  
+  Colorizes the image lines \a beginLine up to (excluding) \a endLine of the map image, whose
+  pixel data starts at \a bits with \a bytesPerLine bytes per scanline. Within each line, only the
+  pixels \a beginRow up to (excluding) \a endRow are colorized. \a keyHorizontal specifies
+  whether the key axis is horizontal, i.e. whether an image line corresponds to a value index (and
+  a row to a key index) or the other way around.
+  
+  Lines are counted from the bottom, like the value index of \ref QCPColorMapData. Different line
+  intervals may be colorized concurrently, once the color buffer of \ref mGradient is up to date.
+  
+  \see colorizeRegion
+*/
+void QCPColorMap::colorizeLines(uchar *bits, int bytesPerLine, bool keyHorizontal, int beginLine, int endLine, int beginRow, int endRow)
+{
   const int keySize = mMapData->keySize();
   const int valueSize = mMapData->valueSize();
-  const double *rawData = mMapData->mData;
   
-  if (keyAxis->orientation() == Qt::Horizontal)
+  if (keyHorizontal)
   {
     const int lineCount = valueSize;
     const int rowCount = keySize;
-    for (int line=0; line<lineCount; ++line)
+    for (int line=beginLine; line<endLine; ++line)
     {
-      QRgb* pixels = reinterpret_cast<QRgb*>(mMapImage.scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-      mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
+      QRgb* pixels = reinterpret_cast<QRgb*>(bits+(lineCount-1-line)*bytesPerLine); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+      colorizeCells(line*rowCount+beginRow, pixels+beginRow, endRow-beginRow, 1);
     }
-  } else // keyAxis->orientation() == Qt::Vertical
+  } else // key axis is vertical
   {
     const int lineCount = keySize;
-    const int rowCount = valueSize;
-    for (int line=0; line<lineCount; ++line)
+    for (int line=beginLine; line<endLine; ++line)
     {
-      QRgb* pixels = reinterpret_cast<QRgb*>(mMapImage.scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-      mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
+      QRgb* pixels = reinterpret_cast<QRgb*>(bits+(lineCount-1-line)*bytesPerLine); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+      colorizeCells(line+beginRow*lineCount, pixels+beginRow, endRow-beginRow, lineCount);
     }
   }
+}
+
+/*! \internal
   
-  mMapData->mDataModified = false;
-  mMapImageInvalidated = false;
+  Colorizes \a n cells of the data array into \a scanLine, starting at the linear \a index and
+  advancing by \a dataIndexFactor cells (see \ref QCPColorGradient::colorize). The cells are passed
+  to the gradient in their storage type, so integer cells use the lookup table path of the
+  gradient.
+*/
+void QCPColorMap::colorizeCells(int index, QRgb *scanLine, int n, int dataIndexFactor)
+{
+  if (usesLogData())
+  {
+    // logarithms of the cells are cached, so they can be mapped linearly:
+    const QCPRange logRange(qLn(mDataRange.lower*mLogDataSign), qLn(mDataRange.upper*mLogDataSign));
+    mGradient.colorize(mLogData.constData()+index, logRange, scanLine, n, dataIndexFactor, false);
+    return;
+  }
+  const uchar *rawData = mMapData->mData;
+  const bool logarithmic = mDataScaleType == QCPAxis::stLogarithmic;
+  switch (mMapData->mCellType)
+  {
+    case QCPColorMapData::ctDouble: mGradient.colorize(reinterpret_cast<const double*>(rawData)+index, mDataRange, scanLine, n, dataIndexFactor, logarithmic); break;
+    case QCPColorMapData::ctFloat: mGradient.colorize(reinterpret_cast<const float*>(rawData)+index, mDataRange, scanLine, n, dataIndexFactor, logarithmic); break;
+    case QCPColorMapData::ctUInt16: mGradient.colorize(reinterpret_cast<const quint16*>(rawData)+index, mDataRange, scanLine, n, dataIndexFactor, logarithmic); break;
+    case QCPColorMapData::ctUInt8: mGradient.colorize(rawData+index, mDataRange, scanLine, n, dataIndexFactor, logarithmic); break;
+  }
+}
+
+/*! \internal
+  
+  Returns whether the map is colorized from the cached logarithms of the cells (\ref mLogData),
+  which is the case for logarithmic data scaling of floating point cells.
+  
+  \see updateLogData
+*/
+bool QCPColorMap::usesLogData() const
+{
+  return mDataScaleType == QCPAxis::stLogarithmic &&
+      (mMapData->mCellType == QCPColorMapData::ctDouble || mMapData->mCellType == QCPColorMapData::ctFloat);
+}
+
+/*! \internal
+  
+  Updates the cached logarithms of the cell values within \a cells, where the x coordinate of \a
+  cells is the key index and the y coordinate is the physical row in the data array. If the cache
+  is invalid, doesn't match the data size, or the sign of the data range changed, all cells are
+  updated.
+  
+  The cache holds <tt>ln(z*sign)</tt>, where sign is the sign of the data range. A logarithmic
+  mapping of z to the data range is then a linear mapping of the cached value to the logarithms of
+  the range boundaries. Like with the direct calculation, cells with a sign opposite to the data
+  range become NaN and cells of value zero become negative infinity.
+*/
+void QCPColorMap::updateLogData(const QRect &cells)
+{
+  const int keySize = mMapData->keySize();
+  const int valueSize = mMapData->valueSize();
+  const int sign = mDataRange.lower < 0 ? -1 : 1;
+  QRect region = cells & QRect(0, 0, keySize, valueSize);
+  if (mLogDataInvalidated || mLogData.size() != keySize*valueSize || mLogDataSign != sign)
+  {
+    mLogData.resize(keySize*valueSize);
+    mLogDataSign = sign;
+    region = QRect(0, 0, keySize, valueSize);
+  }
+  if (!region.isEmpty() && mMapData->mData)
+  {
+    double *logData = mLogData.data();
+    for (int row=region.top(); row<=region.bottom(); ++row)
+    {
+      const int rowStart = row*keySize;
+      for (int i=rowStart+region.left(); i<=rowStart+region.right(); ++i)
+        logData[i] = qLn(mMapData->cellValue(i)*sign);
+    }
+  }
+  mLogDataInvalidated = false;
+}
+
+/*! \internal
+  
+  Draws the map image into \a imageRect, if the rows of the data are rotated in their ring due to
+  \ref QCPColorMapData::addRow. The map image is colorized in the physical row order of the data,
+  so it is drawn in two parts, such that the row with value index 0 appears at the bottom (or left)
+  of the map. Mirroring due to range-reversed axes is expected to be applied by the painter
+  transform.
+*/
+void QCPColorMap::drawRingImage(QCPPainter *painter, const QRectF &imageRect)
+{
+  const int offset = mMapData->mRowOffset;
+  if (keyAxis()->orientation() == Qt::Horizontal)
+  {
+    // rows of the data are image scanlines, with the physical row 0 at the bottom of the image:
+    const int n = mMapImage.height();
+    const int shift = n-offset; // displayed image line i shows image scanline (i+shift)%n
+    const double split = imageRect.height()*(n-shift)/(double)n;
+    painter->drawImage(QRectF(imageRect.left(), imageRect.top(), imageRect.width(), split), mMapImage, QRectF(0, shift, mMapImage.width(), n-shift));
+    painter->drawImage(QRectF(imageRect.left(), imageRect.top()+split, imageRect.width(), imageRect.height()-split), mMapImage, QRectF(0, 0, mMapImage.width(), shift));
+  } else
+  {
+    // rows of the data are image columns, with the physical row 0 at the left of the image:
+    const int n = mMapImage.width();
+    const int shift = offset; // displayed image column i shows image column (i+shift)%n
+    const double split = imageRect.width()*(n-shift)/(double)n;
+    painter->drawImage(QRectF(imageRect.left(), imageRect.top(), split, imageRect.height()), mMapImage, QRectF(shift, 0, n-shift, mMapImage.height()));
+    painter->drawImage(QRectF(imageRect.left()+split, imageRect.top(), imageRect.width()-split, imageRect.height()), mMapImage, QRectF(0, 0, shift, mMapImage.height()));
+  }
+}
+
+/*! \internal
+  
+  Draws the map with viewport resampling (see \ref setViewportResampling). \a imageRect is the
+  pixel rect the entire map would cover. Only its intersection with the axis rect is drawn, from
+  the cached \ref mResampledImage, which is recalculated with \ref updateResampledImage if the
+  axes, the geometry, the data or the color settings changed since it was created.
+*/
+void QCPColorMap::drawResampled(QCPPainter *painter, const QRectF &imageRect)
+{
+  const QRectF targetRect = imageRect & QRectF(mKeyAxis.data()->axisRect()->rect());
+  if (targetRect.isEmpty())
+    return;
+  const QSize targetSize(qMax(1, qRound(targetRect.width())), qMax(1, qRound(targetRect.height())));
+  
+  // changes of the data are consumed here. The full map image must then be rebuilt as soon as
+  // the map isn't resampled anymore:
+  if (mMapData->mDataModified || !mMapData->mModifiedCells.isEmpty())
+  {
+    mMapData->mDataModified = false;
+    mMapData->mModifiedCells = QRect();
+    mMapImageInvalidated = true;
+    mResampledImageInvalidated = true;
+    mLogDataInvalidated = true;
+  }
+  
+  QVector<double> state;
+  state << targetRect.left() << targetRect.top() << targetRect.width() << targetRect.height();
+  state << mKeyAxis.data()->range().lower << mKeyAxis.data()->range().upper << mKeyAxis.data()->rangeReversed() << mKeyAxis.data()->scaleType() << mKeyAxis.data()->orientation();
+  state << mValueAxis.data()->range().lower << mValueAxis.data()->range().upper << mValueAxis.data()->rangeReversed() << mValueAxis.data()->scaleType();
+  if (mResampledImageInvalidated || state != mResampledImageState || mResampledImage.size() != targetSize)
+  {
+    updateResampledImage(targetRect, targetSize);
+    mResampledImageState = state;
+    mResampledImageInvalidated = false;
+  }
+  painter->drawImage(targetRect, mResampledImage);
+}
+
+/*! \internal
+  
+  Colorizes the part of the map that lies in \a targetRect (in pixels) into \ref mResampledImage,
+  which gets the size \a targetSize. Each image pixel is colored according to the minimum, maximum
+  or mean of the data cells it covers, depending on \ref setViewportResampling.
+  
+  The image is created in screen orientation, so it doesn't need to be mirrored for range-reversed
+  axes, and rotated rows of the data (\ref QCPColorMapData::addRow) are taken into account.
+*/
+void QCPColorMap::updateResampledImage(const QRectF &targetRect, const QSize &targetSize)
+{
+  const bool keyHorizontal = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  const int keySize = mMapData->keySize();
+  const int valueSize = mMapData->valueSize();
+  const int width = targetSize.width();
+  const int height = targetSize.height();
+  
+  // determine which cells each image column and line covers:
+  QVector<int> columnBegin, columnEnd, lineBegin, lineEnd;
+  if (keyHorizontal)
+  {
+    resamplingIntervals(mKeyAxis.data(), targetRect.left(), targetRect.width(), width, mMapData->keyRange(), keySize, columnBegin, columnEnd);
+    resamplingIntervals(mValueAxis.data(), targetRect.top(), targetRect.height(), height, mMapData->valueRange(), valueSize, lineBegin, lineEnd);
+  } else
+  {
+    resamplingIntervals(mValueAxis.data(), targetRect.left(), targetRect.width(), width, mMapData->valueRange(), valueSize, columnBegin, columnEnd);
+    resamplingIntervals(mKeyAxis.data(), targetRect.top(), targetRect.height(), height, mMapData->keyRange(), keySize, lineBegin, lineEnd);
+  }
+  
+  if (mResampledImage.size() != targetSize)
+    mResampledImage = QImage(targetSize, QImage::Format_RGB32);
+  QVector<double> lineValues(width);
+  for (int y=0; y<height; ++y)
+  {
+    for (int x=0; x<width; ++x)
+    {
+      const int keyBegin = keyHorizontal ? columnBegin.at(x) : lineBegin.at(y);
+      const int keyEnd = keyHorizontal ? columnEnd.at(x) : lineEnd.at(y);
+      const int valueBegin = keyHorizontal ? lineBegin.at(y) : columnBegin.at(x);
+      const int valueEnd = keyHorizontal ? lineEnd.at(y) : columnEnd.at(x);
+      double result = mMapData->cellValue(mMapData->physicalRow(valueBegin)*keySize + keyBegin);
+      double sum = 0;
+      for (int value=valueBegin; value<valueEnd; ++value)
+      {
+        const int rowIndex = mMapData->physicalRow(value)*keySize;
+        for (int key=keyBegin; key<keyEnd; ++key)
+        {
+          const double z = mMapData->cellValue(rowIndex+key);
+          switch (mViewportResampling)
+          {
+            case vrMinimum: if (z < result) result = z; break;
+            case vrMaximum: if (z > result) result = z; break;
+            default: sum += z; break;
+          }
+        }
+      }
+      if (mViewportResampling == vrMean)
+        result = sum/(double)((keyEnd-keyBegin)*(valueEnd-valueBegin));
+      lineValues[x] = result;
+    }
+    mGradient.colorize(lineValues.constData(), mDataRange, reinterpret_cast<QRgb*>(mResampledImage.scanLine(y)), width, 1, mDataScaleType==QCPAxis::stLogarithmic);
+  }
+}
+
+/*! \internal
+  
+  Calculates which cells each of \a pixelCount pixels covers, for the data dimension that is
+  displayed along \a axis. The pixels start at the pixel coordinate \a pixelStart and span \a
+  pixelLength in total. The cells are given by \a cellCount and the coordinate range \a cellRange
+  of the cell centers.
+  
+  The cell index interval of pixel i is returned as <tt>[begin[i], end[i])</tt>. The intervals of
+  neighbouring pixels don't overlap, and each pixel covers at least one cell.
+*/
+void QCPColorMap::resamplingIntervals(QCPAxis *axis, double pixelStart, double pixelLength, int pixelCount, const QCPRange &cellRange, int cellCount, QVector<int> &begin, QVector<int> &end)
+{
+  begin.resize(pixelCount);
+  end.resize(pixelCount);
+  const double cellFactor = cellCount > 1 ? (cellCount-1)/(cellRange.upper-cellRange.lower) : 0;
+  double lastEdge = (axis->pixelToCoord(pixelStart)-cellRange.lower)*cellFactor+0.5; // edges in units of cells, where cell j spans [j, j+1)
+  for (int i=0; i<pixelCount; ++i)
+  {
+    const double edge = (axis->pixelToCoord(pixelStart+pixelLength*(i+1)/(double)pixelCount)-cellRange.lower)*cellFactor+0.5;
+    int cellBegin = qFloor(qMin(lastEdge, edge));
+    int cellEnd = qFloor(qMax(lastEdge, edge));
+    cellBegin = qBound(0, cellBegin, cellCount-1);
+    cellEnd = qBound(cellBegin+1, cellEnd, cellCount);
+    begin[i] = cellBegin;
+    end[i] = cellEnd;
+    lastEdge = edge;
+  }
 }
 
 /* inherits documentation from base class */
@@ -819,9 +1787,6 @@ void QCPColorMap::draw(QCPPainter *painter)
   if (!mKeyAxis || !mValueAxis) return;
   applyDefaultAntialiasingHint(painter);
   
-  if (mMapData->mDataModified || mMapImageInvalidated)
-    updateMapImage();
-  
   double halfSampleKey = 0;
   double halfSampleValue = 0;
   if (mMapData->keySize() > 1)
@@ -831,8 +1796,9 @@ void QCPColorMap::draw(QCPPainter *painter)
   QRectF imageRect(coordsToPixels(mMapData->keyRange().lower-halfSampleKey, mMapData->valueRange().lower-halfSampleValue),
                    coordsToPixels(mMapData->keyRange().upper+halfSampleKey, mMapData->valueRange().upper+halfSampleValue));
   imageRect = imageRect.normalized();
-  bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
-  bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
+  bool keyHorizontal = keyAxis()->orientation() == Qt::Horizontal;
+  bool mirrorX = (keyHorizontal ? keyAxis() : valueAxis())->rangeReversed();
+  bool mirrorY = (keyHorizontal ? valueAxis() : keyAxis())->rangeReversed();
   bool smoothBackup = painter->renderHints().testFlag(QPainter::SmoothPixmapTransform);
   painter->setRenderHint(QPainter::SmoothPixmapTransform, mInterpolate);
   QRegion clipBackup;
@@ -842,7 +1808,34 @@ void QCPColorMap::draw(QCPPainter *painter)
     painter->setClipRect(QRectF(coordsToPixels(mMapData->keyRange().lower, mMapData->valueRange().lower),
                                 coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized(), Qt::IntersectClip);
   }
-  painter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
+  
+  const int horizontalCells = keyHorizontal ? mMapData->keySize() : mMapData->valueSize();
+  const int verticalCells = keyHorizontal ? mMapData->valueSize() : mMapData->keySize();
+  if (mViewportResampling != vrNone && (horizontalCells > imageRect.width() || verticalCells > imageRect.height()))
+  {
+    drawResampled(painter, imageRect);
+  } else
+  {
+    if (mMapData->mDataModified || mMapImageInvalidated)
+      updateMapImage();
+    else if (!mMapData->mModifiedCells.isEmpty())
+      updateMapImageCells(mMapData->mModifiedCells);
+    
+    // mirror with the painter transform instead of creating a mirrored copy of the map image:
+    QTransform transformBackup = painter->transform();
+    if (mirrorX || mirrorY)
+    {
+      painter->translate(imageRect.center());
+      painter->scale(mirrorX ? -1 : 1, mirrorY ? -1 : 1);
+      painter->translate(-imageRect.center());
+    }
+    if (mMapData->mRowOffset == 0)
+      painter->drawImage(imageRect, mMapImage);
+    else
+      drawRingImage(painter, imageRect);
+    painter->setTransform(transformBackup);
+  }
+  
   if (mTightBoundary)
     painter->setClipRegion(clipBackup);
   painter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
@@ -912,3 +1905,62 @@ QCPRange QCPColorMap::getValueRange(bool &foundRange, SignDomain inSignDomain) c
   return result;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorMapColorizeTask
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorMapColorizeTask
+
+  \internal
+  \brief (Private)
+  
+  This is a private class and not part of the public QCustomPlot interface.
+  
+  It is used by QCPColorMap::updateMapImage to colorize blocks of image lines of large color maps
+  on a worker thread of the global QThreadPool. All tasks of one update share an atomic line index,
+  so each task keeps taking the next block of lines until the image is complete.
+*/
+
+/*!
+  Creates a task that colorizes the pixels \a beginRow to \a endRow of lines of the map image of
+  \a colorMap, whose pixel data starts at \a bits. The lines are taken from \a nextLine until \a
+  endLine is reached. When done, the task
+  releases one resource of \a finished.
+*/
+QCPColorMapColorizeTask::QCPColorMapColorizeTask(QCPColorMap *colorMap, uchar *bits, int bytesPerLine, bool keyHorizontal, int endLine, int beginRow, int endRow, QAtomicInt *nextLine, QSemaphore *finished) :
+  mColorMap(colorMap),
+  mBits(bits),
+  mBytesPerLine(bytesPerLine),
+  mKeyHorizontal(keyHorizontal),
+  mEndLine(endLine),
+  mBeginRow(beginRow),
+  mEndRow(endRow),
+  mNextLine(nextLine),
+  mFinished(finished)
+{
+}
+
+/*!
+  Colorizes lines until all are taken, then signals that this task is finished.
+*/
+void QCPColorMapColorizeTask::run()
+{
+  colorizeRemaining(mColorMap, mBits, mBytesPerLine, mKeyHorizontal, mEndLine, mBeginRow, mEndRow, mNextLine);
+  mFinished->release();
+}
+
+/*!
+  Colorizes blocks of lines of the map image of \a colorMap, each time taking the next block from
+  \a nextLine, until \a endLine is reached. May be called from several threads with the same
+  arguments, each line is then colorized by exactly one of them.
+*/
+void QCPColorMapColorizeTask::colorizeRemaining(QCPColorMap *colorMap, uchar *bits, int bytesPerLine, bool keyHorizontal, int endLine, int beginRow, int endRow, QAtomicInt *nextLine)
+{
+  int line = nextLine->fetchAndAddOrdered(qcpColorizeBlockLines);
+  while (line < endLine)
+  {
+    colorMap->colorizeLines(bits, bytesPerLine, keyHorizontal, line, qMin(line+qcpColorizeBlockLines, endLine), beginRow, endRow);
+    line = nextLine->fetchAndAddOrdered(qcpColorizeBlockLines);
+  }
+}
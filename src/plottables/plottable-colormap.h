@@ -39,7 +39,19 @@ class QCPColorMap;
 class QCP_LIB_DECL QCPColorMapData
 {
 public:
-  QCPColorMapData(int keySize, int valueSize, const QCPRange &keyRange, const QCPRange &valueRange);
+  /*!
+    Defines the data type in which the cells are stored. It is chosen at construction and determines
+    the memory footprint of the map.
+    
+    \see QCPColorMapData::QCPColorMapData
+  */
+  enum CellType { ctDouble  ///< Cells are stored as 64 bit floating point values (the default)
+                  ,ctFloat  ///< Cells are stored as 32 bit floating point values
+                  ,ctUInt16 ///< Cells are stored as unsigned 16 bit integers, values are rounded and clamped to [0, 65535]
+                  ,ctUInt8  ///< Cells are stored as unsigned 8 bit integers, values are rounded and clamped to [0, 255]
+                };
+  
+  QCPColorMapData(int keySize, int valueSize, const QCPRange &keyRange, const QCPRange &valueRange, CellType cellType=ctDouble);
   ~QCPColorMapData();
   QCPColorMapData(const QCPColorMapData &other);
   QCPColorMapData &operator=(const QCPColorMapData &other);
@@ -49,7 +61,9 @@ public:
   int valueSize() const { return mValueSize; }
   QCPRange keyRange() const { return mKeyRange; }
   QCPRange valueRange() const { return mValueRange; }
-  QCPRange dataBounds() const { return mDataBounds; }
+  QCPRange dataBounds() const;
+  CellType cellType() const { return mCellType; }
+  bool boundsTracking() const { return mBoundsTracking; }
   double data(double key, double value);
   double cell(int keyIndex, int valueIndex);
   
@@ -62,8 +76,22 @@ public:
   void setValueRange(const QCPRange &valueRange);
   void setData(double key, double value, double z);
   void setCell(int keyIndex, int valueIndex, double z);
+  void setBoundsTracking(bool enabled);
   
   // non-property methods:
+  void setRow(int valueIndex, const double *data, int stride=1);
+  void setRow(int valueIndex, const float *data, int stride=1);
+  void setRow(int valueIndex, const quint16 *data, int stride=1);
+  void setRow(int valueIndex, const quint8 *data, int stride=1);
+  void setColumn(int keyIndex, const double *data, int stride=1);
+  void setColumn(int keyIndex, const float *data, int stride=1);
+  void setColumn(int keyIndex, const quint16 *data, int stride=1);
+  void setColumn(int keyIndex, const quint8 *data, int stride=1);
+  void setBlock(int keyIndex, int valueIndex, int keyCount, int valueCount, const double *data, int keyStride=1, int valueStride=0);
+  void setBlock(int keyIndex, int valueIndex, int keyCount, int valueCount, const float *data, int keyStride=1, int valueStride=0);
+  void setBlock(int keyIndex, int valueIndex, int keyCount, int valueCount, const quint16 *data, int keyStride=1, int valueStride=0);
+  void setBlock(int keyIndex, int valueIndex, int keyCount, int valueCount, const quint8 *data, int keyStride=1, int valueStride=0);
+  void addRow(const double *row);
   void recalculateDataBounds();
   void clear();
   void fill(double z);
@@ -76,14 +104,66 @@ protected:
   int mKeySize, mValueSize;
   QCPRange mKeyRange, mValueRange;
   bool mIsEmpty;
+  CellType mCellType;
+  bool mBoundsTracking;
   // non-property members:
-  double *mData;
-  QCPRange mDataBounds;
+  uchar *mData;
+  mutable QCPRange mDataBounds;
+  mutable QVector<double> mRowMinimum, mRowMaximum;
+  mutable QVector<bool> mDirtyRows;
+  mutable bool mBoundsOutdated;
   bool mDataModified;
+  QRect mModifiedCells;
+  quint64 mRevision;
+  int mRowOffset;
+  
+  // non-virtual methods:
+  int physicalRow(int valueIndex) const { return valueIndex+mRowOffset < mValueSize ? valueIndex+mRowOffset : valueIndex+mRowOffset-mValueSize; }
+  double cellValue(int index) const;
+  double storeCell(int index, double z);
+  static int cellTypeSize(CellType cellType);
+  void trackCell(int row, double oldZ, double z);
+  void setBlockData(int keyIndex, int valueIndex, int keyCount, int valueCount, const void *data, CellType dataType, int keyStride, int valueStride);
+  static double sourceValue(const void *data, CellType dataType, int index);
+  void updateTrackedBounds() const;
   
   friend class QCPColorMap;
 };
 
+/*! \internal
+  
+  Returns the value of the cell at the linear \a index of the internal data array (i.e. physical
+  row times key size plus key index), converted from the storage type to double.
+*/
+inline double QCPColorMapData::cellValue(int index) const
+{
+  switch (mCellType)
+  {
+    case ctDouble: return reinterpret_cast<const double*>(mData)[index];
+    case ctFloat: return reinterpret_cast<const float*>(mData)[index];
+    case ctUInt16: return reinterpret_cast<const quint16*>(mData)[index];
+    case ctUInt8: return mData[index];
+  }
+  return 0;
+}
+
+/*! \internal
+  
+  Returns the element at \a index of the array \a data, whose elements are of type \a dataType,
+  converted to double.
+*/
+inline double QCPColorMapData::sourceValue(const void *data, CellType dataType, int index)
+{
+  switch (dataType)
+  {
+    case ctDouble: return static_cast<const double*>(data)[index];
+    case ctFloat: return static_cast<const float*>(data)[index];
+    case ctUInt16: return static_cast<const quint16*>(data)[index];
+    case ctUInt8: return static_cast<const quint8*>(data)[index];
+  }
+  return 0;
+}
+
 
 class QCP_LIB_DECL QCPColorMap : public QCPAbstractPlottable
 {
@@ -95,8 +175,22 @@ class QCP_LIB_DECL QCPColorMap : public QCPAbstractPlottable
   Q_PROPERTY(bool interpolate READ interpolate WRITE setInterpolate)
   Q_PROPERTY(bool tightBoundary READ tightBoundary WRITE setTightBoundary)
   Q_PROPERTY(QCPColorScale* colorScale READ colorScale WRITE setColorScale)
+  Q_PROPERTY(ViewportResampling viewportResampling READ viewportResampling WRITE setViewportResampling)
   /// \endcond
 public:
+  /*!
+    Defines how a color map that has more cells than screen pixels is reduced to the resolution of
+    the viewport.
+    
+    \see setViewportResampling
+  */
+  enum ViewportResampling { vrNone     ///< The whole map is colorized at data resolution and scaled down when drawn
+                            ,vrMinimum ///< Only the visible part of the map is colorized at screen resolution, each pixel shows the minimum of the cells it covers
+                            ,vrMaximum ///< Only the visible part of the map is colorized at screen resolution, each pixel shows the maximum of the cells it covers
+                            ,vrMean    ///< Only the visible part of the map is colorized at screen resolution, each pixel shows the mean of the cells it covers
+                          };
+  Q_ENUMS(ViewportResampling)
+  
   explicit QCPColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis);
   virtual ~QCPColorMap();
   
@@ -108,6 +202,7 @@ public:
   bool tightBoundary() const { return mTightBoundary; }
   QCPColorGradient gradient() const { return mGradient; }
   QCPColorScale *colorScale() const { return mColorScale.data(); }
+  ViewportResampling viewportResampling() const { return mViewportResampling; }
   
   // setters:
   void setData(QCPColorMapData *data, bool copy=false);
@@ -117,6 +212,7 @@ public:
   void setInterpolate(bool enabled);
   void setTightBoundary(bool enabled);
   void setColorScale(QCPColorScale *colorScale);
+  void setViewportResampling(ViewportResampling resampling);
   
   // non-property methods:
   void rescaleDataRange(bool recalculateDataBounds=false);
@@ -140,22 +236,62 @@ protected:
   bool mInterpolate;
   bool mTightBoundary;
   QPointer<QCPColorScale> mColorScale;
+  ViewportResampling mViewportResampling;
   // non-property members:
   QImage mMapImage;
   QPixmap mLegendIcon;
   bool mMapImageInvalidated;
+  QImage mResampledImage;
+  QVector<double> mResampledImageState;
+  bool mResampledImageInvalidated;
+  QVector<double> mLogData;
+  int mLogDataSign;
+  bool mLogDataInvalidated;
   
   // introduced virtual methods:
   virtual void updateMapImage();
   
+  // non-virtual methods:
+  void updateMapImageCells(const QRect &cells);
+  void drawRingImage(QCPPainter *painter, const QRectF &imageRect);
+  void drawResampled(QCPPainter *painter, const QRectF &imageRect);
+  void updateResampledImage(const QRectF &targetRect, const QSize &targetSize);
+  static void resamplingIntervals(QCPAxis *axis, double pixelStart, double pixelLength, int pixelCount, const QCPRange &cellRange, int cellCount, QVector<int> &begin, QVector<int> &end);
+  void colorizeRegion(bool keyHorizontal, int beginLine, int endLine, int beginRow, int endRow);
+  void colorizeLines(uchar *bits, int bytesPerLine, bool keyHorizontal, int beginLine, int endLine, int beginRow, int endRow);
+  void colorizeCells(int index, QRgb *scanLine, int n, int dataIndexFactor);
+  bool usesLogData() const;
+  void updateLogData(const QRect &cells);
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
   virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
+  virtual void appendBufferState(QVector<double> &state) const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
+  friend class QCPColorMapColorizeTask;
+};
+
+
+class QCPColorMapColorizeTask : public QRunnable
+{
+public:
+  QCPColorMapColorizeTask(QCPColorMap *colorMap, uchar *bits, int bytesPerLine, bool keyHorizontal, int endLine, int beginRow, int endRow, QAtomicInt *nextLine, QSemaphore *finished);
+  
+  virtual void run();
+  static void colorizeRemaining(QCPColorMap *colorMap, uchar *bits, int bytesPerLine, bool keyHorizontal, int endLine, int beginRow, int endRow, QAtomicInt *nextLine);
+  
+protected:
+  QCPColorMap *mColorMap;
+  uchar *mBits;
+  int mBytesPerLine;
+  bool mKeyHorizontal;
+  int mEndLine, mBeginRow, mEndRow;
+  QAtomicInt *mNextLine;
+  QSemaphore *mFinished;
 };
 
 #endif // QCP_PLOTTABLE_COLORMAP_H
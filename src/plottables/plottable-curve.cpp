@@ -37,14 +37,14 @@
 /*! \class QCPCurveData
   \brief Holds the data of one single data point for QCPCurve.
   
-  The container for storing multiple data points is \ref QCPCurveDataMap.
+  The container for storing multiple data points is \ref QCPCurveDataContainer.
   
   The stored data is:
   \li \a t: the free parameter of the curve at this curve point (cp. the mathematical vector <em>(x(t), y(t))</em>)
   \li \a key: coordinate on the key axis of this curve point
   \li \a value: coordinate on the value axis of this curve point
   
-  \see QCPCurveDataMap
+  \see QCPCurveDataContainer
 */
 
 /*!
@@ -68,6 +68,501 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCurveDataContainer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCurveDataContainer
+  \brief Holds the data points of a QCPCurve, sorted by the curve parameter t.
+  
+  Like \ref QCPDataContainer for QCPGraph, the curve parameters, keys and values are stored in
+  separate contiguous arrays (columns), sorted ascending by t. Data points with equal t are
+  allowed and keep the order in which they were added.
+  
+  Adding data points whose t is equal to or larger than the t of the current last data point (the
+  typical case when data is streamed in) is an amortized O(1) append. Removing data points from
+  the beginning (\ref removeBefore) doesn't move the remaining points in memory, the freed space
+  is reclaimed in one go once it makes up half of the storage. With \ref setCapacity, the
+  container additionally drops its oldest points automatically and keeps its memory preallocated,
+  so a curve of streamed data, e.g. the trajectory of the last N positions, is updated without any
+  reallocations.
+  
+  Every modification increments the \ref revision of the container.
+  
+  The data points are accessed by index via \ref at, \ref t, \ref key and \ref value, where index
+  0 is the data point with the smallest t.
+  
+  \see QCPCurve::data
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn int QCPCurveDataContainer::size() const
+  
+  Returns the number of data points in the container.
+*/
+
+/*! \fn bool QCPCurveDataContainer::isEmpty() const
+  
+  Returns whether the container holds no data points.
+*/
+
+/*! \fn quint64 QCPCurveDataContainer::revision() const
+  
+  Returns the revision number of the data. It is incremented whenever the container is modified.
+*/
+
+/*! \fn int QCPCurveDataContainer::capacity() const
+  
+  Returns the maximum number of data points the container holds, or zero if it is unbounded.
+  
+  \see setCapacity
+*/
+
+/*! \fn QCPCurveData QCPCurveDataContainer::at(int index) const
+  
+  Returns the data point at \a index. The index must be in the range 0 to \ref size-1.
+*/
+
+/*! \fn double QCPCurveDataContainer::t(int index) const
+  
+  Returns the curve parameter of the data point at \a index. The index must be in the range 0 to
+  \ref size-1.
+  
+  \see at, key, value
+*/
+
+/*! \fn double QCPCurveDataContainer::key(int index) const
+  
+  Returns the key of the data point at \a index. The index must be in the range 0 to \ref size-1.
+  
+  \see at, t, value
+*/
+
+/*! \fn double QCPCurveDataContainer::value(int index) const
+  
+  Returns the value of the data point at \a index. The index must be in the range 0 to \ref
+  size-1.
+  
+  \see at, t, key
+*/
+
+/*! \fn const double *QCPCurveDataContainer::tData() const
+  
+  Returns a pointer to the contiguous array of the \ref size curve parameters, sorted ascending.
+  The pointer becomes invalid when the container is modified.
+  
+  \see keyData, valueData
+*/
+
+/*! \fn const double *QCPCurveDataContainer::keyData() const
+  
+  Returns a pointer to the contiguous array of the \ref size keys, in the order of the curve
+  parameters returned by \ref tData. The pointer becomes invalid when the container is modified.
+*/
+
+/*! \fn const double *QCPCurveDataContainer::valueData() const
+  
+  Returns a pointer to the contiguous array of the \ref size values, in the order of the curve
+  parameters returned by \ref tData. The pointer becomes invalid when the container is modified.
+*/
+
+/* end of documentation of inline functions */
+
+/*! \internal
+  
+  Returns whether the curve parameter of data point \a a is smaller than the one of data point \a
+  b. Used as sort predicate for the data points passed to QCPCurveDataContainer.
+*/
+static inline bool qcpLessThanT(const QCPCurveData &a, const QCPCurveData &b)
+{
+  return a.t < b.t;
+}
+
+/*! \internal
+  
+  Returns whether the data points in \a data are sorted ascending by curve parameter.
+*/
+static bool qcpIsSortedByT(const QVector<QCPCurveData> &data)
+{
+  for (int i=1; i<data.size(); ++i)
+  {
+    if (data.at(i).t < data.at(i-1).t)
+      return false;
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Returns whether the first \a n entries of \a t are sorted ascending.
+*/
+static bool qcpIsSortedByT(const QVector<double> &t, int n)
+{
+  for (int i=1; i<n; ++i)
+  {
+    if (t.at(i) < t.at(i-1))
+      return false;
+  }
+  return true;
+}
+
+/*!
+  Constructs an empty curve data container.
+*/
+QCPCurveDataContainer::QCPCurveDataContainer() :
+  mBegin(0),
+  mCapacity(0),
+  mRevision(0)
+{
+}
+
+/*!
+  Replaces the current data with a copy of the data points in \a data.
+  
+  Since the columns are implicitly shared, the actual copy only happens once either container is
+  modified.
+*/
+void QCPCurveDataContainer::set(const QCPCurveDataContainer &data)
+{
+  mT = data.mT;
+  mKeys = data.mKeys;
+  mValues = data.mValues;
+  mBegin = data.mBegin;
+  ++mRevision;
+  enforceCapacity();
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided points in \a t, \a keys and \a values tuples. The
+  provided vectors should have equal length. Else, the number of added points will be the size of
+  the smallest vector.
+  
+  If \a t is sorted ascending, the vectors are adopted as columns directly. Due to implicit
+  sharing, this doesn't even copy them until either side is modified. If you can guarantee that \a
+  t is sorted ascending, set \a alreadySorted to true to skip the check.
+*/
+void QCPCurveDataContainer::set(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  clear();
+  const int n = qMin(t.size(), qMin(keys.size(), values.size()));
+  if (alreadySorted || qcpIsSortedByT(t, n))
+  {
+    mT = t.size() == n ? t : t.mid(0, n);
+    mKeys = keys.size() == n ? keys : keys.mid(0, n);
+    mValues = values.size() == n ? values : values.mid(0, n);
+    enforceCapacity();
+  } else
+    add(t, keys, values, false);
+}
+
+/*!
+  Sets the maximum number of data points the container holds to \a capacity. When data points are
+  added beyond this number, the data points with the smallest t are dropped.
+  
+  The memory for the data points is preallocated, so appending and dropping data points doesn't
+  cause any allocations, as long as points are only appended with t equal to or larger than the
+  current largest t. Both operations are then O(1).
+  
+  Set \a capacity to zero (the default) to make the container unbounded.
+*/
+void QCPCurveDataContainer::setCapacity(int capacity)
+{
+  mCapacity = qMax(0, capacity);
+  enforceCapacity();
+  if (mCapacity > 0)
+    reserve(2*mCapacity); // dropped points are reclaimed once they make up half the storage, see removeIndexRange
+}
+
+/*!
+  Adds the provided data points in \a data to the current data.
+  
+  If you can guarantee that the data points in \a data are sorted ascending by t, set \a
+  alreadySorted to true to skip checking and sorting them.
+*/
+void QCPCurveDataContainer::add(const QVector<QCPCurveData> &data, bool alreadySorted)
+{
+  if (data.isEmpty())
+    return;
+  if (alreadySorted || qcpIsSortedByT(data))
+  {
+    addSorted(data);
+  } else
+  {
+    QVector<QCPCurveData> sortedData(data);
+    std::stable_sort(sortedData.begin(), sortedData.end(), qcpLessThanT);
+    addSorted(sortedData);
+  }
+}
+
+/*! \overload
+  
+  Adds the provided points in \a t, \a keys and \a values tuples to the current data. The
+  provided vectors should have equal length. Else, the number of added points will be the size of
+  the smallest vector.
+  
+  If \a t is sorted and starts at or after the largest t of the current data, the points are
+  appended to the columns directly.
+*/
+void QCPCurveDataContainer::add(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  const int n = qMin(t.size(), qMin(keys.size(), values.size()));
+  if (n == 0)
+    return;
+  if (!alreadySorted)
+    alreadySorted = qcpIsSortedByT(t, n);
+  if (alreadySorted && (isEmpty() || t.first() >= mT.last()))
+  {
+    ++mRevision;
+    // new data only extends the current parameter range, so just append it to the columns:
+    const int oldSize = mT.size();
+    mT.resize(oldSize+n);
+    mKeys.resize(oldSize+n);
+    mValues.resize(oldSize+n);
+    std::copy(t.constBegin(), t.constBegin()+n, mT.begin()+oldSize);
+    std::copy(keys.constBegin(), keys.constBegin()+n, mKeys.begin()+oldSize);
+    std::copy(values.constBegin(), values.constBegin()+n, mValues.begin()+oldSize);
+    enforceCapacity();
+  } else
+  {
+    QVector<QCPCurveData> tempData(n);
+    for (int i=0; i<n; ++i)
+      tempData[i] = QCPCurveData(t.at(i), keys.at(i), values.at(i));
+    add(tempData, alreadySorted);
+  }
+}
+
+/*! \overload
+  
+  Adds the provided single data point \a data to the current data.
+  
+  If the t of \a data is equal to or larger than the largest t of the current data, this is an
+  amortized O(1) operation. If a \ref capacity is set and reached, the data point with the
+  smallest t is dropped.
+*/
+void QCPCurveDataContainer::add(const QCPCurveData &data)
+{
+  ++mRevision;
+  if (isEmpty() || data.t >= mT.last())
+  {
+    mT.append(data.t);
+    mKeys.append(data.key);
+    mValues.append(data.value);
+  } else
+  {
+    compact();
+    int index = findEnd(data.t);
+    mT.insert(index, data.t);
+    mKeys.insert(index, data.key);
+    mValues.insert(index, data.value);
+  }
+  enforceCapacity();
+}
+
+/*!
+  Removes all data points with t smaller than \a t.
+*/
+void QCPCurveDataContainer::removeBefore(double t)
+{
+  removeIndexRange(0, findBegin(t));
+}
+
+/*!
+  Removes all data points with t larger than \a t.
+*/
+void QCPCurveDataContainer::removeAfter(double t)
+{
+  removeIndexRange(findEnd(t), size());
+}
+
+/*!
+  Removes all data points with t larger than \a tFrom and smaller than or equal to \a tTo. If \a
+  tFrom is greater or equal to \a tTo, the function does nothing.
+*/
+void QCPCurveDataContainer::remove(double tFrom, double tTo)
+{
+  if (tFrom >= tTo || isEmpty())
+    return;
+  removeIndexRange(findEnd(tFrom), findEnd(tTo));
+}
+
+/*! \overload
+  
+  Removes all data points with a t exactly equal to \a t.
+*/
+void QCPCurveDataContainer::remove(double t)
+{
+  removeIndexRange(findBegin(t), findEnd(t));
+}
+
+/*!
+  Removes all data points.
+*/
+void QCPCurveDataContainer::clear()
+{
+  mT.clear();
+  mKeys.clear();
+  mValues.clear();
+  mBegin = 0;
+  ++mRevision;
+  if (mCapacity > 0)
+    reserve(2*mCapacity);
+}
+
+/*!
+  Releases memory that was reserved but isn't occupied by data points.
+  
+  \see reserve
+*/
+void QCPCurveDataContainer::squeeze()
+{
+  compact();
+  mT.squeeze();
+  mKeys.squeeze();
+  mValues.squeeze();
+}
+
+/*!
+  Preallocates memory for \a n data points, which prevents repeated reallocations while the
+  container grows.
+  
+  \see squeeze
+*/
+void QCPCurveDataContainer::reserve(int n)
+{
+  compact();
+  mT.reserve(n);
+  mKeys.reserve(n);
+  mValues.reserve(n);
+}
+
+/*!
+  Returns the index of the first data point whose t is equal to or larger than \a t. If all data
+  points have a smaller t, returns \ref size.
+  
+  \see findEnd
+*/
+int QCPCurveDataContainer::findBegin(double t) const
+{
+  const double *ts = tData();
+  return std::lower_bound(ts, ts+size(), t)-ts;
+}
+
+/*!
+  Returns the index of the first data point whose t is larger than \a t. If no data point has a
+  larger t, returns \ref size.
+  
+  \see findBegin
+*/
+int QCPCurveDataContainer::findEnd(double t) const
+{
+  const double *ts = tData();
+  return std::upper_bound(ts, ts+size(), t)-ts;
+}
+
+/*! \internal
+  
+  Removes the storage of data points that were dropped from the front (see \ref
+  removeIndexRange), by moving the remaining data points to the beginning of the columns. The
+  allocated memory is kept.
+*/
+void QCPCurveDataContainer::compact()
+{
+  if (mBegin == 0)
+    return;
+  mT.remove(0, mBegin);
+  mKeys.remove(0, mBegin);
+  mValues.remove(0, mBegin);
+  mBegin = 0;
+}
+
+/*! \internal
+  
+  Drops the data points with the smallest t, until the number of data points doesn't exceed the
+  \ref capacity anymore.
+*/
+void QCPCurveDataContainer::enforceCapacity()
+{
+  if (mCapacity > 0 && size() > mCapacity)
+    removeIndexRange(0, size()-mCapacity);
+}
+
+/*! \internal
+  
+  Adds the data points in \a data, which must be sorted ascending by t, to the current data.
+  
+  The new points are merged into the columns from the back, so the existing points are only moved
+  if the new parameters actually lie inside the current parameter range. Data points with t equal
+  to existing ones are placed after them.
+*/
+void QCPCurveDataContainer::addSorted(const QVector<QCPCurveData> &data)
+{
+  if (data.isEmpty())
+    return;
+  compact();
+  ++mRevision;
+  const int oldSize = mT.size();
+  const int newSize = oldSize+data.size();
+  mT.resize(newSize);
+  mKeys.resize(newSize);
+  mValues.resize(newSize);
+  double *ts = mT.data();
+  double *keys = mKeys.data();
+  double *values = mValues.data();
+  
+  // merge from the back, i is the current old point, j the current new point and k the target index:
+  int i = oldSize-1;
+  int j = data.size()-1;
+  int k = newSize-1;
+  while (j >= 0)
+  {
+    if (i >= 0 && ts[i] > data.at(j).t) // old point comes last, move it up
+    {
+      ts[k] = ts[i];
+      keys[k] = keys[i];
+      values[k] = values[i];
+      --i;
+    } else // new point comes last
+    {
+      const QCPCurveData &d = data.at(j);
+      ts[k] = d.t;
+      keys[k] = d.key;
+      values[k] = d.value;
+      --j;
+    }
+    --k;
+  }
+  enforceCapacity();
+}
+
+/*! \internal
+  
+  Removes the data points with indices from \a begin up to (excluding) \a end from all columns.
+  
+  Data points at the front are not removed from the columns immediately, only the begin offset is
+  advanced. Once the dropped points make up half of the columns, they are removed with \ref
+  compact. So dropping the oldest points of a stream is amortized O(1).
+*/
+void QCPCurveDataContainer::removeIndexRange(int begin, int end)
+{
+  if (begin >= end)
+    return;
+  ++mRevision;
+  const int n = end-begin;
+  if (begin == 0) // drop points at the front by moving the begin offset, the space is reclaimed by compact later
+  {
+    mBegin += n;
+    if (mBegin >= mT.size()/2)
+      compact();
+    return;
+  }
+  mT.remove(mBegin+begin, n);
+  mKeys.remove(mBegin+begin, n);
+  mValues.remove(mBegin+begin, n);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPCurve
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,7 +577,10 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
   coordinate \a t, which defines the order of the points described by the other two coordinates \a
   x and \a y.
 
-  To plot data, assign it with the \ref setData or \ref addData functions.
+  To plot data, assign it with the \ref setData or \ref addData functions. The data is held in a
+  \ref QCPCurveDataContainer, which is accessible via \ref data. For curves of streamed data, a
+  maximum number of data points can be set with \ref QCPCurveDataContainer::setCapacity, the
+  oldest points are then dropped in O(1) as new points are added.
   
   \section appearance Changing the appearance
   
@@ -116,7 +614,7 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
 QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable(keyAxis, valueAxis)
 {
-  mData = new QCPCurveDataMap;
+  mData = new QCPCurveDataContainer;
   mPen.setColor(Qt::blue);
   mPen.setStyle(Qt::SolidLine);
   mBrush.setColor(Qt::blue);
@@ -141,17 +639,41 @@ QCPCurve::~QCPCurve()
   If \a copy is set to true, data points in \a data will only be copied. if false, the plottable
   takes ownership of the passed data and replaces the internal data pointer with it. This is
   significantly faster than copying for large datasets.
+  
+  Alternatively, you can also access and modify the curve's data via the \ref data method, which
+  returns a pointer to the internal \ref QCPCurveDataContainer.
 */
-void QCPCurve::setData(QCPCurveDataMap *data, bool copy)
+void QCPCurve::setData(QCPCurveDataContainer *data, bool copy)
 {
   if (copy)
   {
-    *mData = *data;
+    mData->set(*data);
   } else
   {
     delete mData;
     mData = data;
   }
+  markLayerDirty();
+}
+
+/*! \overload
+  
+  Replaces the current data with the data points in the map \a data.
+  
+  If \a copy is true, the map stays owned by the caller. If \a copy is false, the ownership of the
+  map is transferred to the curve and the map is deleted by this function.
+  
+  \deprecated The curve stores its data in a \ref QCPCurveDataContainer, so the data points are
+  always copied into the container. Changes made to the map after this call don't affect the
+  curve. Use \ref setData(QCPCurveDataContainer *data, bool copy) or \ref data instead.
+*/
+void QCPCurve::setData(QCPCurveDataMap *data, bool copy)
+{
+  mData->clear();
+  mData->add(data->values().toVector(), true);
+  if (!copy)
+    delete data;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -162,18 +684,8 @@ void QCPCurve::setData(QCPCurveDataMap *data, bool copy)
 */
 void QCPCurve::setData(const QVector<double> &t, const QVector<double> &key, const QVector<double> &value)
 {
-  mData->clear();
-  int n = t.size();
-  n = qMin(n, key.size());
-  n = qMin(n, value.size());
-  QCPCurveData newData;
-  for (int i=0; i<n; ++i)
-  {
-    newData.t = t[i];
-    newData.key = key[i];
-    newData.value = value[i];
-    mData->insertMulti(newData.t, newData);
-  }
+  mData->set(t, key, value);
+  markLayerDirty();
 }
 
 /*! \overload
@@ -183,17 +695,12 @@ void QCPCurve::setData(const QVector<double> &t, const QVector<double> &key, con
 */
 void QCPCurve::setData(const QVector<double> &key, const QVector<double> &value)
 {
-  mData->clear();
-  int n = key.size();
-  n = qMin(n, value.size());
-  QCPCurveData newData;
+  const int n = qMin(key.size(), value.size());
+  QVector<double> t(n);
   for (int i=0; i<n; ++i)
-  {
-    newData.t = i; // no t vector given, so we assign t the index of the key/value pair
-    newData.key = key[i];
-    newData.value = value[i];
-    mData->insertMulti(newData.t, newData);
-  }
+    t[i] = i; // no t vector given, so we assign t the index of the key/value pair
+  mData->set(t, key, value, true);
+  markLayerDirty();
 }
 
 /*!
@@ -206,6 +713,7 @@ void QCPCurve::setData(const QVector<double> &key, const QVector<double> &value)
 void QCPCurve::setScatterStyle(const QCPScatterStyle &style)
 {
   mScatterStyle = style;
+  markLayerDirty();
 }
 
 /*!
@@ -218,6 +726,7 @@ void QCPCurve::setScatterStyle(const QCPScatterStyle &style)
 void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
 {
   mLineStyle = style;
+  markLayerDirty();
 }
 
 /*!
@@ -226,7 +735,7 @@ void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
 */
 void QCPCurve::addData(const QCPCurveDataMap &dataMap)
 {
-  mData->unite(dataMap);
+  mData->add(dataMap.values().toVector(), true);
 }
 
 /*! \overload
@@ -235,7 +744,7 @@ void QCPCurve::addData(const QCPCurveDataMap &dataMap)
 */
 void QCPCurve::addData(const QCPCurveData &data)
 {
-  mData->insertMulti(data.t, data);
+  mData->add(data);
 }
 
 /*! \overload
@@ -244,11 +753,7 @@ void QCPCurve::addData(const QCPCurveData &data)
 */
 void QCPCurve::addData(double t, double key, double value)
 {
-  QCPCurveData newData;
-  newData.t = t;
-  newData.key = key;
-  newData.value = value;
-  mData->insertMulti(newData.t, newData);
+  mData->add(QCPCurveData(t, key, value));
 }
 
 /*! \overload
@@ -263,12 +768,12 @@ void QCPCurve::addData(double key, double value)
 {
   QCPCurveData newData;
   if (!mData->isEmpty())
-    newData.t = (mData->constEnd()-1).key()+1;
+    newData.t = mData->t(mData->size()-1)+1;
   else
     newData.t = 0;
   newData.key = key;
   newData.value = value;
-  mData->insertMulti(newData.t, newData);
+  mData->add(newData);
 }
 
 /*! \overload
@@ -277,17 +782,7 @@ void QCPCurve::addData(double key, double value)
 */
 void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, const QVector<double> &values)
 {
-  int n = ts.size();
-  n = qMin(n, keys.size());
-  n = qMin(n, values.size());
-  QCPCurveData newData;
-  for (int i=0; i<n; ++i)
-  {
-    newData.t = ts[i];
-    newData.key = keys[i];
-    newData.value = values[i];
-    mData->insertMulti(newData.t, newData);
-  }
+  mData->add(ts, keys, values);
 }
 
 /*!
@@ -296,9 +791,7 @@ void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, c
 */
 void QCPCurve::removeDataBefore(double t)
 {
-  QCPCurveDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < t)
-    it = mData->erase(it);
+  mData->removeBefore(t);
 }
 
 /*!
@@ -307,10 +800,7 @@ void QCPCurve::removeDataBefore(double t)
 */
 void QCPCurve::removeDataAfter(double t)
 {
-  if (mData->isEmpty()) return;
-  QCPCurveDataMap::iterator it = mData->upperBound(t);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->removeAfter(t);
 }
 
 /*!
@@ -322,11 +812,7 @@ void QCPCurve::removeDataAfter(double t)
 */
 void QCPCurve::removeData(double fromt, double tot)
 {
-  if (fromt >= tot || mData->isEmpty()) return;
-  QCPCurveDataMap::iterator it = mData->upperBound(fromt);
-  QCPCurveDataMap::iterator itEnd = mData->upperBound(tot);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->remove(fromt, tot);
 }
 
 /*! \overload
@@ -366,6 +852,16 @@ double QCPCurve::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
     return -1;
 }
 
+/*! \internal
+  
+  Appends the data revision of this curve, so a buffered layer is redrawn when data was added or
+  removed.
+*/
+void QCPCurve::appendBufferState(QVector<double> &state) const
+{
+  state << mData->revision();
+}
+
 /* inherits documentation from base class */
 void QCPCurve::draw(QCPPainter *painter)
 {
@@ -379,12 +875,11 @@ void QCPCurve::draw(QCPPainter *painter)
   
   // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
-  QCPCurveDataMap::const_iterator it;
-  for (it = mData->constBegin(); it != mData->constEnd(); ++it)
+  for (int i=0; i<mData->size(); ++i)
   {
-    if (QCP::isInvalidData(it.value().t) ||
-        QCP::isInvalidData(it.value().key, it.value().value))
-      qDebug() << Q_FUNC_INFO << "Data point at" << it.key() << "invalid." << "Plottable name:" << name();
+    if (QCP::isInvalidData(mData->t(i)) ||
+        QCP::isInvalidData(mData->key(i), mData->value(i)))
+      qDebug() << Q_FUNC_INFO << "Data point at" << mData->t(i) << "invalid." << "Plottable name:" << name();
   }
 #endif
   
@@ -497,7 +992,9 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   
   QRect axisRect = mKeyAxis.data()->axisRect()->rect() & mValueAxis.data()->axisRect()->rect();
   lineData->reserve(mData->size());
-  QCPCurveDataMap::const_iterator it;
+  const double *keys = mData->keyData();
+  const double *values = mData->valueData();
+  const int dataCount = mData->size();
   int lastRegion = 5;
   int currentRegion = 5;
   double RLeft = keyAxis->range().lower;
@@ -507,10 +1004,10 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   double x, y; // current key/value
   bool addedLastAlready = true;
   bool firstPoint = true; // first point must always be drawn, to make sure fill works correctly
-  for (it = mData->constBegin(); it != mData->constEnd(); ++it)
+  for (int i=0; i<dataCount; ++i)
   {
-    x = it.value().key;
-    y = it.value().value;
+    x = keys[i];
+    y = values[i];
     // determine current region:
     if (x < RLeft) // region 123
     {
@@ -548,13 +1045,13 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
     if (currentRegion == 5 || (firstPoint && mBrush.style() != Qt::NoBrush)) // current is in R, add current and last if it wasn't added already
     {
       if (!addedLastAlready) // in case curve just entered R, make sure the last point outside R is also drawn correctly
-        lineData->append(coordsToPixels((it-1).value().key, (it-1).value().value)); // add last point to vector
+        lineData->append(coordsToPixels(keys[i-1], values[i-1])); // add last point to vector
       else if (lastRegion != 5) // added last already. If that's the case, we probably added it at optimized position. So go back and make sure it's at original position (else the angle changes under which this segment enters R)
       {
         if (!firstPoint) // because on firstPoint, currentRegion is 5 and addedLastAlready is true, although there is no last point
-          lineData->replace(lineData->size()-1, coordsToPixels((it-1).value().key, (it-1).value().value));
+          lineData->replace(lineData->size()-1, coordsToPixels(keys[i-1], values[i-1]));
       }
-      lineData->append(coordsToPixels(it.value().key, it.value().value)); // add current point to vector
+      lineData->append(coordsToPixels(keys[i], values[i])); // add current point to vector
       addedLastAlready = true; // so in next iteration, we don't add this point twice
     } else if (currentRegion != lastRegion) // changed region, add current and last if not added already
     {
@@ -570,16 +1067,16 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
       {
         // always add last point if not added already, original:
         if (!addedLastAlready)
-          lineData->append(coordsToPixels((it-1).value().key, (it-1).value().value));
+          lineData->append(coordsToPixels(keys[i-1], values[i-1]));
         // add current point, original:
-        lineData->append(coordsToPixels(it.value().key, it.value().value));
+        lineData->append(coordsToPixels(keys[i], values[i]));
       } else // no special case that forbids optimized point placement, so do it:
       {
         // always add last point if not added already, optimized:
         if (!addedLastAlready)
-          lineData->append(outsideCoordsToPixels((it-1).value().key, (it-1).value().value, currentRegion, axisRect));
+          lineData->append(outsideCoordsToPixels(keys[i-1], values[i-1], currentRegion, axisRect));
         // add current point, optimized:
-        lineData->append(outsideCoordsToPixels(it.value().key, it.value().value, currentRegion, axisRect));
+        lineData->append(outsideCoordsToPixels(keys[i], values[i], currentRegion, axisRect));
       }
       addedLastAlready = true; // so that if next point enters 5, or crosses another region boundary, we don't add this point twice
     } else // neither in R, nor crossed a region boundary, skip current point
@@ -591,7 +1088,7 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   }
   // If curve ends outside R, we want to add very last point so the fill looks like it should when the curve started inside R:
   if (lastRegion != 5 && mBrush.style() != Qt::NoBrush && !mData->isEmpty())
-    lineData->append(coordsToPixels((mData->constEnd()-1).value().key, (mData->constEnd()-1).value().value));
+    lineData->append(coordsToPixels(keys[dataCount-1], values[dataCount-1]));
 }
 
 /*! \internal
@@ -609,7 +1106,7 @@ double QCPCurve::pointDistance(const QPointF &pixelPoint) const
   }
   if (mData->size() == 1)
   {
-    QPointF dataPoint = coordsToPixels(mData->constBegin().key(), mData->constBegin().value().value);
+    QPointF dataPoint = coordsToPixels(mData->key(0), mData->value(0));
     return QVector2D(dataPoint-pixelPoint).length();
   }
   
@@ -669,10 +1166,10 @@ QCPRange QCPCurve::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
   
   double current;
   
-  QCPCurveDataMap::const_iterator it = mData->constBegin();
-  while (it != mData->constEnd())
+  const double *keys = mData->keyData();
+  for (int i=0; i<mData->size(); ++i)
   {
-    current = it.value().key;
+    current = keys[i];
     if (inSignDomain == sdBoth || (inSignDomain == sdNegative && current < 0) || (inSignDomain == sdPositive && current > 0))
     {
       if (current < range.lower || !haveLower)
@@ -686,7 +1183,6 @@ QCPRange QCPCurve::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
         haveUpper = true;
       }
     }
-    ++it;
   }
   
   foundRange = haveLower && haveUpper;
@@ -702,10 +1198,10 @@ QCPRange QCPCurve::getValueRange(bool &foundRange, SignDomain inSignDomain) cons
   
   double current;
   
-  QCPCurveDataMap::const_iterator it = mData->constBegin();
-  while (it != mData->constEnd())
+  const double *values = mData->valueData();
+  for (int i=0; i<mData->size(); ++i)
   {
-    current = it.value().value;
+    current = values[i];
     if (inSignDomain == sdBoth || (inSignDomain == sdNegative && current < 0) || (inSignDomain == sdPositive && current > 0))
     {
       if (current < range.lower || !haveLower)
@@ -719,7 +1215,6 @@ QCPRange QCPCurve::getValueRange(bool &foundRange, SignDomain inSignDomain) cons
         haveUpper = true;
       }
     }
-    ++it;
   }
   
   foundRange = haveLower && haveUpper;
@@ -44,11 +44,12 @@ public:
 Q_DECLARE_TYPEINFO(QCPCurveData, Q_MOVABLE_TYPE);
 
 /*! \typedef QCPCurveDataMap
-  Container for storing QCPCurveData items in a sorted fashion. The key of the map
+  Map based container for storing QCPCurveData items in a sorted fashion. The key of the map
   is the t member of the QCPCurveData instance.
   
-  This is the container in which QCPCurve holds its data.
-  \see QCPCurveData, QCPCurve::setData
+  QCPCurve holds its data in a \ref QCPCurveDataContainer. This map type is still accepted by \ref
+  QCPCurve::setData and \ref QCPCurve::addData for convenience.
+  \see QCPCurveData, QCPCurveDataContainer
 */
 
 typedef QMap<double, QCPCurveData> QCPCurveDataMap;
@@ -56,6 +57,57 @@ typedef QMapIterator<double, QCPCurveData> QCPCurveDataMapIterator;
 typedef QMutableMapIterator<double, QCPCurveData> QCPCurveDataMutableMapIterator;
 
 
+class QCP_LIB_DECL QCPCurveDataContainer
+{
+public:
+  QCPCurveDataContainer();
+  
+  // getters:
+  int size() const { return mT.size()-mBegin; }
+  bool isEmpty() const { return size() == 0; }
+  quint64 revision() const { return mRevision; }
+  int capacity() const { return mCapacity; }
+  QCPCurveData at(int index) const { return QCPCurveData(t(index), key(index), value(index)); }
+  double t(int index) const { return mT.at(mBegin+index); }
+  double key(int index) const { return mKeys.at(mBegin+index); }
+  double value(int index) const { return mValues.at(mBegin+index); }
+  const double *tData() const { return mT.constData()+mBegin; }
+  const double *keyData() const { return mKeys.constData()+mBegin; }
+  const double *valueData() const { return mValues.constData()+mBegin; }
+  
+  // setters:
+  void set(const QCPCurveDataContainer &data);
+  void set(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void setCapacity(int capacity);
+  
+  // non-property methods:
+  void add(const QVector<QCPCurveData> &data, bool alreadySorted=false);
+  void add(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void add(const QCPCurveData &data);
+  void removeBefore(double t);
+  void removeAfter(double t);
+  void remove(double tFrom, double tTo);
+  void remove(double t);
+  void clear();
+  void squeeze();
+  void reserve(int n);
+  int findBegin(double t) const;
+  int findEnd(double t) const;
+  
+protected:
+  // non-property members:
+  QVector<double> mT, mKeys, mValues;
+  int mBegin, mCapacity;
+  quint64 mRevision;
+  
+  // non-virtual methods:
+  void compact();
+  void enforceCapacity();
+  void addSorted(const QVector<QCPCurveData> &data);
+  void removeIndexRange(int begin, int end);
+};
+
+
 class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable
 {
   Q_OBJECT
@@ -76,11 +128,12 @@ public:
   virtual ~QCPCurve();
   
   // getters:
-  QCPCurveDataMap *data() const { return mData; }
+  QCPCurveDataContainer *data() const { return mData; }
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   LineStyle lineStyle() const { return mLineStyle; }
   
   // setters:
+  void setData(QCPCurveDataContainer *data, bool copy=false);
   void setData(QCPCurveDataMap *data, bool copy=false);
   void setData(const QVector<double> &t, const QVector<double> &key, const QVector<double> &value);
   void setData(const QVector<double> &key, const QVector<double> &value);
@@ -104,7 +157,7 @@ public:
   
 protected:
   // property members:
-  QCPCurveDataMap *mData;
+  QCPCurveDataContainer *mData;
   QCPScatterStyle mScatterStyle;
   LineStyle mLineStyle;
   
@@ -113,6 +166,7 @@ protected:
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
   virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
+  virtual void appendBufferState(QVector<double> &state) const;
   
   // introduced virtual methods:
   virtual void drawScatterPlot(QCPPainter *painter, const QVector<QPointF> *pointData) const;
@@ -37,7 +37,7 @@
 /*! \class QCPData
   \brief Holds the data of one single data point for QCPGraph.
   
-  The container for storing multiple data points is \ref QCPDataMap.
+  The container for storing multiple data points is \ref QCPDataContainer.
   
   The stored data is:
   \li \a key: coordinate on the key axis of this data point
@@ -47,7 +47,7 @@
   \li \a valueErrorMinus: negative error in the value dimension (for error bars)
   \li \a valueErrorPlus: positive error in the value dimension (for error bars)
   
-  \see QCPDataMap
+  \see QCPDataContainer
 */
 
 /*!
@@ -77,6 +77,1118 @@ QCPData::QCPData(double key, double value) :
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPDataContainer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPDataContainer
+  \brief Holds the data points of a QCPGraph, sorted by key.
+  
+  The data points are kept sorted ascending by their key at all times. This allows finding the
+  points inside a key interval with a binary search (\ref findBegin, \ref findEnd) and iterating
+  over them without chasing pointers, as was the case with the map based \ref QCPDataMap.
+  
+  Internally, keys and values are stored in separate contiguous arrays (columns). The columns for
+  the key errors and value errors are only allocated once a data point with a non-zero error of
+  the respective dimension is added, see \ref hasKeyErrors and \ref hasValueErrors. So a graph
+  without error bars only needs the memory for its keys and values, and scans over one dimension
+  (e.g. determining the value range) only touch the memory of that dimension. The columns can be
+  accessed directly via \ref keyData and \ref valueData.
+  
+  Adding data points whose keys are equal to or larger than the key of the current last data point
+  (the typical case when data is streamed in) is an amortized O(1) append. Data points with smaller
+  keys are inserted at the correct position, which requires moving the subsequent data points in
+  memory. If many such points are to be added, pass them in a single call to \ref add, so the
+  container can merge them in one pass.
+  
+  Like in a QMap, each key occurs only once. Adding a data point with a key that is already present
+  replaces the existing data point. If the data points passed to one call contain equal keys, the
+  one that comes last wins.
+  
+  Instead of holding its own copy, the container can also reference key and value arrays that are
+  owned by the application, see \ref setExternal. This avoids duplicating large data sets which
+  are already available in memory in the right layout.
+  
+  For large data sets, the container maintains a multi-resolution index of the value minima and
+  maxima (a min/max pyramid), which is built on first use and updated incrementally as data is
+  appended. It allows \ref valueMinMax to determine the value span of any index range in O(log n),
+  which QCPGraph uses for adaptive sampling.
+  
+  For streaming data, where new points are appended at the end and old points are dropped from
+  the beginning, removing points from the beginning doesn't move the remaining points in memory.
+  The freed space is reclaimed in one go once it makes up half of the storage, so both appending
+  and dropping points are amortized O(1). With \ref setCapacity, the container additionally
+  drops its oldest points automatically and keeps its memory preallocated, so a scrolling plot
+  runs without any reallocations.
+  
+  Every modification increments the \ref revision of the container. Code that caches results
+  derived from the data can compare the revision to decide whether the cache is still valid.
+  
+  The data points are accessed by index via \ref at, \ref key and \ref value, where index 0 is
+  the data point with the smallest key.
+  
+  \see QCPGraph::data
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn int QCPDataContainer::size() const
+  
+  Returns the number of data points in the container.
+*/
+
+/*! \fn bool QCPDataContainer::isEmpty() const
+  
+  Returns whether the container holds no data points.
+*/
+
+/*! \fn bool QCPDataContainer::isExternal() const
+  
+  Returns whether the container references external key and value arrays, as set with \ref
+  setExternal.
+*/
+
+/*! \fn int QCPDataContainer::capacity() const
+  
+  Returns the maximum number of data points the container holds, or zero if it is unbounded.
+  
+  \see setCapacity
+*/
+
+/*! \fn quint64 QCPDataContainer::revision() const
+  
+  Returns the revision number of the data. It is incremented whenever the container is modified,
+  and when \ref markModified is called. If it hasn't changed, the data is the same as the last
+  time the revision was read.
+*/
+
+/*! \fn bool QCPDataContainer::hasKeyErrors() const
+  
+  Returns whether the container stores key errors. This is the case once a data point with a
+  non-zero key error was added, until the container is cleared with \ref clear or replaced with
+  \ref set.
+  
+  If this returns false, \ref keyErrorMinus and \ref keyErrorPlus return zero for all data points.
+  
+  \see hasValueErrors
+*/
+
+/*! \fn bool QCPDataContainer::hasValueErrors() const
+  
+  Returns whether the container stores value errors. This is the case once a data point with a
+  non-zero value error was added, until the container is cleared with \ref clear or replaced with
+  \ref set.
+  
+  If this returns false, \ref valueErrorMinus and \ref valueErrorPlus return zero for all data
+  points.
+  
+  \see hasKeyErrors
+*/
+
+/*! \fn double QCPDataContainer::key(int index) const
+  
+  Returns the key of the data point at \a index. The index must be in the range 0 to \ref size-1.
+  
+  \see at, value
+*/
+
+/*! \fn double QCPDataContainer::value(int index) const
+  
+  Returns the value of the data point at \a index. The index must be in the range 0 to \ref
+  size-1.
+  
+  \see at, key
+*/
+
+/*! \fn double QCPDataContainer::keyErrorMinus(int index) const
+  
+  Returns the negative key error of the data point at \a index, or zero if the container doesn't
+  store key errors (\ref hasKeyErrors).
+*/
+
+/*! \fn double QCPDataContainer::keyErrorPlus(int index) const
+  
+  Returns the positive key error of the data point at \a index, or zero if the container doesn't
+  store key errors (\ref hasKeyErrors).
+*/
+
+/*! \fn double QCPDataContainer::valueErrorMinus(int index) const
+  
+  Returns the negative value error of the data point at \a index, or zero if the container doesn't
+  store value errors (\ref hasValueErrors).
+*/
+
+/*! \fn double QCPDataContainer::valueErrorPlus(int index) const
+  
+  Returns the positive value error of the data point at \a index, or zero if the container doesn't
+  store value errors (\ref hasValueErrors).
+*/
+
+/*! \fn const double *QCPDataContainer::keyData() const
+  
+  Returns a pointer to the contiguous array of the \ref size keys, sorted ascending. The pointer
+  becomes invalid when the container is modified.
+  
+  \see valueData
+*/
+
+/*! \fn const double *QCPDataContainer::valueData() const
+  
+  Returns a pointer to the contiguous array of the \ref size values, in the same order as the keys
+  returned by \ref keyData. The pointer becomes invalid when the container is modified.
+  
+  \see keyData
+*/
+
+/* end of documentation of inline functions */
+
+/*! \internal
+  
+  The number of values summarized by one block on the lowest level of the min/max pyramid of
+  QCPDataContainer. Ranges shorter than this are scanned directly.
+*/
+static const int qcpPyramidBlockSize = 32;
+
+/*! \internal
+  
+  Returns whether the key of data point \a a is smaller than the key of data point \a b. Used as
+  sort predicate for the data points passed to QCPDataContainer.
+*/
+static inline bool qcpLessThanKey(const QCPData &a, const QCPData &b)
+{
+  return a.key < b.key;
+}
+
+/*! \internal
+  
+  Returns whether the data points in \a data are sorted ascending by key.
+*/
+static bool qcpIsSortedByKey(const QVector<QCPData> &data)
+{
+  for (int i=1; i<data.size(); ++i)
+  {
+    if (data.at(i).key < data.at(i-1).key)
+      return false;
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Returns whether the first \a n entries of \a keys are sorted ascending.
+*/
+static bool qcpIsSortedByKey(const QVector<double> &keys, int n)
+{
+  for (int i=1; i<n; ++i)
+  {
+    if (keys.at(i) < keys.at(i-1))
+      return false;
+  }
+  return true;
+}
+
+/*!
+  Constructs an empty data container.
+*/
+QCPDataContainer::QCPDataContainer() :
+  mHasKeyErrors(false),
+  mHasValueErrors(false),
+  mBegin(0),
+  mCapacity(0),
+  mExternalKeys(0),
+  mExternalValues(0),
+  mExternalSize(0),
+  mRevision(0),
+  mPyramidCount(0)
+{
+}
+
+/*!
+  Returns the data point at \a index. The index must be in the range 0 to \ref size-1.
+  
+  Since keys, values and errors are stored in separate columns, the returned data point is
+  assembled from them. If you only need the key or value, \ref key and \ref value are faster.
+*/
+QCPData QCPDataContainer::at(int index) const
+{
+  QCPData result(key(index), value(index));
+  if (mHasKeyErrors)
+  {
+    result.keyErrorMinus = mKeyErrorsMinus.at(mBegin+index);
+    result.keyErrorPlus = mKeyErrorsPlus.at(mBegin+index);
+  }
+  if (mHasValueErrors)
+  {
+    result.valueErrorMinus = mValueErrorsMinus.at(mBegin+index);
+    result.valueErrorPlus = mValueErrorsPlus.at(mBegin+index);
+  }
+  return result;
+}
+
+/*!
+  Replaces the current data with a copy of the data points in \a data.
+  
+  Since the columns are implicitly shared, the actual copy only happens once either container is
+  modified.
+*/
+void QCPDataContainer::set(const QCPDataContainer &data)
+{
+  mKeys = data.mKeys;
+  mValues = data.mValues;
+  mKeyErrorsMinus = data.mKeyErrorsMinus;
+  mKeyErrorsPlus = data.mKeyErrorsPlus;
+  mValueErrorsMinus = data.mValueErrorsMinus;
+  mValueErrorsPlus = data.mValueErrorsPlus;
+  mHasKeyErrors = data.mHasKeyErrors;
+  mHasValueErrors = data.mHasValueErrors;
+  mBegin = data.mBegin;
+  mExternalKeys = data.mExternalKeys;
+  mExternalValues = data.mExternalValues;
+  mExternalSize = data.mExternalSize;
+  ++mRevision;
+  invalidatePyramid(0);
+  enforceCapacity();
+}
+
+/*!
+  Makes the container reference the external arrays \a keys and \a values, each holding \a size
+  entries, instead of storing its own copy of the data. The keys must be sorted ascending. The
+  current data is discarded.
+  
+  The arrays are not copied and the container doesn't take ownership of them. So they must stay
+  valid until the container is cleared or different data is set. If you modify the array contents
+  afterwards, call \ref markModified so the change becomes visible to the plottable's caches.
+  
+  Reading the data (\ref key, \ref value, \ref findBegin,...) directly accesses the external
+  arrays. Removing data points from the beginning or end (e.g. \ref removeBefore) only narrows the
+  referenced window without touching the arrays. Any other modification, like adding data points,
+  first copies the external data into the container, which then no longer references the arrays.
+  
+  Passing null pointers or a \a size of zero clears the container.
+*/
+void QCPDataContainer::setExternal(const double *keys, const double *values, int size)
+{
+  clear();
+  if (keys && values && size > 0)
+  {
+    mExternalKeys = keys;
+    mExternalValues = values;
+    mExternalSize = size;
+    enforceCapacity();
+  }
+}
+
+/*!
+  Sets the maximum number of data points the container holds to \a capacity. When data points are
+  added beyond this number, the data points with the smallest keys are dropped. This is the typical
+  setup for scrolling plots of streamed data, e.g. a strip chart showing the last N samples.
+  
+  The memory for the data points is preallocated, so appending and dropping data points doesn't
+  cause any allocations, as long as no errors are added and points are only appended with keys
+  equal to or larger than the current largest key. Both operations are then O(1).
+  
+  Set \a capacity to zero (the default) to make the container unbounded.
+*/
+void QCPDataContainer::setCapacity(int capacity)
+{
+  mCapacity = qMax(0, capacity);
+  enforceCapacity();
+  if (mCapacity > 0 && !mExternalKeys)
+    reserve(2*mCapacity); // dropped points are reclaimed once they make up half the storage, see removeIndexRange
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided data points in \a data.
+  
+  If you can guarantee that the keys of the data points in \a data are sorted ascending, set \a
+  alreadySorted to true to skip checking and sorting them.
+*/
+void QCPDataContainer::set(const QVector<QCPData> &data, bool alreadySorted)
+{
+  clear();
+  add(data, alreadySorted);
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided points in \a keys and \a values pairs. The provided
+  vectors should have equal length. Else, the number of added points will be the size of the
+  smallest vector.
+  
+  If the keys are sorted ascending, the vectors are adopted as key and value columns directly. Due
+  to implicit sharing, this doesn't even copy them until either side is modified. If you can
+  guarantee that \a keys is sorted ascending, set \a alreadySorted to true to skip the check.
+*/
+void QCPDataContainer::set(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  clear();
+  const int n = qMin(keys.size(), values.size());
+  if (alreadySorted || qcpIsSortedByKey(keys, n))
+  {
+    mKeys = keys.size() == n ? keys : keys.mid(0, n);
+    mValues = values.size() == n ? values : values.mid(0, n);
+    removeDuplicateKeys(0);
+    enforceCapacity();
+  } else
+    add(keys, values, false);
+}
+
+/*!
+  Adds the data points in \a data to the current data.
+*/
+void QCPDataContainer::add(const QCPDataContainer &data)
+{
+  QVector<QCPData> tempData(data.size());
+  for (int i=0; i<data.size(); ++i)
+    tempData[i] = data.at(i);
+  addSorted(tempData);
+}
+
+/*! \overload
+  
+  Adds the provided data points in \a data to the current data.
+  
+  If you can guarantee that the keys of the data points in \a data are sorted ascending, set \a
+  alreadySorted to true to skip checking and sorting them.
+  
+  If the smallest key of the new data points is equal to or larger than the largest key of the
+  current data, the new points are simply appended. Otherwise the two sorted ranges are merged.
+*/
+void QCPDataContainer::add(const QVector<QCPData> &data, bool alreadySorted)
+{
+  if (data.isEmpty())
+    return;
+  if (alreadySorted || qcpIsSortedByKey(data))
+  {
+    addSorted(data);
+  } else
+  {
+    QVector<QCPData> sortedData(data);
+    std::stable_sort(sortedData.begin(), sortedData.end(), qcpLessThanKey);
+    addSorted(sortedData);
+  }
+}
+
+/*! \overload
+  
+  Adds the provided points in \a keys and \a values pairs to the current data. The provided
+  vectors should have equal length. Else, the number of added points will be the size of the
+  smallest vector.
+  
+  If you can guarantee that \a keys is sorted ascending, set \a alreadySorted to true to skip
+  checking and sorting them. If the keys are sorted and start at or after the largest key of the
+  current data, the keys and values are appended to the columns directly.
+*/
+void QCPDataContainer::add(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  const int n = qMin(keys.size(), values.size());
+  if (n == 0)
+    return;
+  detachExternal();
+  if (!alreadySorted)
+    alreadySorted = qcpIsSortedByKey(keys, n);
+  if (alreadySorted && (isEmpty() || keys.first() >= mKeys.last()))
+  {
+    ++mRevision;
+    // new data only extends the current key range, so just append it to the columns:
+    const int oldSize = mKeys.size();
+    mKeys.resize(oldSize+n);
+    mValues.resize(oldSize+n);
+    std::copy(keys.constBegin(), keys.constBegin()+n, mKeys.begin()+oldSize);
+    std::copy(values.constBegin(), values.constBegin()+n, mValues.begin()+oldSize);
+    if (mHasKeyErrors)
+    {
+      mKeyErrorsMinus.resize(oldSize+n);
+      mKeyErrorsPlus.resize(oldSize+n);
+      std::fill(mKeyErrorsMinus.begin()+oldSize, mKeyErrorsMinus.end(), 0.0);
+      std::fill(mKeyErrorsPlus.begin()+oldSize, mKeyErrorsPlus.end(), 0.0);
+    }
+    if (mHasValueErrors)
+    {
+      mValueErrorsMinus.resize(oldSize+n);
+      mValueErrorsPlus.resize(oldSize+n);
+      std::fill(mValueErrorsMinus.begin()+oldSize, mValueErrorsMinus.end(), 0.0);
+      std::fill(mValueErrorsPlus.begin()+oldSize, mValueErrorsPlus.end(), 0.0);
+    }
+    removeDuplicateKeys(oldSize-1); // first new key may be equal to the old last key
+    enforceCapacity();
+  } else
+  {
+    QVector<QCPData> tempData(n);
+    for (int i=0; i<n; ++i)
+    {
+      tempData[i].key = keys.at(i);
+      tempData[i].value = values.at(i);
+    }
+    add(tempData, alreadySorted);
+  }
+}
+
+/*! \overload
+  
+  Adds the provided single data point \a data to the current data.
+  
+  If a data point with the same key already exists, it is replaced by \a data.
+  
+  If the key of \a data is equal to or larger than the largest key of the current data, this is an
+  amortized O(1) operation. If a \ref capacity is set and reached, the data point with the
+  smallest key is dropped.
+*/
+void QCPDataContainer::add(const QCPData &data)
+{
+  detachExternal();
+  ++mRevision;
+  if (!mHasKeyErrors && (data.keyErrorMinus != 0 || data.keyErrorPlus != 0))
+    enableKeyErrors();
+  if (!mHasValueErrors && (data.valueErrorMinus != 0 || data.valueErrorPlus != 0))
+    enableValueErrors();
+  
+  if (!isEmpty() && data.key == mKeys.last())
+  {
+    replaceAt(mKeys.size()-1, data);
+  } else if (isEmpty() || data.key > mKeys.last())
+  {
+    mKeys.append(data.key);
+    mValues.append(data.value);
+    if (mHasKeyErrors)
+    {
+      mKeyErrorsMinus.append(data.keyErrorMinus);
+      mKeyErrorsPlus.append(data.keyErrorPlus);
+    }
+    if (mHasValueErrors)
+    {
+      mValueErrorsMinus.append(data.valueErrorMinus);
+      mValueErrorsPlus.append(data.valueErrorPlus);
+    }
+  } else
+  {
+    compact();
+    int index = findBegin(data.key);
+    if (mKeys.at(index) == data.key) // index is valid, because data.key is smaller than the last key
+    {
+      replaceAt(index, data);
+      return;
+    }
+    invalidatePyramid(index);
+    mKeys.insert(index, data.key);
+    mValues.insert(index, data.value);
+    if (mHasKeyErrors)
+    {
+      mKeyErrorsMinus.insert(index, data.keyErrorMinus);
+      mKeyErrorsPlus.insert(index, data.keyErrorPlus);
+    }
+    if (mHasValueErrors)
+    {
+      mValueErrorsMinus.insert(index, data.valueErrorMinus);
+      mValueErrorsPlus.insert(index, data.valueErrorPlus);
+    }
+  }
+  enforceCapacity();
+}
+
+/*!
+  Removes all data points with keys smaller than \a key.
+*/
+void QCPDataContainer::removeBefore(double key)
+{
+  removeIndexRange(0, findBegin(key));
+}
+
+/*!
+  Removes all data points with keys larger than \a key.
+*/
+void QCPDataContainer::removeAfter(double key)
+{
+  removeIndexRange(findEnd(key), size());
+}
+
+/*!
+  Removes all data points with keys larger than \a keyFrom and smaller than or equal to \a keyTo.
+  If \a keyFrom is greater or equal to \a keyTo, the function does nothing.
+*/
+void QCPDataContainer::remove(double keyFrom, double keyTo)
+{
+  if (keyFrom >= keyTo || isEmpty())
+    return;
+  removeIndexRange(findEnd(keyFrom), findEnd(keyTo));
+}
+
+/*! \overload
+  
+  Removes all data points with a key exactly equal to \a key.
+*/
+void QCPDataContainer::remove(double key)
+{
+  removeIndexRange(findBegin(key), findEnd(key));
+}
+
+/*!
+  Removes all data points. This also releases the key and value error columns, see \ref
+  hasKeyErrors and \ref hasValueErrors, and stops referencing external arrays, see \ref
+  setExternal.
+*/
+void QCPDataContainer::clear()
+{
+  mKeys.clear();
+  mValues.clear();
+  mKeyErrorsMinus.clear();
+  mKeyErrorsPlus.clear();
+  mValueErrorsMinus.clear();
+  mValueErrorsPlus.clear();
+  mHasKeyErrors = false;
+  mHasValueErrors = false;
+  mBegin = 0;
+  mExternalKeys = 0;
+  mExternalValues = 0;
+  mExternalSize = 0;
+  mMinPyramid.clear();
+  mMaxPyramid.clear();
+  mPyramidCount = 0;
+  ++mRevision;
+  if (mCapacity > 0)
+    reserve(2*mCapacity);
+}
+
+/*!
+  Releases memory that was reserved but isn't occupied by data points. This may be useful after
+  removing a large number of data points.
+  
+  \see reserve
+*/
+void QCPDataContainer::squeeze()
+{
+  compact();
+  mKeys.squeeze();
+  mValues.squeeze();
+  mKeyErrorsMinus.squeeze();
+  mKeyErrorsPlus.squeeze();
+  mValueErrorsMinus.squeeze();
+  mValueErrorsPlus.squeeze();
+}
+
+/*!
+  Preallocates memory for \a n data points. If you know in advance how many data points will be
+  added, this prevents repeated reallocations while the container grows.
+  
+  \see squeeze
+*/
+void QCPDataContainer::reserve(int n)
+{
+  detachExternal();
+  compact();
+  mKeys.reserve(n);
+  mValues.reserve(n);
+  if (mHasKeyErrors)
+  {
+    mKeyErrorsMinus.reserve(n);
+    mKeyErrorsPlus.reserve(n);
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorsMinus.reserve(n);
+    mValueErrorsPlus.reserve(n);
+  }
+}
+
+/*!
+  Returns the index of the first data point whose key is equal to or larger than \a key. If all
+  data points have smaller keys, returns \ref size.
+  
+  The search is a binary search and thus takes O(log n).
+  
+  \see findEnd
+*/
+int QCPDataContainer::findBegin(double key) const
+{
+  const double *keys = keyData();
+  return std::lower_bound(keys, keys+size(), key)-keys;
+}
+
+/*!
+  Returns the index of the first data point whose key is larger than \a key. If no data point has
+  a larger key, returns \ref size.
+  
+  The search is a binary search and thus takes O(log n).
+  
+  \see findBegin
+*/
+int QCPDataContainer::findEnd(double key) const
+{
+  const double *keys = keyData();
+  return std::upper_bound(keys, keys+size(), key)-keys;
+}
+
+/*!
+  Determines the smallest and largest value of the data points with indices from \a begin up to
+  (excluding) \a end, and returns them in \a minValue and \a maxValue. The range must contain at
+  least one data point.
+  
+  For large ranges, this reads the precomputed minima and maxima of blocks of data points instead
+  of the individual values, so it takes O(log n). The block summaries are built on the first call
+  and afterwards only updated for the parts of the data that changed, e.g. newly appended points.
+  
+  NaN values are skipped, unless the value of the first data point in the range is NaN, in which
+  case both \a minValue and \a maxValue are NaN.
+*/
+void QCPDataContainer::valueMinMax(int begin, int end, double &minValue, double &maxValue) const
+{
+  const int offset = mExternalKeys ? 0 : mBegin; // physical index = logical index + offset
+  const double *values = valueData()-offset;
+  minValue = values[begin+offset];
+  maxValue = minValue;
+  int i = begin+offset+1;
+  const int iEnd = end+offset;
+  if (iEnd-i >= 2*qcpPyramidBlockSize)
+  {
+    updatePyramid();
+    for (; i%qcpPyramidBlockSize != 0; ++i)
+    {
+      if (values[i] < minValue)
+        minValue = values[i];
+      else if (values[i] > maxValue)
+        maxValue = values[i];
+    }
+    while (iEnd-i >= qcpPyramidBlockSize)
+    {
+      // use the largest block that starts at i and lies completely inside the range:
+      int level = 0;
+      int blockSize = qcpPyramidBlockSize;
+      while (level+1 < mMinPyramid.size() && i%(2*blockSize) == 0 && i+2*blockSize <= iEnd)
+      {
+        ++level;
+        blockSize *= 2;
+      }
+      const double blockMin = mMinPyramid.at(level).at(i/blockSize);
+      const double blockMax = mMaxPyramid.at(level).at(i/blockSize);
+      if (blockMin < minValue)
+        minValue = blockMin;
+      if (blockMax > maxValue)
+        maxValue = blockMax;
+      i += blockSize;
+    }
+  }
+  for (; i<iEnd; ++i)
+  {
+    if (values[i] < minValue)
+      minValue = values[i];
+    else if (values[i] > maxValue)
+      maxValue = values[i];
+  }
+}
+
+/*!
+  Increments the \ref revision of the container. Call this after you have modified the contents
+  of external arrays referenced with \ref setExternal, so the plottables and any caches depending
+  on the data know that it has changed.
+*/
+void QCPDataContainer::markModified()
+{
+  ++mRevision;
+  invalidatePyramid(0);
+}
+
+/*! \internal
+  
+  If the container references external arrays (see \ref setExternal), copies their contents into
+  the key and value columns and stops referencing them. Called before any modification that can't
+  be performed on the external arrays.
+*/
+void QCPDataContainer::detachExternal()
+{
+  if (!mExternalKeys)
+    return;
+  mKeys.resize(mExternalSize);
+  mValues.resize(mExternalSize);
+  std::copy(mExternalKeys, mExternalKeys+mExternalSize, mKeys.begin());
+  std::copy(mExternalValues, mExternalValues+mExternalSize, mValues.begin());
+  mExternalKeys = 0;
+  mExternalValues = 0;
+  mExternalSize = 0;
+  invalidatePyramid(0);
+}
+
+/*! \internal
+  
+  Adds the data points in \a data, which must be sorted ascending by key, to the current data.
+  
+  The new points are merged into the columns from the back, so no temporary buffer is needed and
+  the existing points are only moved if the new keys actually lie inside the current key range.
+  Data points with keys equal to existing keys are placed after them and then replace them, see
+  \ref removeDuplicateKeys.
+*/
+void QCPDataContainer::addSorted(const QVector<QCPData> &data)
+{
+  if (data.isEmpty())
+    return;
+  detachExternal();
+  compact();
+  ++mRevision;
+  
+  // allocate error columns if new data carries errors:
+  for (int i=0; i<data.size() && (!mHasKeyErrors || !mHasValueErrors); ++i)
+  {
+    const QCPData &d = data.at(i);
+    if (!mHasKeyErrors && (d.keyErrorMinus != 0 || d.keyErrorPlus != 0))
+      enableKeyErrors();
+    if (!mHasValueErrors && (d.valueErrorMinus != 0 || d.valueErrorPlus != 0))
+      enableValueErrors();
+  }
+  
+  const int firstIndex = findBegin(data.first().key); // points before this index stay in place
+  invalidatePyramid(firstIndex);
+  const int oldSize = mKeys.size();
+  const int newSize = oldSize+data.size();
+  mKeys.resize(newSize);
+  mValues.resize(newSize);
+  if (mHasKeyErrors)
+  {
+    mKeyErrorsMinus.resize(newSize);
+    mKeyErrorsPlus.resize(newSize);
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorsMinus.resize(newSize);
+    mValueErrorsPlus.resize(newSize);
+  }
+  double *keys = mKeys.data();
+  double *values = mValues.data();
+  double *keyErrorsMinus = mHasKeyErrors ? mKeyErrorsMinus.data() : 0;
+  double *keyErrorsPlus = mHasKeyErrors ? mKeyErrorsPlus.data() : 0;
+  double *valueErrorsMinus = mHasValueErrors ? mValueErrorsMinus.data() : 0;
+  double *valueErrorsPlus = mHasValueErrors ? mValueErrorsPlus.data() : 0;
+  
+  // merge from the back, i is the current old point, j the current new point and k the target index:
+  int i = oldSize-1;
+  int j = data.size()-1;
+  int k = newSize-1;
+  while (j >= 0)
+  {
+    if (i >= 0 && keys[i] > data.at(j).key) // old point comes last, move it up
+    {
+      keys[k] = keys[i];
+      values[k] = values[i];
+      if (keyErrorsMinus)
+      {
+        keyErrorsMinus[k] = keyErrorsMinus[i];
+        keyErrorsPlus[k] = keyErrorsPlus[i];
+      }
+      if (valueErrorsMinus)
+      {
+        valueErrorsMinus[k] = valueErrorsMinus[i];
+        valueErrorsPlus[k] = valueErrorsPlus[i];
+      }
+      --i;
+    } else // new point comes last
+    {
+      const QCPData &d = data.at(j);
+      keys[k] = d.key;
+      values[k] = d.value;
+      if (keyErrorsMinus)
+      {
+        keyErrorsMinus[k] = d.keyErrorMinus;
+        keyErrorsPlus[k] = d.keyErrorPlus;
+      }
+      if (valueErrorsMinus)
+      {
+        valueErrorsMinus[k] = d.valueErrorMinus;
+        valueErrorsPlus[k] = d.valueErrorPlus;
+      }
+      --j;
+    }
+    --k;
+  }
+  removeDuplicateKeys(firstIndex);
+  enforceCapacity();
+}
+
+/*! \internal
+  
+  Overwrites the data point at storage index \a index with \a data. The key of \a data must be
+  equal to the key at \a index, so the order of the data points is preserved.
+*/
+void QCPDataContainer::replaceAt(int index, const QCPData &data)
+{
+  invalidatePyramid(index);
+  mValues[index] = data.value;
+  if (mHasKeyErrors)
+  {
+    mKeyErrorsMinus[index] = data.keyErrorMinus;
+    mKeyErrorsPlus[index] = data.keyErrorPlus;
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorsMinus[index] = data.valueErrorMinus;
+    mValueErrorsPlus[index] = data.valueErrorPlus;
+  }
+}
+
+/*! \internal
+  
+  Collapses runs of data points with equal keys from storage index \a begin onwards, keeping only
+  the last data point of each run. Since new data points are placed after existing data points
+  with the same key, this makes added data points replace existing ones, like QMap::insert does.
+  
+  The columns are only written to if there actually are equal keys, so implicitly shared columns
+  aren't detached unnecessarily.
+*/
+void QCPDataContainer::removeDuplicateKeys(int begin)
+{
+  const int count = mKeys.size();
+  int i = qMax(mBegin, begin);
+  const double *constKeys = mKeys.constData();
+  while (i+1 < count && constKeys[i] != constKeys[i+1])
+    ++i;
+  if (i+1 >= count)
+    return;
+  
+  // i is the first point that is replaced by its successor, move the following points down:
+  invalidatePyramid(i);
+  double *keys = mKeys.data();
+  double *values = mValues.data();
+  double *keyErrorsMinus = mHasKeyErrors ? mKeyErrorsMinus.data() : 0;
+  double *keyErrorsPlus = mHasKeyErrors ? mKeyErrorsPlus.data() : 0;
+  double *valueErrorsMinus = mHasValueErrors ? mValueErrorsMinus.data() : 0;
+  double *valueErrorsPlus = mHasValueErrors ? mValueErrorsPlus.data() : 0;
+  int k = i;
+  for (; i<count; ++i)
+  {
+    if (i+1 < count && keys[i] == keys[i+1])
+      continue;
+    keys[k] = keys[i];
+    values[k] = values[i];
+    if (keyErrorsMinus)
+    {
+      keyErrorsMinus[k] = keyErrorsMinus[i];
+      keyErrorsPlus[k] = keyErrorsPlus[i];
+    }
+    if (valueErrorsMinus)
+    {
+      valueErrorsMinus[k] = valueErrorsMinus[i];
+      valueErrorsPlus[k] = valueErrorsPlus[i];
+    }
+    ++k;
+  }
+  mKeys.resize(k);
+  mValues.resize(k);
+  if (mHasKeyErrors)
+  {
+    mKeyErrorsMinus.resize(k);
+    mKeyErrorsPlus.resize(k);
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorsMinus.resize(k);
+    mValueErrorsPlus.resize(k);
+  }
+}
+
+/*! \internal
+  
+  Removes the data points with indices from \a begin up to (excluding) \a end from all columns.
+  
+  Data points at the front are not removed from the columns immediately, only the begin offset is
+  advanced. Once the dropped points make up half of the columns, they are removed with
+  \ref compact. So dropping the oldest points of a stream is amortized O(1).
+*/
+void QCPDataContainer::removeIndexRange(int begin, int end)
+{
+  if (begin >= end)
+    return;
+  ++mRevision;
+  const int n = end-begin;
+  if (mExternalKeys && (begin == 0 || end == mExternalSize)) // only narrow the referenced window
+  {
+    if (begin == 0)
+    {
+      mExternalKeys += n;
+      mExternalValues += n;
+      invalidatePyramid(0);
+    }
+    mExternalSize -= n;
+    invalidatePyramid(mExternalSize);
+    return;
+  }
+  detachExternal();
+  if (begin == 0) // drop points at the front by moving the begin offset, the space is reclaimed by compact later
+  {
+    mBegin += n;
+    if (mBegin >= mKeys.size()/2)
+      compact();
+    return;
+  }
+  invalidatePyramid(mBegin+begin);
+  mKeys.remove(mBegin+begin, n);
+  mValues.remove(mBegin+begin, n);
+  if (mHasKeyErrors)
+  {
+    mKeyErrorsMinus.remove(mBegin+begin, n);
+    mKeyErrorsPlus.remove(mBegin+begin, n);
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorsMinus.remove(mBegin+begin, n);
+    mValueErrorsPlus.remove(mBegin+begin, n);
+  }
+}
+
+/*! \internal
+  
+  Removes the storage of data points that were dropped from the front (see \ref
+  removeIndexRange), by moving the remaining data points to the beginning of the columns. The
+  allocated memory is kept.
+*/
+void QCPDataContainer::compact()
+{
+  if (mBegin == 0)
+    return;
+  mKeys.remove(0, mBegin);
+  mValues.remove(0, mBegin);
+  if (mHasKeyErrors)
+  {
+    mKeyErrorsMinus.remove(0, mBegin);
+    mKeyErrorsPlus.remove(0, mBegin);
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorsMinus.remove(0, mBegin);
+    mValueErrorsPlus.remove(0, mBegin);
+  }
+  mBegin = 0;
+  invalidatePyramid(0);
+}
+
+/*! \internal
+  
+  Marks the min/max pyramid as outdated for the data points at storage index \a index and
+  following. The next call to \ref updatePyramid recomputes the affected block summaries.
+*/
+void QCPDataContainer::invalidatePyramid(int index)
+{
+  if (index < mPyramidCount)
+    mPyramidCount = index;
+}
+
+/*! \internal
+  
+  Brings the min/max pyramid used by \ref valueMinMax up to date with the stored values.
+  
+  Level 0 of the pyramid holds the minimum and maximum of each block of qcpPyramidBlockSize
+  consecutive values. Each further level combines two neighbouring blocks of the level below, up
+  to a single block spanning all values. Only the blocks covering storage indices from
+  mPyramidCount onwards are recomputed, so appending data points only touches O(log n) blocks.
+*/
+void QCPDataContainer::updatePyramid() const
+{
+  const double *values = mExternalKeys ? mExternalValues : mValues.constData();
+  const int count = mExternalKeys ? mExternalSize : mValues.size();
+  if (mPyramidCount == count && !mMinPyramid.isEmpty())
+    return;
+  if (count == 0)
+  {
+    mMinPyramid.clear();
+    mMaxPyramid.clear();
+    mPyramidCount = 0;
+    return;
+  }
+  
+  int level = 0;
+  int blockSize = qcpPyramidBlockSize;
+  int blockCount = (count+blockSize-1)/blockSize;
+  while (true)
+  {
+    if (mMinPyramid.size() <= level)
+    {
+      mMinPyramid.append(QVector<double>());
+      mMaxPyramid.append(QVector<double>());
+    }
+    QVector<double> &mins = mMinPyramid[level];
+    QVector<double> &maxs = mMaxPyramid[level];
+    mins.resize(blockCount);
+    maxs.resize(blockCount);
+    for (int b=mPyramidCount/blockSize; b<blockCount; ++b)
+    {
+      // NaN values are skipped by only letting them through when the current extreme is NaN itself:
+      double blockMin, blockMax;
+      if (level == 0)
+      {
+        const int end = qMin((b+1)*blockSize, count);
+        blockMin = values[b*blockSize];
+        blockMax = blockMin;
+        for (int i=b*blockSize+1; i<end; ++i)
+        {
+          if (values[i] < blockMin || blockMin != blockMin)
+            blockMin = values[i];
+          if (values[i] > blockMax || blockMax != blockMax)
+            blockMax = values[i];
+        }
+      } else
+      {
+        const QVector<double> &childMins = mMinPyramid.at(level-1);
+        const QVector<double> &childMaxs = mMaxPyramid.at(level-1);
+        blockMin = childMins.at(2*b);
+        blockMax = childMaxs.at(2*b);
+        if (2*b+1 < childMins.size())
+        {
+          if (childMins.at(2*b+1) < blockMin || blockMin != blockMin)
+            blockMin = childMins.at(2*b+1);
+          if (childMaxs.at(2*b+1) > blockMax || blockMax != blockMax)
+            blockMax = childMaxs.at(2*b+1);
+        }
+      }
+      mins[b] = blockMin;
+      maxs[b] = blockMax;
+    }
+    if (blockCount == 1)
+      break;
+    ++level;
+    blockSize *= 2;
+    blockCount = (count+blockSize-1)/blockSize;
+  }
+  mMinPyramid.resize(level+1);
+  mMaxPyramid.resize(level+1);
+  mPyramidCount = count;
+}
+
+/*! \internal
+  
+  If a \ref capacity is set and the container holds more data points, drops the data points with
+  the smallest keys.
+*/
+void QCPDataContainer::enforceCapacity()
+{
+  if (mCapacity > 0 && size() > mCapacity)
+    removeIndexRange(0, size()-mCapacity);
+}
+
+/*! \internal
+  
+  Allocates the key error columns, initialized with zero errors for the existing data points.
+  
+  \see enableValueErrors
+*/
+void QCPDataContainer::enableKeyErrors()
+{
+  detachExternal();
+  mKeyErrorsMinus.fill(0, mKeys.size());
+  mKeyErrorsPlus.fill(0, mKeys.size());
+  mHasKeyErrors = true;
+}
+
+/*! \internal
+  
+  Allocates the value error columns, initialized with zero errors for the existing data points.
+  
+  \see enableKeyErrors
+*/
+void QCPDataContainer::enableValueErrors()
+{
+  detachExternal();
+  mValueErrorsMinus.fill(0, mKeys.size());
+  mValueErrorsPlus.fill(0, mKeys.size());
+  mHasValueErrors = true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPGraph
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -91,7 +1203,7 @@ QCPData::QCPData(double key, double value) :
 
   To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
   also access and modify the graph's data via the \ref data method, which returns a pointer to the
-  internal \ref QCPDataMap.
+  internal \ref QCPDataContainer.
   
   Graphs are used to display single-valued data. Single-valued means that there should only be one
   data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
@@ -117,9 +1229,9 @@ QCPData::QCPData(double key, double value) :
 
 /* start of documentation of inline functions */
 
-/*! \fn QCPDataMap *QCPGraph::data() const
+/*! \fn QCPDataContainer *QCPGraph::data() const
   
-  Returns a pointer to the internal data storage of type \ref QCPDataMap. You may use it to
+  Returns a pointer to the internal data storage of type \ref QCPDataContainer. You may use it to
   directly manipulate the data, which may be more convenient and faster than using the regular \ref
   setData or \ref addData methods, in certain situations.
 */
@@ -138,9 +1250,11 @@ QCPData::QCPData(double key, double value) :
   To directly create a graph inside a plot, you can also use the simpler QCustomPlot::addGraph function.
 */
 QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
-  QCPAbstractPlottable(keyAxis, valueAxis)
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mPlotDataCacheValid(false),
+  mPlotDataCacheHasScatter(false)
 {
-  mData = new QCPDataMap;
+  mData = new QCPDataContainer;
   
   setPen(QPen(Qt::blue, 0));
   setErrorPen(QPen(Qt::black));
@@ -169,18 +1283,39 @@ QCPGraph::~QCPGraph()
   significantly faster than copying for large datasets.
   
   Alternatively, you can also access and modify the graph's data via the \ref data method, which
-  returns a pointer to the internal \ref QCPDataMap.
+  returns a pointer to the internal \ref QCPDataContainer.
 */
-void QCPGraph::setData(QCPDataMap *data, bool copy)
+void QCPGraph::setData(QCPDataContainer *data, bool copy)
 {
   if (copy)
   {
-    *mData = *data;
+    mData->set(*data);
   } else
   {
     delete mData;
     mData = data;
+    mPlotDataCacheValid = false;
   }
+  markLayerDirty();
+}
+
+/*! \overload
+  
+  Replaces the current data with the data points in the map \a data.
+  
+  If \a copy is true, the map stays owned by the caller. If \a copy is false, the ownership of the
+  map is transferred to the graph and the map is deleted by this function.
+  
+  \deprecated The graph stores its data in a \ref QCPDataContainer, so the data points are always
+  copied into the container. Changes made to the map after this call don't affect the graph. Use
+  \ref setData(QCPDataContainer *data, bool copy) or \ref data instead.
+*/
+void QCPGraph::setData(QCPDataMap *data, bool copy)
+{
+  mData->set(data->values().toVector(), true);
+  if (!copy)
+    delete data;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -188,19 +1323,33 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
   Replaces the current data with the provided points in \a key and \a value pairs. The provided
   vectors should have equal length. Else, the number of added points will be the size of the
   smallest vector.
+  
+  If the keys in \a key are sorted ascending, the data is transferred without any sorting
+  overhead.
 */
 void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 {
-  mData->clear();
-  int n = key.size();
-  n = qMin(n, value.size());
-  QCPData newData;
-  for (int i=0; i<n; ++i)
-  {
-    newData.key = key[i];
-    newData.value = value[i];
-    mData->insertMulti(newData.key, newData);
-  }
+  mData->set(key, value);
+  markLayerDirty();
+}
+
+/*!
+  Makes the graph display the data in the external arrays \a key and \a value, each holding \a
+  size entries, without copying them. The keys must be sorted ascending.
+  
+  The graph doesn't take ownership of the arrays. They must stay valid as long as the graph
+  displays them, i.e. until other data is set or the data is cleared. If you change the contents
+  of the arrays, call \ref QCPDataContainer::markModified on \ref data before the next replot.
+  Adding data points to the graph while it references external arrays copies the arrays into the
+  graph's own storage first, see \ref QCPDataContainer::setExternal.
+  
+  This is useful for very large data sets that are already held in memory by the application,
+  since it avoids duplicating them.
+*/
+void QCPGraph::setExternalData(const double *key, const double *value, int size)
+{
+  mData->setExternal(key, value, size);
+  markLayerDirty();
 }
 
 /*!
@@ -214,19 +1363,22 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
-  QCPData newData;
+  QVector<QCPData> tempData(n);
+  bool sorted = true;
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.valueErrorMinus = valueError[i];
-    newData.valueErrorPlus = valueError[i];
-    mData->insertMulti(key[i], newData);
+    tempData[i].key = key[i];
+    tempData[i].value = value[i];
+    tempData[i].valueErrorMinus = valueError[i];
+    tempData[i].valueErrorPlus = valueError[i];
+    if (i > 0 && key[i] < key[i-1])
+      sorted = false;
   }
+  mData->set(tempData, sorted);
+  markLayerDirty();
 }
 
 /*!
@@ -240,20 +1392,23 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> tempData(n);
+  bool sorted = true;
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.valueErrorMinus = valueErrorMinus[i];
-    newData.valueErrorPlus = valueErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    tempData[i].key = key[i];
+    tempData[i].value = value[i];
+    tempData[i].valueErrorMinus = valueErrorMinus[i];
+    tempData[i].valueErrorPlus = valueErrorPlus[i];
+    if (i > 0 && key[i] < key[i-1])
+      sorted = false;
   }
+  mData->set(tempData, sorted);
+  markLayerDirty();
 }
 
 /*!
@@ -267,19 +1422,22 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, keyError.size());
-  QCPData newData;
+  QVector<QCPData> tempData(n);
+  bool sorted = true;
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyError[i];
-    newData.keyErrorPlus = keyError[i];
-    mData->insertMulti(key[i], newData);
+    tempData[i].key = key[i];
+    tempData[i].value = value[i];
+    tempData[i].keyErrorMinus = keyError[i];
+    tempData[i].keyErrorPlus = keyError[i];
+    if (i > 0 && key[i] < key[i-1])
+      sorted = false;
   }
+  mData->set(tempData, sorted);
+  markLayerDirty();
 }
 
 /*!
@@ -293,20 +1451,23 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> tempData(n);
+  bool sorted = true;
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyErrorMinus[i];
-    newData.keyErrorPlus = keyErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    tempData[i].key = key[i];
+    tempData[i].value = value[i];
+    tempData[i].keyErrorMinus = keyErrorMinus[i];
+    tempData[i].keyErrorPlus = keyErrorPlus[i];
+    if (i > 0 && key[i] < key[i-1])
+      sorted = false;
   }
+  mData->set(tempData, sorted);
+  markLayerDirty();
 }
 
 /*!
@@ -320,22 +1481,25 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError, const QVector<double> &valueError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
   n = qMin(n, keyError.size());
-  QCPData newData;
+  QVector<QCPData> tempData(n);
+  bool sorted = true;
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyError[i];
-    newData.keyErrorPlus = keyError[i];
-    newData.valueErrorMinus = valueError[i];
-    newData.valueErrorPlus = valueError[i];
-    mData->insertMulti(key[i], newData);
+    tempData[i].key = key[i];
+    tempData[i].value = value[i];
+    tempData[i].keyErrorMinus = keyError[i];
+    tempData[i].keyErrorPlus = keyError[i];
+    tempData[i].valueErrorMinus = valueError[i];
+    tempData[i].valueErrorPlus = valueError[i];
+    if (i > 0 && key[i] < key[i-1])
+      sorted = false;
   }
+  mData->set(tempData, sorted);
+  markLayerDirty();
 }
 
 /*!
@@ -349,24 +1513,27 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> tempData(n);
+  bool sorted = true;
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyErrorMinus[i];
-    newData.keyErrorPlus = keyErrorPlus[i];
-    newData.valueErrorMinus = valueErrorMinus[i];
-    newData.valueErrorPlus = valueErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    tempData[i].key = key[i];
+    tempData[i].value = value[i];
+    tempData[i].keyErrorMinus = keyErrorMinus[i];
+    tempData[i].keyErrorPlus = keyErrorPlus[i];
+    tempData[i].valueErrorMinus = valueErrorMinus[i];
+    tempData[i].valueErrorPlus = valueErrorPlus[i];
+    if (i > 0 && key[i] < key[i-1])
+      sorted = false;
   }
+  mData->set(tempData, sorted);
+  markLayerDirty();
 }
 
 
@@ -379,6 +1546,8 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 void QCPGraph::setLineStyle(LineStyle ls)
 {
   mLineStyle = ls;
+  mPlotDataCacheValid = false;
+  markLayerDirty();
 }
 
 /*!
@@ -390,6 +1559,7 @@ void QCPGraph::setLineStyle(LineStyle ls)
 void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
 {
   mScatterStyle = style;
+  markLayerDirty();
 }
 
 /*!
@@ -403,6 +1573,7 @@ void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
 void QCPGraph::setErrorType(ErrorType errorType)
 {
   mErrorType = errorType;
+  markLayerDirty();
 }
 
 /*!
@@ -412,6 +1583,7 @@ void QCPGraph::setErrorType(ErrorType errorType)
 void QCPGraph::setErrorPen(const QPen &pen)
 {
   mErrorPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -420,6 +1592,7 @@ void QCPGraph::setErrorPen(const QPen &pen)
 void QCPGraph::setErrorBarSize(double size)
 {
   mErrorBarSize = size;
+  markLayerDirty();
 }
 
 /*!
@@ -436,6 +1609,7 @@ void QCPGraph::setErrorBarSize(double size)
 void QCPGraph::setErrorBarSkipSymbol(bool enabled)
 {
   mErrorBarSkipSymbol = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -449,6 +1623,7 @@ void QCPGraph::setErrorBarSkipSymbol(bool enabled)
 */
 void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 {
+  markLayerDirty();
   // prevent setting channel target to this graph itself:
   if (targetGraph == this)
   {
@@ -501,68 +1676,68 @@ void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 void QCPGraph::setAdaptiveSampling(bool enabled)
 {
   mAdaptiveSampling = enabled;
+  mPlotDataCacheValid = false;
+  markLayerDirty();
 }
 
 /*!
   Adds the provided data points in \a dataMap to the current data.
   
+  Data points with keys that are already present replace the existing data points.
+  
   Alternatively, you can also access and modify the graph's data via the \ref data method, which
-  returns a pointer to the internal \ref QCPDataMap.
+  returns a pointer to the internal \ref QCPDataContainer.
   
   \see removeData
 */
 void QCPGraph::addData(const QCPDataMap &dataMap)
 {
-  mData->unite(dataMap);
+  mData->add(dataMap.values().toVector(), true);
 }
 
 /*! \overload
   Adds the provided single data point in \a data to the current data.
   
+  Data points with keys that are already present replace the existing data points.
+  
   Alternatively, you can also access and modify the graph's data via the \ref data method, which
-  returns a pointer to the internal \ref QCPDataMap.
+  returns a pointer to the internal \ref QCPDataContainer.
   
   \see removeData
 */
 void QCPGraph::addData(const QCPData &data)
 {
-  mData->insertMulti(data.key, data);
+  mData->add(data);
 }
 
 /*! \overload
   Adds the provided single data point as \a key and \a value pair to the current data.
   
+  Data points with keys that are already present replace the existing data points.
+  
   Alternatively, you can also access and modify the graph's data via the \ref data method, which
-  returns a pointer to the internal \ref QCPDataMap.
+  returns a pointer to the internal \ref QCPDataContainer.
   
   \see removeData
 */
 void QCPGraph::addData(double key, double value)
 {
-  QCPData newData;
-  newData.key = key;
-  newData.value = value;
-  mData->insertMulti(newData.key, newData);
+  mData->add(QCPData(key, value));
 }
 
 /*! \overload
   Adds the provided data points as \a key and \a value pairs to the current data.
   
+  Data points with keys that are already present replace the existing data points.
+  
   Alternatively, you can also access and modify the graph's data via the \ref data method, which
-  returns a pointer to the internal \ref QCPDataMap.
+  returns a pointer to the internal \ref QCPDataContainer.
   
   \see removeData
 */
 void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values)
 {
-  int n = qMin(keys.size(), values.size());
-  QCPData newData;
-  for (int i=0; i<n; ++i)
-  {
-    newData.key = keys[i];
-    newData.value = values[i];
-    mData->insertMulti(newData.key, newData);
-  }
+  mData->add(keys, values);
 }
 
 /*!
@@ -571,9 +1746,7 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
-  QCPDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->removeBefore(key);
 }
 
 /*!
@@ -582,10 +1755,7 @@ void QCPGraph::removeDataBefore(double key)
 */
 void QCPGraph::removeDataAfter(double key)
 {
-  if (mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->removeAfter(key);
 }
 
 /*!
@@ -597,11 +1767,7 @@ void QCPGraph::removeDataAfter(double key)
 */
 void QCPGraph::removeData(double fromKey, double toKey)
 {
-  if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(fromKey);
-  QCPDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->remove(fromKey, toKey);
 }
 
 /*! \overload
@@ -640,6 +1806,17 @@ double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
     return -1;
 }
 
+/*! \internal
+  
+  Appends the data revision of this graph and of its channel fill target graph (\ref
+  setChannelFillGraph), so a buffered layer is redrawn when data was added or removed.
+*/
+void QCPGraph::appendBufferState(QVector<double> &state) const
+{
+  state << mData->revision();
+  state << (mChannelFillGraph ? (double)mChannelFillGraph.data()->data()->revision() : -1.0);
+}
+
 /*! \overload
   
   Allows to define whether error bars are taken into consideration when determining the new axis
@@ -743,13 +1920,13 @@ void QCPGraph::draw(QCPPainter *painter)
   
   // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
-  QCPDataMap::const_iterator it;
-  for (it = mData->constBegin(); it != mData->constEnd(); ++it)
+  for (int i=0; i<mData->size(); ++i)
   {
-    if (QCP::isInvalidData(it.value().key, it.value().value) ||
-        QCP::isInvalidData(it.value().keyErrorPlus, it.value().keyErrorMinus) ||
-        QCP::isInvalidData(it.value().valueErrorPlus, it.value().valueErrorPlus))
-      qDebug() << Q_FUNC_INFO << "Data point at" << it.key() << "invalid." << "Plottable name:" << name();
+    QCPData current = mData->at(i);
+    if (QCP::isInvalidData(current.key, current.value) ||
+        QCP::isInvalidData(current.keyErrorPlus, current.keyErrorMinus) ||
+        QCP::isInvalidData(current.valueErrorPlus, current.valueErrorPlus))
+      qDebug() << Q_FUNC_INFO << "Data point at" << current.key << "invalid." << "Plottable name:" << name();
   }
 #endif
 
@@ -772,6 +1949,18 @@ void QCPGraph::draw(QCPPainter *painter)
     delete scatterData;
 }
 
+/* inherits documentation from base class */
+void QCPGraph::preparePlotData()
+{
+  if (!mKeyAxis || !mValueAxis) return;
+  if (mKeyAxis.data()->range().size() <= 0 || mData->isEmpty()) return;
+  if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
+  
+  // fill the plot data cache, so draw only needs to paint:
+  QVector<QCPData> scatterData;
+  getPlotData(0, mScatterStyle.isNone() ? 0 : &scatterData);
+}
+
 /* inherits documentation from base class */
 void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
@@ -815,27 +2004,95 @@ void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
   \a lineData will be filled with raw points that will be drawn with the according draw functions,
   e.g. \ref drawLinePlot and \ref drawImpulsePlot. These aren't necessarily the original data
   points, since for step plots for example, additional points are needed for drawing lines that
-  make up steps. If the line style of the graph is \ref lsNone, the \a lineData vector will be left
-  untouched.
+  make up steps. If the line style of the graph is \ref lsNone, the \a lineData vector will be
+  empty.
   
   \a scatterData will be filled with the original data points so \ref drawScatterPlot can draw the
   scatter symbols accordingly. If no scatters need to be drawn, i.e. the scatter style's shape is
   \ref QCPScatterStyle::ssNone, pass 0 as \a scatterData, and this step will be skipped.
   
+  The result is cached and reused by subsequent calls, as long as the data revision, the axes
+  (range, pixel geometry and scale type), the line style and the adaptive sampling setting stay
+  the same (see \ref plotDataCacheKey). So replots that don't affect this graph, hit tests via
+  \ref selectTest and channel fills referencing this graph don't need to process the data again.
+  
   \see getScatterPlotData, getLinePlotData, getStepLeftPlotData, getStepRightPlotData,
   getStepCenterPlotData, getImpulsePlotData
 */
 void QCPGraph::getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *scatterData) const
 {
-  switch(mLineStyle)
+  PlotDataCacheKey key = plotDataCacheKey();
+  if (!mPlotDataCacheValid || !(key == mCachedPlotDataKey) || (scatterData && !mPlotDataCacheHasScatter))
   {
-    case lsNone: getScatterPlotData(scatterData); break;
-    case lsLine: getLinePlotData(lineData, scatterData); break;
-    case lsStepLeft: getStepLeftPlotData(lineData, scatterData); break;
-    case lsStepRight: getStepRightPlotData(lineData, scatterData); break;
-    case lsStepCenter: getStepCenterPlotData(lineData, scatterData); break;
-    case lsImpulse: getImpulsePlotData(lineData, scatterData); break;
+    mCachedLineData.clear();
+    mCachedScatterData.clear();
+    QVector<QCPData> *cachedScatterData = scatterData ? &mCachedScatterData : 0;
+    switch(mLineStyle)
+    {
+      case lsNone: getScatterPlotData(cachedScatterData); break;
+      case lsLine: getLinePlotData(&mCachedLineData, cachedScatterData); break;
+      case lsStepLeft: getStepLeftPlotData(&mCachedLineData, cachedScatterData); break;
+      case lsStepRight: getStepRightPlotData(&mCachedLineData, cachedScatterData); break;
+      case lsStepCenter: getStepCenterPlotData(&mCachedLineData, cachedScatterData); break;
+      case lsImpulse: getImpulsePlotData(&mCachedLineData, cachedScatterData); break;
+    }
+    mCachedPlotDataKey = key;
+    mPlotDataCacheValid = true;
+    mPlotDataCacheHasScatter = scatterData != 0;
   }
+  if (lineData)
+    *lineData = mCachedLineData;
+  if (scatterData)
+    *scatterData = mCachedScatterData;
+}
+
+/*! \internal
+  
+  Returns the state that the plot data returned by \ref getPlotData depends on, apart from the
+  graph's own properties: the data revision (see \ref QCPDataContainer::revision) and the range,
+  pixel geometry and scale of both axes. If the returned key differs from the one stored with the
+  cached plot data, the cache is outdated.
+*/
+QCPGraph::PlotDataCacheKey QCPGraph::plotDataCacheKey() const
+{
+  PlotDataCacheKey key;
+  key.data = mData;
+  key.dataRevision = mData->revision();
+  key.keyAxis = mKeyAxis.data();
+  key.valueAxis = mValueAxis.data();
+  key.keyRange = key.keyAxis ? key.keyAxis->range() : QCPRange();
+  key.valueRange = key.valueAxis ? key.valueAxis->range() : QCPRange();
+  key.keyAxisRect = key.keyAxis ? key.keyAxis->axisRect()->rect() : QRect();
+  key.valueAxisRect = key.valueAxis ? key.valueAxis->axisRect()->rect() : QRect();
+  key.keyRangeReversed = key.keyAxis ? key.keyAxis->rangeReversed() : false;
+  key.valueRangeReversed = key.valueAxis ? key.valueAxis->rangeReversed() : false;
+  key.keyScaleType = key.keyAxis ? key.keyAxis->scaleType() : QCPAxis::stLinear;
+  key.valueScaleType = key.valueAxis ? key.valueAxis->scaleType() : QCPAxis::stLinear;
+  key.keyScaleLogBase = key.keyAxis ? key.keyAxis->scaleLogBase() : 0;
+  key.valueScaleLogBase = key.valueAxis ? key.valueAxis->scaleLogBase() : 0;
+  return key;
+}
+
+/*! \internal
+  
+  Returns whether all members of this cache key are equal to the ones of \a other.
+*/
+bool QCPGraph::PlotDataCacheKey::operator==(const PlotDataCacheKey &other) const
+{
+  return data == other.data &&
+      dataRevision == other.dataRevision &&
+      keyAxis == other.keyAxis &&
+      valueAxis == other.valueAxis &&
+      keyRange == other.keyRange &&
+      valueRange == other.valueRange &&
+      keyAxisRect == other.keyAxisRect &&
+      valueAxisRect == other.valueAxisRect &&
+      keyRangeReversed == other.keyRangeReversed &&
+      valueRangeReversed == other.valueRangeReversed &&
+      keyScaleType == other.keyScaleType &&
+      valueScaleType == other.valueScaleType &&
+      keyScaleLogBase == other.keyScaleLogBase &&
+      valueScaleLogBase == other.valueScaleLogBase;
 }
 
 /*! \internal
@@ -1266,6 +2523,28 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData)
   }
 }
 
+/*! \internal
+  
+  Returns the index of the first key in \a keys between \a from and (excluding) \a to which is
+  equal to or larger than \a key, or \a to if there is none. The keys must be sorted ascending.
+  
+  The search gallops forward from \a from before narrowing down with a binary search, so it takes
+  O(log k) where k is the distance of the result from \a from. This makes it suitable for stepping
+  through consecutive pixel intervals of adaptive sampling, which usually contain few points.
+*/
+static int qcpGallopLowerBound(const double *keys, int from, int to, double key)
+{
+  int step = 1;
+  int lower = from;
+  while (lower+step < to && keys[lower+step-1] < key)
+  {
+    lower += step;
+    step *= 2;
+  }
+  const double *upper = keys+qMin(lower+step, to);
+  return std::lower_bound(keys+lower, upper, key)-keys;
+}
+
 /*! \internal
   
   Returns the \a lineData and \a scatterData that need to be plotted for this graph taking into
@@ -1284,109 +2563,95 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   // get visible data range:
-  QCPDataMap::const_iterator lower, upper; // note that upper is the actual upper point, and not 1 step after the upper point
-  getVisibleDataBounds(lower, upper);
-  if (lower == mData->constEnd() || upper == mData->constEnd())
+  int begin, end; // indices of the first data point and one past the last data point that need to be processed
+  getVisibleDataBounds(begin, end);
+  if (begin == end)
     return;
   
-  // count points in visible range, taking into account that we only need to count to the limit maxCount if using adaptive sampling:
+  // determine maximum point count that is drawn without adaptive sampling:
   int maxCount = std::numeric_limits<int>::max();
   if (mAdaptiveSampling)
   {
-    int keyPixelSpan = qAbs(keyAxis->coordToPixel(lower.key())-keyAxis->coordToPixel(upper.key()));
+    int keyPixelSpan = qAbs(keyAxis->coordToPixel(mData->key(begin))-keyAxis->coordToPixel(mData->key(end-1)));
     maxCount = 2*keyPixelSpan+2;
   }
-  int dataCount = countDataInBounds(lower, upper, maxCount);
+  int dataCount = end-begin;
   
   if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
   {
     if (lineData)
     {
-      QCPDataMap::const_iterator it = lower;
-      QCPDataMap::const_iterator upperEnd = upper+1;
-      double minValue = it.value().value;
-      double maxValue = it.value().value;
-      QCPDataMap::const_iterator currentIntervalFirstPoint = it;
+      const double *keys = mData->keyData();
+      double minValue, maxValue;
+      int currentIntervalFirstPoint = begin;
       int reversedFactor = keyAxis->rangeReversed() ? -1 : 1; // is used to calculate keyEpsilon pixel into the correct direction
       int reversedRound = keyAxis->rangeReversed() ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())+reversedRound));
+      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(keys[begin])+reversedRound));
       double lastIntervalEndKey = currentIntervalStartKey;
       double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
       bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-      int intervalDataCount = 1;
-      ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
-      while (it != upperEnd)
+      // find end of pixel interval, i.e. the first point after the interval's first point which lies outside the pixel:
+      int it = qcpGallopLowerBound(keys, currentIntervalFirstPoint+1, end, currentIntervalStartKey+keyEpsilon);
+      while (it != end)
       {
-        if (it.key() < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
-        {
-          if (it.value().value < minValue)
-            minValue = it.value().value;
-          else if (it.value().value > maxValue)
-            maxValue = it.value().value;
-          ++intervalDataCount;
-        } else // new pixel interval started
+        if (it-currentIntervalFirstPoint >= 2) // pixel has multiple data points, consolidate them to a cluster
         {
-          if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-          {
-            if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-              lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint.value().value));
-            lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-            lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-            if (it.key() > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-              lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.8, (it-1).value().value));
-          } else
-            lineData->append(QCPData(currentIntervalFirstPoint.key(), currentIntervalFirstPoint.value().value));
-          lastIntervalEndKey = (it-1).value().key;
-          minValue = it.value().value;
-          maxValue = it.value().value;
-          currentIntervalFirstPoint = it;
-          currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())+reversedRound));
-          if (keyEpsilonVariable)
-            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-          intervalDataCount = 1;
-        }
-        ++it;
+          mData->valueMinMax(currentIntervalFirstPoint, it, minValue, maxValue);
+          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+            lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.2, mData->value(currentIntervalFirstPoint)));
+          lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+          lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+          if (keys[it] > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
+            lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.8, mData->value(it-1)));
+        } else
+          lineData->append(QCPData(keys[currentIntervalFirstPoint], mData->value(currentIntervalFirstPoint)));
+        lastIntervalEndKey = keys[it-1];
+        currentIntervalFirstPoint = it;
+        currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(keys[it])+reversedRound));
+        if (keyEpsilonVariable)
+          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+        it = qcpGallopLowerBound(keys, currentIntervalFirstPoint+1, end, currentIntervalStartKey+keyEpsilon);
       }
       // handle last interval:
-      if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+      if (end-currentIntervalFirstPoint >= 2) // last pixel had multiple data points, consolidate them to a cluster
       {
+        mData->valueMinMax(currentIntervalFirstPoint, end, minValue, maxValue);
         if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
-          lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint.value().value));
+          lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.2, mData->value(currentIntervalFirstPoint)));
         lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
         lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
       } else
-        lineData->append(QCPData(currentIntervalFirstPoint.key(), currentIntervalFirstPoint.value().value));
+        lineData->append(QCPData(keys[currentIntervalFirstPoint], mData->value(currentIntervalFirstPoint)));
     }
     
     if (scatterData)
     {
       double valueMaxRange = valueAxis->range().upper;
       double valueMinRange = valueAxis->range().lower;
-      QCPDataMap::const_iterator it = lower;
-      QCPDataMap::const_iterator upperEnd = upper+1;
-      double minValue = it.value().value;
-      double maxValue = it.value().value;
-      QCPDataMap::const_iterator minValueIt = it;
-      QCPDataMap::const_iterator maxValueIt = it;
-      QCPDataMap::const_iterator currentIntervalStart = it;
+      int it = begin;
+      double minValue = mData->value(it);
+      double maxValue = mData->value(it);
+      int minValueIt = it;
+      int maxValueIt = it;
+      int currentIntervalStart = it;
       int reversedFactor = keyAxis->rangeReversed() ? -1 : 1; // is used to calculate keyEpsilon pixel into the correct direction
       int reversedRound = keyAxis->rangeReversed() ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())+reversedRound));
+      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(mData->key(begin))+reversedRound));
       double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
       bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
       int intervalDataCount = 1;
-      ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
-      while (it != upperEnd)
+      ++it; // advance index to second data point because adaptive sampling works in 1 point retrospect
+      while (it != end)
       {
-        if (it.key() < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this pixel if necessary
+        if (mData->key(it) < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this pixel if necessary
         {
-          if (it.value().value < minValue && it.value().value > valueMinRange && it.value().value < valueMaxRange)
+          if (mData->value(it) < minValue && mData->value(it) > valueMinRange && mData->value(it) < valueMaxRange)
           {
-            minValue = it.value().value;
+            minValue = mData->value(it);
             minValueIt = it;
-          } else if (it.value().value > maxValue && it.value().value > valueMinRange && it.value().value < valueMaxRange)
+          } else if (mData->value(it) > maxValue && mData->value(it) > valueMinRange && mData->value(it) < valueMaxRange)
           {
-            maxValue = it.value().value;
+            maxValue = mData->value(it);
             maxValueIt = it;
           }
           ++intervalDataCount;
@@ -1397,21 +2662,21 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
             // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
             double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
             int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
-            QCPDataMap::const_iterator intervalIt = currentIntervalStart;
+            int intervalIt = currentIntervalStart;
             int c = 0;
             while (intervalIt != it)
             {
-              if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && intervalIt.value().value > valueMinRange && intervalIt.value().value < valueMaxRange)
-                scatterData->append(intervalIt.value());
+              if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && mData->value(intervalIt) > valueMinRange && mData->value(intervalIt) < valueMaxRange)
+                scatterData->append(mData->at(intervalIt));
               ++c;
               ++intervalIt;
             }
-          } else if (currentIntervalStart.value().value > valueMinRange && currentIntervalStart.value().value < valueMaxRange)
-            scatterData->append(currentIntervalStart.value());
-          minValue = it.value().value;
-          maxValue = it.value().value;
+          } else if (mData->value(currentIntervalStart) > valueMinRange && mData->value(currentIntervalStart) < valueMaxRange)
+            scatterData->append(mData->at(currentIntervalStart));
+          minValue = mData->value(it);
+          maxValue = mData->value(it);
           currentIntervalStart = it;
-          currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())+reversedRound));
+          currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(mData->key(it))+reversedRound));
           if (keyEpsilonVariable)
             keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
           intervalDataCount = 1;
@@ -1424,19 +2689,19 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
         // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
         double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
         int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
-        QCPDataMap::const_iterator intervalIt = currentIntervalStart;
+        int intervalIt = currentIntervalStart;
         int c = 0;
         while (intervalIt != it)
         {
-          if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && intervalIt.value().value > valueMinRange && intervalIt.value().value < valueMaxRange)
-            scatterData->append(intervalIt.value());
+          if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && mData->value(intervalIt) > valueMinRange && mData->value(intervalIt) < valueMaxRange)
+            scatterData->append(mData->at(intervalIt));
           ++c;
           ++intervalIt;
         }
-      } else if (currentIntervalStart.value().value > valueMinRange && currentIntervalStart.value().value < valueMaxRange)
-        scatterData->append(currentIntervalStart.value());
+      } else if (mData->value(currentIntervalStart) > valueMinRange && mData->value(currentIntervalStart) < valueMaxRange)
+        scatterData->append(mData->at(currentIntervalStart));
     }
-  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the map into the output parameters
+  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output parameters
   {
     QVector<QCPData> *dataVector = 0;
     if (lineData)
@@ -1445,14 +2710,9 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
       dataVector = scatterData;
     if (dataVector)
     {
-      QCPDataMap::const_iterator it = lower;
-      QCPDataMap::const_iterator upperEnd = upper+1;
       dataVector->reserve(dataCount+2); // +2 for possible fill end points
-      while (it != upperEnd)
-      {
-        dataVector->append(it.value());
-        ++it;
-      }
+      for (int it=begin; it<end; ++it)
+        dataVector->append(mData->at(it));
     }
     if (lineData && scatterData)
       *scatterData = *dataVector;
@@ -1566,57 +2826,32 @@ void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData
   called by \ref getPreparedData to determine which data (key) range is visible at the current key
   axis range setting, so only that needs to be processed.
   
-  \a lower returns an iterator to the lowest data point that needs to be taken into account when
+  \a begin returns the index of the lowest data point that needs to be taken into account when
   plotting. Note that in order to get a clean plot all the way to the edge of the axis rect, \a
-  lower may still be just outside the visible range.
+  begin may still be just outside the visible range.
   
-  \a upper returns an iterator to the highest data point. Same as before, \a upper may also lie
-  just outside of the visible range.
+  \a end returns the index one past the highest data point that needs to be taken into account.
+  Same as before, the data point at \a end-1 may also lie just outside of the visible range.
   
-  if the graph contains no data, both \a lower and \a upper point to constEnd.
+  Since the data container is sorted by key, both bounds are found with a binary search. If the
+  graph contains no data, both \a begin and \a end are 0.
 */
-void QCPGraph::getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper) const
+void QCPGraph::getVisibleDataBounds(int &begin, int &end) const
 {
+  begin = 0;
+  end = 0;
   if (!mKeyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
   if (mData->isEmpty())
-  {
-    lower = mData->constEnd();
-    upper = mData->constEnd();
     return;
-  }
-  
-  // get visible data range as QMap iterators
-  QCPDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis.data()->range().lower);
-  QCPDataMap::const_iterator ubound = mData->upperBound(mKeyAxis.data()->range().upper);
-  bool lowoutlier = lbound != mData->constBegin(); // indicates whether there exist points below axis range
-  bool highoutlier = ubound != mData->constEnd(); // indicates whether there exist points above axis range
   
-  lower = (lowoutlier ? lbound-1 : lbound); // data point range that will be actually drawn
-  upper = (highoutlier ? ubound : ubound-1); // data point range that will be actually drawn
-}
-
-/*!  \internal
-  
-  Counts the number of data points between \a lower and \a upper (including them), up to a maximum
-  of \a maxCount.
+  // get visible data range as indices into the data container:
+  int lbound = mData->findBegin(mKeyAxis.data()->range().lower);
+  int ubound = mData->findEnd(mKeyAxis.data()->range().upper);
+  bool lowoutlier = lbound > 0; // indicates whether there exist points below axis range
+  bool highoutlier = ubound < mData->size(); // indicates whether there exist points above axis range
   
-  This function is used by \ref getPreparedData to determine whether adaptive sampling shall be
-  used (if enabled via \ref setAdaptiveSampling) or not. This is also why counting of data points
-  only needs to be done until \a maxCount is reached, which should be set to the number of data
-  points at which adaptive sampling sets in.
-*/
-int QCPGraph::countDataInBounds(const QCPDataMap::const_iterator &lower, const QCPDataMap::const_iterator &upper, int maxCount) const
-{
-  if (upper == mData->constEnd() && lower == mData->constEnd())
-    return 0;
-  QCPDataMap::const_iterator it = lower;
-  int count = 1;
-  while (it != upper && count < maxCount)
-  {
-    ++it;
-    ++count;
-  }
-  return count;
+  begin = (lowoutlier ? lbound-1 : lbound); // data point range that will be actually drawn
+  end = (highoutlier ? ubound+1 : ubound); // data point range that will be actually drawn
 }
 
 /*! \internal
@@ -2020,7 +3255,7 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint) const
   }
   if (mData->size() == 1)
   {
-    QPointF dataPoint = coordsToPixels(mData->constBegin().key(), mData->constBegin().value().value);
+    QPointF dataPoint = coordsToPixels(mData->key(0), mData->value(0));
     return QVector2D(dataPoint-pixelPoint).length();
   }
   
@@ -2032,7 +3267,7 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint) const
   {
     // no line displayed, only calculate distance to scatter points:
     QVector<QCPData> *scatterData = new QVector<QCPData>;
-    getScatterPlotData(scatterData);
+    getPlotData(0, scatterData);
     double minDistSqr = std::numeric_limits<double>::max();
     QPointF ptA;
     QPointF ptB = coordsToPixels(scatterData->at(0).key, scatterData->at(0).value); // getScatterPlotData returns in plot coordinates, so transform to pixels
@@ -2129,14 +3364,22 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
   
   double current, currentErrorMinus, currentErrorPlus;
   
-  if (inSignDomain == sdBoth) // range may be anywhere
+  if (inSignDomain == sdBoth && (!includeErrors || !mData->hasKeyErrors())) // data is sorted by key, so first and last data point span the key range
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    if (!mData->isEmpty())
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
+      range.lower = mData->key(0);
+      range.upper = mData->key(mData->size()-1);
+      haveLower = true;
+      haveUpper = true;
+    }
+  } else if (inSignDomain == sdBoth) // range may be anywhere
+  {
+    for (int i=0; i<mData->size(); ++i)
+    {
+      current = mData->key(i);
+      currentErrorMinus = (includeErrors ? mData->keyErrorMinus(i) : 0);
+      currentErrorPlus = (includeErrors ? mData->keyErrorPlus(i) : 0);
       if (current-currentErrorMinus < range.lower || !haveLower)
       {
         range.lower = current-currentErrorMinus;
@@ -2147,16 +3390,14 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
         range.upper = current+currentErrorPlus;
         haveUpper = true;
       }
-      ++it;
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=0; i<mData->size(); ++i)
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
+      current = mData->key(i);
+      currentErrorMinus = (includeErrors ? mData->keyErrorMinus(i) : 0);
+      currentErrorPlus = (includeErrors ? mData->keyErrorPlus(i) : 0);
       if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus < 0)
       {
         range.lower = current-currentErrorMinus;
@@ -2180,16 +3421,14 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
           haveUpper = true;
         }
       }
-      ++it;
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=0; i<mData->size(); ++i)
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
+      current = mData->key(i);
+      currentErrorMinus = (includeErrors ? mData->keyErrorMinus(i) : 0);
+      currentErrorPlus = (includeErrors ? mData->keyErrorPlus(i) : 0);
       if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus > 0)
       {
         range.lower = current-currentErrorMinus;
@@ -2213,7 +3452,6 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
           haveUpper = true;
         }
       }
-      ++it;
     }
   }
   
@@ -2235,14 +3473,31 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
   
   double current, currentErrorMinus, currentErrorPlus;
   
-  if (inSignDomain == sdBoth) // range may be anywhere
+  if (inSignDomain == sdBoth && (!includeErrors || !mData->hasValueErrors())) // only values contribute, so scan the value column alone
+  {
+    const int n = mData->size();
+    if (n > 0)
+    {
+      const double *values = mData->valueData();
+      double lower = values[0];
+      double upper = values[0];
+      for (int i=1; i<n; ++i)
+      {
+        lower = values[i] < lower ? values[i] : lower;
+        upper = values[i] > upper ? values[i] : upper;
+      }
+      range.lower = lower;
+      range.upper = upper;
+      haveLower = true;
+      haveUpper = true;
+    }
+  } else if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=0; i<mData->size(); ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
+      current = mData->value(i);
+      currentErrorMinus = (includeErrors ? mData->valueErrorMinus(i) : 0);
+      currentErrorPlus = (includeErrors ? mData->valueErrorPlus(i) : 0);
       if (current-currentErrorMinus < range.lower || !haveLower)
       {
         range.lower = current-currentErrorMinus;
@@ -2253,16 +3508,14 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
         range.upper = current+currentErrorPlus;
         haveUpper = true;
       }
-      ++it;
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=0; i<mData->size(); ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
+      current = mData->value(i);
+      currentErrorMinus = (includeErrors ? mData->valueErrorMinus(i) : 0);
+      currentErrorPlus = (includeErrors ? mData->valueErrorPlus(i) : 0);
       if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus < 0)
       {
         range.lower = current-currentErrorMinus;
@@ -2286,16 +3539,14 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
           haveUpper = true;
         }
       }
-      ++it;
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=0; i<mData->size(); ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
+      current = mData->value(i);
+      currentErrorMinus = (includeErrors ? mData->valueErrorMinus(i) : 0);
+      currentErrorPlus = (includeErrors ? mData->valueErrorPlus(i) : 0);
       if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus > 0)
       {
         range.lower = current-currentErrorMinus;
@@ -2319,7 +3570,6 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
           haveUpper = true;
         }
       }
-      ++it;
     }
   }
   
@@ -46,17 +46,93 @@ public:
 Q_DECLARE_TYPEINFO(QCPData, Q_MOVABLE_TYPE);
 
 /*! \typedef QCPDataMap
-  Container for storing QCPData items in a sorted fashion. The key of the map
-  is the key member of the QCPData instance.
+  Map based container for storing QCPData items in a sorted fashion. The key of the map is the key
+  member of the QCPData instance.
   
-  This is the container in which QCPGraph holds its data.
-  \see QCPData, QCPGraph::setData
+  QCPGraph holds its data in a \ref QCPDataContainer. This map type is still accepted by \ref
+  QCPGraph::setData and \ref QCPGraph::addData for convenience.
+  \see QCPData, QCPDataContainer
 */
 typedef QMap<double, QCPData> QCPDataMap;
 typedef QMapIterator<double, QCPData> QCPDataMapIterator;
 typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
 
 
+class QCP_LIB_DECL QCPDataContainer
+{
+public:
+  QCPDataContainer();
+  
+  // getters:
+  int size() const { return mExternalKeys ? mExternalSize : mKeys.size()-mBegin; }
+  bool isEmpty() const { return size() == 0; }
+  bool isExternal() const { return mExternalKeys != 0; }
+  quint64 revision() const { return mRevision; }
+  int capacity() const { return mCapacity; }
+  bool hasKeyErrors() const { return mHasKeyErrors; }
+  bool hasValueErrors() const { return mHasValueErrors; }
+  QCPData at(int index) const;
+  double key(int index) const { return mExternalKeys ? mExternalKeys[index] : mKeys.at(mBegin+index); }
+  double value(int index) const { return mExternalKeys ? mExternalValues[index] : mValues.at(mBegin+index); }
+  double keyErrorMinus(int index) const { return mHasKeyErrors ? mKeyErrorsMinus.at(mBegin+index) : 0; }
+  double keyErrorPlus(int index) const { return mHasKeyErrors ? mKeyErrorsPlus.at(mBegin+index) : 0; }
+  double valueErrorMinus(int index) const { return mHasValueErrors ? mValueErrorsMinus.at(mBegin+index) : 0; }
+  double valueErrorPlus(int index) const { return mHasValueErrors ? mValueErrorsPlus.at(mBegin+index) : 0; }
+  const double *keyData() const { return mExternalKeys ? mExternalKeys : mKeys.constData()+mBegin; }
+  const double *valueData() const { return mExternalKeys ? mExternalValues : mValues.constData()+mBegin; }
+  
+  // setters:
+  void set(const QCPDataContainer &data);
+  void set(const QVector<QCPData> &data, bool alreadySorted=false);
+  void set(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void setExternal(const double *keys, const double *values, int size);
+  void setCapacity(int capacity);
+  
+  // non-property methods:
+  void add(const QCPDataContainer &data);
+  void add(const QVector<QCPData> &data, bool alreadySorted=false);
+  void add(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void add(const QCPData &data);
+  void removeBefore(double key);
+  void removeAfter(double key);
+  void remove(double keyFrom, double keyTo);
+  void remove(double key);
+  void clear();
+  void squeeze();
+  void reserve(int n);
+  int findBegin(double key) const;
+  int findEnd(double key) const;
+  void valueMinMax(int begin, int end, double &minValue, double &maxValue) const;
+  void markModified();
+  
+protected:
+  // non-property members:
+  QVector<double> mKeys, mValues;
+  QVector<double> mKeyErrorsMinus, mKeyErrorsPlus;
+  QVector<double> mValueErrorsMinus, mValueErrorsPlus;
+  bool mHasKeyErrors, mHasValueErrors;
+  int mBegin, mCapacity;
+  const double *mExternalKeys, *mExternalValues;
+  int mExternalSize;
+  quint64 mRevision;
+  mutable QVector<QVector<double> > mMinPyramid, mMaxPyramid;
+  mutable int mPyramidCount;
+  
+  // non-virtual methods:
+  void detachExternal();
+  void compact();
+  void enforceCapacity();
+  void invalidatePyramid(int index);
+  void updatePyramid() const;
+  void addSorted(const QVector<QCPData> &data);
+  void replaceAt(int index, const QCPData &data);
+  void removeDuplicateKeys(int begin);
+  void removeIndexRange(int begin, int end);
+  void enableKeyErrors();
+  void enableValueErrors();
+};
+
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
 {
   Q_OBJECT
@@ -99,7 +175,7 @@ public:
   virtual ~QCPGraph();
   
   // getters:
-  QCPDataMap *data() const { return mData; }
+  QCPDataContainer *data() const { return mData; }
   LineStyle lineStyle() const { return mLineStyle; }
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   ErrorType errorType() const { return mErrorType; }
@@ -110,8 +186,10 @@ public:
   bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
+  void setData(QCPDataContainer *data, bool copy=false);
   void setData(QCPDataMap *data, bool copy=false);
   void setData(const QVector<double> &key, const QVector<double> &value);
+  void setExternalData(const double *key, const double *value, int size);
   void setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError);
   void setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus);
   void setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError);
@@ -148,8 +226,21 @@ public:
   void rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const; // overloads base class interface
   
 protected:
+  struct PlotDataCacheKey
+  {
+    const QCPDataContainer *data;
+    quint64 dataRevision;
+    QCPAxis *keyAxis, *valueAxis;
+    QCPRange keyRange, valueRange;
+    QRect keyAxisRect, valueAxisRect;
+    bool keyRangeReversed, valueRangeReversed;
+    QCPAxis::ScaleType keyScaleType, valueScaleType;
+    double keyScaleLogBase, valueScaleLogBase;
+    bool operator==(const PlotDataCacheKey &other) const;
+  };
+  
   // property members:
-  QCPDataMap *mData;
+  QCPDataContainer *mData;
   QPen mErrorPen;
   LineStyle mLineStyle;
   QCPScatterStyle mScatterStyle;
@@ -159,6 +250,12 @@ protected:
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
   
+  // non-property members:
+  mutable QVector<QPointF> mCachedLineData;
+  mutable QVector<QCPData> mCachedScatterData;
+  mutable PlotDataCacheKey mCachedPlotDataKey;
+  mutable bool mPlotDataCacheValid, mPlotDataCacheHasScatter;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
@@ -166,6 +263,8 @@ protected:
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
   virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const; // overloads base class interface
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const; // overloads base class interface
+  virtual void preparePlotData();
+  virtual void appendBufferState(QVector<double> &state) const;
   
   // introduced virtual methods:
   virtual void drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const;
@@ -176,6 +275,7 @@ protected:
   // non-virtual methods:
   void getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *scatterData) const;
   void getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *scatterData) const;
+  PlotDataCacheKey plotDataCacheKey() const;
   void getScatterPlotData(QVector<QCPData> *scatterData) const;
   void getLinePlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
   void getStepLeftPlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
@@ -183,8 +283,7 @@ protected:
   void getStepCenterPlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
   void getImpulsePlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
   void drawError(QCPPainter *painter, double x, double y, const QCPData &data) const;
-  void getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper) const;
-  int countDataInBounds(const QCPDataMap::const_iterator &lower, const QCPDataMap::const_iterator &upper, int maxCount) const;
+  void getVisibleDataBounds(int &begin, int &end) const;
   void addFillBasePoints(QVector<QPointF> *lineData) const;
   void removeFillBasePoints(QVector<QPointF> *lineData) const;
   QPointF lowerFillBasePoint(double lowerKey) const;
@@ -123,6 +123,7 @@ QCPStatisticalBox::QCPStatisticalBox(QCPAxis *keyAxis, QCPAxis *valueAxis) :
 void QCPStatisticalBox::setKey(double key)
 {
   mKey = key;
+  markLayerDirty();
 }
 
 /*!
@@ -134,6 +135,7 @@ void QCPStatisticalBox::setKey(double key)
 void QCPStatisticalBox::setMinimum(double value)
 {
   mMinimum = value;
+  markLayerDirty();
 }
 
 /*!
@@ -146,6 +148,7 @@ void QCPStatisticalBox::setMinimum(double value)
 void QCPStatisticalBox::setLowerQuartile(double value)
 {
   mLowerQuartile = value;
+  markLayerDirty();
 }
 
 /*!
@@ -158,6 +161,7 @@ void QCPStatisticalBox::setLowerQuartile(double value)
 void QCPStatisticalBox::setMedian(double value)
 {
   mMedian = value;
+  markLayerDirty();
 }
 
 /*!
@@ -170,6 +174,7 @@ void QCPStatisticalBox::setMedian(double value)
 void QCPStatisticalBox::setUpperQuartile(double value)
 {
   mUpperQuartile = value;
+  markLayerDirty();
 }
 
 /*!
@@ -181,6 +186,7 @@ void QCPStatisticalBox::setUpperQuartile(double value)
 void QCPStatisticalBox::setMaximum(double value)
 {
   mMaximum = value;
+  markLayerDirty();
 }
 
 /*!
@@ -193,6 +199,7 @@ void QCPStatisticalBox::setMaximum(double value)
 void QCPStatisticalBox::setOutliers(const QVector<double> &values)
 {
   mOutliers = values;
+  markLayerDirty();
 }
 
 /*!
@@ -208,6 +215,7 @@ void QCPStatisticalBox::setData(double key, double minimum, double lowerQuartile
   setMedian(median);
   setUpperQuartile(upperQuartile);
   setMaximum(maximum);
+  markLayerDirty();
 }
 
 /*!
@@ -218,6 +226,7 @@ void QCPStatisticalBox::setData(double key, double minimum, double lowerQuartile
 void QCPStatisticalBox::setWidth(double width)
 {
   mWidth = width;
+  markLayerDirty();
 }
 
 /*!
@@ -228,6 +237,7 @@ void QCPStatisticalBox::setWidth(double width)
 void QCPStatisticalBox::setWhiskerWidth(double width)
 {
   mWhiskerWidth = width;
+  markLayerDirty();
 }
 
 /*!
@@ -241,6 +251,7 @@ void QCPStatisticalBox::setWhiskerWidth(double width)
 void QCPStatisticalBox::setWhiskerPen(const QPen &pen)
 {
   mWhiskerPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -252,6 +263,7 @@ void QCPStatisticalBox::setWhiskerPen(const QPen &pen)
 void QCPStatisticalBox::setWhiskerBarPen(const QPen &pen)
 {
   mWhiskerBarPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -260,6 +272,7 @@ void QCPStatisticalBox::setWhiskerBarPen(const QPen &pen)
 void QCPStatisticalBox::setMedianPen(const QPen &pen)
 {
   mMedianPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -270,6 +283,7 @@ void QCPStatisticalBox::setMedianPen(const QPen &pen)
 void QCPStatisticalBox::setOutlierStyle(const QCPScatterStyle &style)
 {
   mOutlierStyle = style;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
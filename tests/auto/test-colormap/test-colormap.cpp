@@ -100,6 +100,480 @@ void TestColorMap::QCPColorScale_rescaleDataRange()
   QCOMPARE(scale->dataRange().upper, 3.5);
 }
 
+void TestColorMap::QCPColorScale_gradientStrip()
+{
+  QCPColorScale *scale = new QCPColorScale(mPlot);
+  mPlot->plotLayout()->addElement(0, 1, scale);
+  // gradient with constant colors near the ends, so pixels next to the axis lines can be checked:
+  QCPColorGradient gradient;
+  gradient.clearColorStops();
+  gradient.setColorStopAt(0, Qt::red);
+  gradient.setColorStopAt(0.45, Qt::red);
+  gradient.setColorStopAt(0.55, Qt::green);
+  gradient.setColorStopAt(1, Qt::green);
+  scale->setGradient(gradient);
+  const int n = gradient.levelCount();
+  const QRgb lowest = gradient.color(0, QCPRange(0, n-1));
+  const QRgb highest = gradient.color(n-1, QCPRange(0, n-1));
+  
+  // the gradient strip must be stretched over the whole bar, also after resizing and mirroring:
+  for (int configuration=0; configuration<4; ++configuration)
+  {
+    if (configuration == 1)
+      mPlot->setGeometry(0, 0, 300, 500);
+    if (configuration == 2)
+      scale->axis()->setRangeReversed(true);
+    if (configuration == 3)
+    {
+      scale->axis()->setRangeReversed(false);
+      scale->setType(QCPAxis::atBottom);
+      mPlot->plotLayout()->take(scale);
+      mPlot->plotLayout()->simplify();
+      mPlot->plotLayout()->addElement(1, 0, scale);
+    }
+    QImage image = mPlot->toPixmap().toImage();
+    const QRect bar = scale->axis()->axisRect()->rect();
+    const bool reversed = scale->axis()->rangeReversed();
+    if (scale->type() == QCPAxis::atRight)
+    {
+      QCOMPARE(image.pixel(bar.center().x(), bar.top()+3), reversed ? lowest : highest);
+      QCOMPARE(image.pixel(bar.center().x(), bar.bottom()-3), reversed ? highest : lowest);
+    } else
+    {
+      QCOMPARE(image.pixel(bar.left()+3, bar.center().y()), lowest);
+      QCOMPARE(image.pixel(bar.right()-3, bar.center().y()), highest);
+    }
+  }
+}
+
+void TestColorMap::QCPColorGradient_colorize()
+{
+  // data with values inside and outside the range, NaN and values that exceed the int range:
+  int n = 1003;
+  QVector<double> data(3*n);
+  for (int i=0; i<data.size(); ++i)
+    data[i] = 0.1+qAbs(qSin(i*0.37))*30;
+  data[5] = -2;
+  data[6] = qQNaN();
+  data[7] = 1e12;
+  data[8] = -1e12;
+  
+  // colorizing whole arrays must give the same colors as colorizing each value on its own:
+  QCPColorGradient gradient(QCPColorGradient::gpJet);
+  gradient.setLevelCount(350);
+  QVector<QRgb> scanLine(n), reference(n);
+  for (int dataIndexFactor=1; dataIndexFactor<=3; dataIndexFactor+=2)
+  {
+    for (int periodic=0; periodic<2; ++periodic)
+    {
+      for (int logarithmic=0; logarithmic<2; ++logarithmic)
+      {
+        gradient.setPeriodic(periodic);
+        QCPRange range(0.5, 20.5);
+        gradient.colorize(data.constData(), range, scanLine.data(), n, dataIndexFactor, logarithmic);
+        for (int i=0; i<n; ++i)
+          gradient.colorize(data.constData()+dataIndexFactor*i, range, reference.data()+i, 1, dataIndexFactor, logarithmic);
+        QCOMPARE(scanLine, reference);
+      }
+    }
+  }
+}
+
+void TestColorMap::QCPColorMap_parallelColorize()
+{
+  // a map that is large enough to be colorized on multiple threads:
+  mColorMap->data()->setSize(1000, 400);
+  mColorMap->data()->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  for (int x=0; x<1000; ++x)
+    for (int y=0; y<400; ++y)
+      mColorMap->data()->setCell(x, y, qSin(x*0.01)*qCos(y*0.03));
+  mColorMap->rescaleDataRange(true);
+  mPlot->rescaleAxes();
+  
+  int oldMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+  for (int orientation=0; orientation<2; ++orientation)
+  {
+    if (orientation == 1)
+    {
+      mColorMap->setKeyAxis(mPlot->yAxis);
+      mColorMap->setValueAxis(mPlot->xAxis);
+      mPlot->rescaleAxes();
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(1);
+    mColorMap->data()->setCell(0, 0, mColorMap->data()->cell(0, 0)); // mark data as modified
+    QImage serial = mPlot->toPixmap(400, 300).toImage();
+    QThreadPool::globalInstance()->setMaxThreadCount(qMax(4, oldMaxThreadCount));
+    mColorMap->data()->setCell(0, 0, mColorMap->data()->cell(0, 0));
+    QImage parallel = mPlot->toPixmap(400, 300).toImage();
+    QCOMPARE(parallel, serial);
+  }
+  QThreadPool::globalInstance()->setMaxThreadCount(oldMaxThreadCount);
+}
+
+void TestColorMap::QCPColorMap_modifiedCells()
+{
+  mColorMap->data()->setSize(50, 40);
+  mColorMap->data()->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  mColorMap->setDataRange(QCPRange(-1, 1));
+  mPlot->rescaleAxes();
+  
+  for (int orientation=0; orientation<2; ++orientation)
+  {
+    if (orientation == 1)
+    {
+      mColorMap->setKeyAxis(mPlot->yAxis);
+      mColorMap->setValueAxis(mPlot->xAxis);
+      mPlot->rescaleAxes();
+    }
+    mColorMap->data()->fill(0);
+    mPlot->toPixmap(200, 200);
+    
+    // change a row and a single cell, so only these cells are recolorized:
+    for (int x=0; x<50; ++x)
+      mColorMap->data()->setCell(x, 7, qSin(x*0.3));
+    mColorMap->data()->setCell(12, 30, 0.8);
+    QImage incremental = mPlot->toPixmap(200, 200).toImage();
+    
+    // changing the data range causes a full recolorization:
+    mColorMap->setDataRange(QCPRange(-2, 2));
+    mColorMap->setDataRange(QCPRange(-1, 1));
+    QImage full = mPlot->toPixmap(200, 200).toImage();
+    QCOMPARE(incremental, full);
+  }
+}
+
+void TestColorMap::QCPColorMapData_addRow()
+{
+  QCPColorMapData *data = mColorMap->data();
+  data->setSize(6, 5);
+  data->setRange(QCPRange(0, 5), QCPRange(0, 4));
+  for (int v=0; v<5; ++v)
+    for (int k=0; k<6; ++k)
+      data->setCell(k, v, v*10+k);
+  
+  // adding rows scrolls the data down by one row each:
+  double row[6];
+  for (int r=0; r<7; ++r)
+  {
+    for (int k=0; k<6; ++k)
+      row[k] = (5+r)*10+k;
+    data->addRow(row);
+  }
+  for (int v=0; v<5; ++v)
+    for (int k=0; k<6; ++k)
+      QCOMPARE(data->cell(k, v), (v+7)*10.0+k);
+  QCOMPARE(data->dataBounds().upper, 115.0);
+  data->setCell(2, 4, -1);
+  QCOMPARE(data->cell(2, 4), -1.0);
+  data->setCell(2, 4, 112);
+  
+  // the map image composited from the ring must look like the same data stored without ring:
+  mPlot->setGeometry(0, 0, 300, 300);
+  mColorMap->setInterpolate(false);
+  mColorMap->setDataRange(QCPRange(70, 120));
+  QCPColorMapData ringData(*data); // copying keeps the ring offset
+  QCPColorMapData plain(6, 5, data->keyRange(), data->valueRange());
+  for (int v=0; v<5; ++v)
+    for (int k=0; k<6; ++k)
+      plain.setCell(k, v, data->cell(k, v));
+  for (int configuration=0; configuration<3; ++configuration)
+  {
+    if (configuration == 1)
+      mPlot->yAxis->setRangeReversed(true);
+    if (configuration == 2)
+    {
+      mColorMap->setKeyAxis(mPlot->yAxis);
+      mColorMap->setValueAxis(mPlot->xAxis);
+    }
+    mPlot->rescaleAxes();
+    mColorMap->setData(&ringData, true);
+    QImage ring = mPlot->toPixmap().toImage();
+    mColorMap->setData(&plain, true);
+    QImage reference = mPlot->toPixmap().toImage();
+    for (int v=0; v<5; ++v)
+    {
+      for (int k=0; k<6; ++k)
+      {
+        double key, value;
+        plain.cellToCoord(k, v, &key, &value);
+        QPoint pixel = mColorMap->keyAxis()->orientation() == Qt::Horizontal ?
+              QPoint(mColorMap->keyAxis()->coordToPixel(key), mColorMap->valueAxis()->coordToPixel(value)) :
+              QPoint(mColorMap->valueAxis()->coordToPixel(value), mColorMap->keyAxis()->coordToPixel(key));
+        QCOMPARE(ring.pixel(pixel), reference.pixel(pixel));
+      }
+    }
+  }
+}
+
+void TestColorMap::QCPColorMap_viewportResampling()
+{
+  // a map with far more cells than pixels, with a single peak cell:
+  mPlot->setGeometry(0, 0, 300, 300);
+  QCPColorMapData *data = mColorMap->data();
+  data->setSize(3000, 2000);
+  data->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  data->fill(0);
+  data->setCell(1500, 1000, 1);
+  mColorMap->setGradient(QCPColorGradient::gpGrayscale);
+  mColorMap->setDataRange(QCPRange(0, 1));
+  mColorMap->setInterpolate(false);
+  mPlot->rescaleAxes();
+  double key, value;
+  data->cellToCoord(1500, 1000, &key, &value);
+  QPoint peak(mPlot->xAxis->coordToPixel(key), mPlot->yAxis->coordToPixel(value));
+  QPoint background(peak.x()-50, peak.y()+50);
+  
+  mColorMap->setViewportResampling(QCPColorMap::vrMaximum);
+  QImage image = mPlot->toPixmap().toImage();
+  QCOMPARE(image.pixel(peak), QColor(Qt::white).rgb());
+  QCOMPARE(image.pixel(background), QColor(Qt::black).rgb());
+  
+  mColorMap->setViewportResampling(QCPColorMap::vrMinimum);
+  image = mPlot->toPixmap().toImage();
+  QCOMPARE(image.pixel(peak), QColor(Qt::black).rgb());
+  
+  // the mean of a pixel covering the peak cell is dark, but not black:
+  mColorMap->setViewportResampling(QCPColorMap::vrMean);
+  image = mPlot->toPixmap().toImage();
+  QVERIFY(qGray(image.pixel(peak)) < 128);
+  QCOMPARE(image.pixel(background), QColor(Qt::black).rgb());
+  
+  // changed data and zoomed axes must invalidate the cached resampled image:
+  data->setCell(1500, 1000, 0);
+  image = mPlot->toPixmap().toImage();
+  QCOMPARE(image.pixel(peak), QColor(Qt::black).rgb());
+  mColorMap->setViewportResampling(QCPColorMap::vrMaximum);
+  data->setCell(1500, 1000, 1);
+  mPlot->xAxis->setRange(key-0.01, key+0.01);
+  mPlot->yAxis->setRangeReversed(true);
+  mPlot->replot();
+  peak = QPoint(mPlot->xAxis->coordToPixel(key), mPlot->yAxis->coordToPixel(value));
+  image = mPlot->toPixmap().toImage();
+  QCOMPARE(image.pixel(peak), QColor(Qt::white).rgb());
+}
+
+void TestColorMap::QCPColorMapData_cellTypes()
+{
+  // stored values are converted to the cell type:
+  QCPColorMapData floatData(4, 3, QCPRange(0, 1), QCPRange(0, 1), QCPColorMapData::ctFloat);
+  QCOMPARE(floatData.cellType(), QCPColorMapData::ctFloat);
+  floatData.setCell(1, 2, 0.1);
+  QCOMPARE(floatData.cell(1, 2), (double)0.1f);
+  QCPColorMapData byteData(4, 3, QCPRange(0, 1), QCPRange(0, 1), QCPColorMapData::ctUInt8);
+  byteData.setCell(0, 0, 12.6);
+  byteData.setCell(1, 0, -5);
+  byteData.setCell(2, 0, 300);
+  QCOMPARE(byteData.cell(0, 0), 13.0);
+  QCOMPARE(byteData.cell(1, 0), 0.0);
+  QCOMPARE(byteData.cell(2, 0), 255.0);
+  QCOMPARE(byteData.dataBounds(), QCPRange(0, 255));
+  byteData.fill(7.2);
+  QCOMPARE(byteData.cell(3, 2), 7.0);
+  QCOMPARE(byteData.dataBounds(), QCPRange(7, 7));
+  QCPColorMapData copy(4, 3, QCPRange(0, 1), QCPRange(0, 1));
+  copy = byteData;
+  QCOMPARE(copy.cellType(), QCPColorMapData::ctUInt8);
+  QCOMPARE(copy.cell(3, 2), 7.0);
+  
+  // dimensions whose cell count exceeds the int range are rejected instead of overflowing:
+  QCPColorMapData hugeData(4, 3, QCPRange(0, 1), QCPRange(0, 1), QCPColorMapData::ctUInt8);
+  hugeData.setSize(65536, 65536);
+  hugeData.setCell(1, 1, 5);
+  QCOMPARE(hugeData.cell(1, 1), 0.0);
+  hugeData.setSize(4, 3);
+  hugeData.setCell(1, 1, 5);
+  QCOMPARE(hugeData.cell(1, 1), 5.0);
+  
+  // the lookup table paths of the gradient must give the same colors as the double path:
+  QCPColorGradient gradient(QCPColorGradient::gpJet);
+  QVector<quint16> words(65536);
+  QVector<double> values(65536);
+  for (int i=0; i<words.size(); ++i)
+  {
+    words[i] = (i*7919) % 65536;
+    values[i] = words.at(i);
+  }
+  QVector<QRgb> scanLine(words.size()), reference(words.size());
+  for (int logarithmic=0; logarithmic<2; ++logarithmic)
+  {
+    QCPRange range(100, 40000);
+    gradient.colorize(words.constData(), range, scanLine.data(), words.size(), 1, logarithmic);
+    gradient.colorize(values.constData(), range, reference.data(), values.size(), 1, logarithmic);
+    QCOMPARE(scanLine, reference);
+  }
+  
+  // the lookup table must not survive a gradient change, even if the color buffer was updated in between:
+  QCPRange range(0, 65535);
+  gradient.colorize(words.constData(), range, scanLine.data(), words.size());
+  gradient.setColorStopAt(0, QColor(Qt::white));
+  QCOMPARE(gradient.color(0, range), qRgb(255, 255, 255));
+  gradient.colorize(words.constData(), range, scanLine.data(), words.size());
+  gradient.colorize(values.constData(), range, reference.data(), values.size());
+  QCOMPARE(scanLine, reference);
+  
+  // a map with integer cells must look like the same map with double cells:
+  mPlot->setGeometry(0, 0, 300, 300);
+  mColorMap->setInterpolate(false);
+  mColorMap->setDataRange(QCPRange(0, 250));
+  QCPColorMapData doubleData(20, 15, QCPRange(0, 1), QCPRange(0, 1));
+  QCPColorMapData wordData(20, 15, QCPRange(0, 1), QCPRange(0, 1), QCPColorMapData::ctUInt16);
+  for (int x=0; x<20; ++x)
+  {
+    for (int y=0; y<15; ++y)
+    {
+      doubleData.setCell(x, y, x*y);
+      wordData.setCell(x, y, x*y);
+    }
+  }
+  mColorMap->setData(&doubleData, true);
+  mPlot->rescaleAxes();
+  QImage reference = mPlot->toPixmap().toImage();
+  mColorMap->setData(&wordData, true);
+  QCOMPARE(mPlot->toPixmap().toImage(), reference);
+}
+
+void TestColorMap::QCPColorMapData_boundsTracking()
+{
+  QCPColorMapData *data = mColorMap->data();
+  data->setSize(50, 40);
+  for (int x=0; x<50; ++x)
+    for (int y=0; y<40; ++y)
+      data->setCell(x, y, qSin(x*0.1)*qCos(y*0.2));
+  data->recalculateDataBounds();
+  const QCPRange initialBounds = data->dataBounds();
+  data->setBoundsTracking(true);
+  QCOMPARE(data->dataBounds(), initialBounds);
+  
+  // the bounds must always equal those of a full scan, also after extremes are overwritten inward:
+  QCPColorMapData reference(*data);
+  reference.setBoundsTracking(false);
+  for (int step=0; step<300; ++step)
+  {
+    const int x = (step*37) % 50;
+    const int y = (step*11) % 40;
+    const double z = step % 7 == 0 ? 5.0-step/30.0 : qSin(step*0.3)*0.5;
+    data->setCell(x, y, z);
+    reference.setCell(x, y, z);
+    if (step % 50 == 0)
+    {
+      double row[50];
+      for (int k=0; k<50; ++k)
+        row[k] = qCos(step+k*0.2)*0.8;
+      data->addRow(row);
+      reference.addRow(row);
+    }
+    reference.recalculateDataBounds();
+    QCOMPARE(data->dataBounds(), reference.dataBounds());
+  }
+  
+  // color scale and color map rescale to the exact bounds:
+  QCPColorScale *colorScale = new QCPColorScale(mPlot);
+  mPlot->plotLayout()->addElement(0, 1, colorScale);
+  mColorMap->setColorScale(colorScale);
+  data->fill(1);
+  data->setCell(3, 4, 2);
+  data->setCell(3, 4, 1.5);
+  colorScale->rescaleDataRange(false);
+  QCOMPARE(colorScale->dataRange(), QCPRange(1, 1.5));
+  data->setCell(3, 4, 1.2);
+  mColorMap->rescaleDataRange(false);
+  QCOMPARE(mColorMap->dataRange(), QCPRange(1, 1.2));
+}
+
+void TestColorMap::QCPColorMapData_bulkWrites()
+{
+  // source frame of 12x9 values, of which a transposed and clipped block is written:
+  QVector<double> frame(12*9);
+  for (int i=0; i<frame.size(); ++i)
+    frame[i] = i*0.5;
+  QVector<quint16> words(frame.size());
+  for (int i=0; i<frame.size(); ++i)
+    words[i] = i*3;
+  
+  QCPColorMapData bulk(8, 6, QCPRange(0, 1), QCPRange(0, 1));
+  QCPColorMapData reference(8, 6, QCPRange(0, 1), QCPRange(0, 1));
+  bulk.setBlock(-2, 3, 5, 4, frame.constData(), 12, 1); // cell (k, v) of the block from frame[v+12*k]
+  for (int v=0; v<4; ++v)
+    for (int k=0; k<5; ++k)
+      reference.setCell(-2+k, 3+v, frame.at(v+12*k));
+  bulk.setRow(1, words.constData(), 2);
+  for (int k=0; k<8; ++k)
+    reference.setCell(k, 1, words.at(2*k));
+  bulk.setColumn(7, frame.constData()+3, 12);
+  for (int v=0; v<6; ++v)
+    reference.setCell(7, v, frame.at(3+12*v));
+  for (int v=0; v<6; ++v)
+    for (int k=0; k<8; ++k)
+      QCOMPARE(bulk.cell(k, v), reference.cell(k, v));
+  QCOMPARE(bulk.dataBounds(), reference.dataBounds());
+  
+  // copying rows of the same type, also into a ring after addRow and with bounds tracking:
+  QCPColorMapData words16(8, 6, QCPRange(0, 1), QCPRange(0, 1), QCPColorMapData::ctUInt16);
+  words16.setBoundsTracking(true);
+  double row[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+  words16.addRow(row);
+  words16.setBlock(0, 0, 8, 6, words.constData());
+  for (int v=0; v<6; ++v)
+    for (int k=0; k<8; ++k)
+      QCOMPARE(words16.cell(k, v), (double)words.at(v*8+k));
+  QCOMPARE(words16.dataBounds(), QCPRange(0, 47*3));
+  words16.setBlock(0, 5, 8, 1, words.constData());
+  QCOMPARE(words16.dataBounds(), QCPRange(0, 39*3));
+  
+  // a bulk write recolorizes the modified cells in the map image:
+  mPlot->setGeometry(0, 0, 300, 300);
+  mColorMap->setInterpolate(false);
+  mColorMap->setData(&reference, true);
+  mColorMap->setDataRange(QCPRange(0, 60));
+  mPlot->rescaleAxes();
+  mPlot->replot();
+  reference.setBlock(2, 2, 3, 3, words.constData());
+  mColorMap->data()->setBlock(2, 2, 3, 3, words.constData());
+  QImage image = mPlot->toPixmap().toImage();
+  mColorMap->setData(&reference, true);
+  QCOMPARE(image, mPlot->toPixmap().toImage());
+}
+
+void TestColorMap::QCPColorMap_logarithmicCache()
+{
+  // cells on the centers of the gradient levels of a logarithmic range from 1 to 1000:
+  mPlot->setGeometry(0, 0, 400, 400);
+  mColorMap->setInterpolate(false);
+  mColorMap->setDataScaleType(QCPAxis::stLogarithmic);
+  mColorMap->setDataRange(QCPRange(1, 1000));
+  QCPColorGradient gradient(QCPColorGradient::gpJet);
+  mColorMap->setGradient(gradient);
+  QCPColorMapData *data = mColorMap->data();
+  data->setSize(20, 15);
+  data->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  for (int x=0; x<20; ++x)
+    for (int y=0; y<15; ++y)
+      data->setCell(x, y, qPow(1000.0, ((x*15+y)+0.5)/350.0));
+  data->setCell(0, 0, 0);
+  data->setCell(1, 0, -5);
+  mPlot->rescaleAxes();
+  
+  for (int pass=0; pass<3; ++pass)
+  {
+    if (pass == 1) // a change of single cells only updates their cached logarithms
+      data->setCell(4, 7, qPow(1000.0, 310.5/350.0));
+    if (pass == 2) // a change of the data range reuses the cache
+      mColorMap->setDataRange(QCPRange(1, 1000*1000));
+    mPlot->replot();
+    QImage image = mPlot->toPixmap().toImage();
+    for (int x=0; x<20; ++x)
+    {
+      for (int y=0; y<15; ++y)
+      {
+        double key, value;
+        data->cellToCoord(x, y, &key, &value);
+        QPoint pixel(mPlot->xAxis->coordToPixel(key), mPlot->yAxis->coordToPixel(value));
+        QCOMPARE(image.pixel(pixel), gradient.color(data->cell(x, y), mColorMap->dataRange(), true));
+      }
+    }
+  }
+}
+
 void TestColorMap::cleanup()
 {
   delete mPlot;
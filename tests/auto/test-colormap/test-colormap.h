@@ -9,6 +9,16 @@ private slots:
   void cleanup();
   
   void QCPColorScale_rescaleDataRange();
+  void QCPColorScale_gradientStrip();
+  void QCPColorGradient_colorize();
+  void QCPColorMap_parallelColorize();
+  void QCPColorMap_modifiedCells();
+  void QCPColorMapData_addRow();
+  void QCPColorMap_viewportResampling();
+  void QCPColorMapData_cellTypes();
+  void QCPColorMapData_boundsTracking();
+  void QCPColorMapData_bulkWrites();
+  void QCPColorMap_logarithmicCache();
   
 private:
   QCustomPlot *mPlot;
@@ -198,3 +198,94 @@ void TestQCPAxisRect::axisRectRemovalConsequencesToItems()
 
 
 
+
+void TestQCPAxisRect::incrementalTickLabels()
+{
+  QCPAxis *axis = mPlot->xAxis;
+  axis->setAutoTickStep(false);
+  axis->setTickStep(1);
+  axis->setNumberFormat("f");
+  axis->setNumberPrecision(1);
+  
+  // pan the range in steps smaller than the tick step, so most labels are reused:
+  for (int i=0; i<25; ++i)
+  {
+    axis->setRange(-5+i*0.4, 5+i*0.4);
+    mPlot->replot();
+    QVector<double> ticks = axis->tickVector();
+    QVector<QString> labels = axis->tickVectorLabels();
+    for (int k=0; k<ticks.size(); ++k)
+    {
+      if (ticks.at(k) >= axis->range().lower && ticks.at(k) <= axis->range().upper)
+        QCOMPARE(labels.at(k), mPlot->locale().toString(ticks.at(k), 'f', 1));
+    }
+  }
+  
+  // changed format parameters must not reuse previous labels:
+  axis->setNumberPrecision(2);
+  mPlot->replot();
+  QVector<double> ticks = axis->tickVector();
+  QVector<QString> labels = axis->tickVectorLabels();
+  for (int k=0; k<ticks.size(); ++k)
+  {
+    if (ticks.at(k) >= axis->range().lower && ticks.at(k) <= axis->range().upper)
+      QCOMPARE(labels.at(k), mPlot->locale().toString(ticks.at(k), 'f', 2));
+  }
+  
+  mPlot->setLocale(QLocale(QLocale::German, QLocale::Germany));
+  mPlot->replot();
+  ticks = axis->tickVector();
+  labels = axis->tickVectorLabels();
+  for (int k=0; k<ticks.size(); ++k)
+  {
+    if (ticks.at(k) >= axis->range().lower && ticks.at(k) <= axis->range().upper)
+      QCOMPARE(labels.at(k), QLocale(QLocale::German, QLocale::Germany).toString(ticks.at(k), 'f', 2));
+  }
+}
+
+void TestQCPAxisRect::dateTimeFormatter()
+{
+  QStringList formats;
+  formats << "hh:mm:ss\ndd.MM.yy" << "yyyy-MM-dd hh:mm:ss.zzz" << "d.M.yyyy h:m:s" << "ddd dddd MMM MMMM"
+          << "'week' dd 'o''clock' '' hhh mmmm sssss yyyyyy" << "hh:mm ap" << "t";
+  QList<Qt::TimeSpec> specs;
+  specs << Qt::UTC << Qt::LocalTime;
+  QList<QLocale> locales;
+  locales << QLocale::c() << QLocale(QLocale::German, QLocale::Germany);
+  
+  for (int f=0; f<formats.size(); ++f)
+  {
+    for (int t=0; t<specs.size(); ++t)
+    {
+      QCPDateTimeFormatterPrivate formatter(formats.at(f), specs.at(t));
+      QCOMPARE(formatter.isCompiled(), f < 5);
+      for (int l=0; l<locales.size(); ++l)
+      {
+        // consecutive ticks across several days, plus jumps over years and a daylight saving period:
+        double key = 1.4e9-3*86400;
+        for (int i=0; i<500; ++i)
+        {
+          key += i%50 == 0 ? 86400*37.123 : 1234.567;
+          QCOMPARE(formatter.toString(key, locales.at(l)), formatter.toStringQDateTime(key, locales.at(l)));
+        }
+        QCOMPARE(formatter.toString(0, locales.at(l)), formatter.toStringQDateTime(0, locales.at(l)));
+        QCOMPARE(formatter.toString(-86400.5, locales.at(l)), formatter.toStringQDateTime(-86400.5, locales.at(l)));
+      }
+    }
+  }
+  
+  // axis uses the formatter for date time tick labels:
+  QCPAxis *axis = mPlot->xAxis;
+  axis->setTickLabelType(QCPAxis::ltDateTime);
+  axis->setDateTimeFormat("yyyy-MM-dd hh:mm");
+  axis->setDateTimeSpec(Qt::UTC);
+  axis->setRange(1.4e9, 1.4e9+86400*3);
+  mPlot->replot();
+  QVector<double> ticks = axis->tickVector();
+  QVector<QString> labels = axis->tickVectorLabels();
+  for (int k=0; k<ticks.size(); ++k)
+  {
+    if (ticks.at(k) >= axis->range().lower && ticks.at(k) <= axis->range().upper)
+      QCOMPARE(labels.at(k), mPlot->locale().toString(QDateTime::fromMSecsSinceEpoch(ticks.at(k)*1000).toTimeSpec(Qt::UTC), "yyyy-MM-dd hh:mm"));
+  }
+}
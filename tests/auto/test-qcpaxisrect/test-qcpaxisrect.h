@@ -14,6 +14,8 @@ private slots:
   void axisRemovalConsequencesToItems();
   void axisRectRemovalConsequencesToPlottables();
   void axisRectRemovalConsequencesToItems();
+  void incrementalTickLabels();
+  void dateTimeFormatter();
   
 private:
   QCustomPlot *mPlot;
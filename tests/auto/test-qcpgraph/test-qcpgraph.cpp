@@ -1,6 +1,27 @@
 #include "test-qcpgraph.h"
 #include <QMainWindow>
 
+// graph that gives access to the (cached) plot data it draws:
+class PlotDataGraph : public QCPGraph
+{
+public:
+  PlotDataGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) : QCPGraph(keyAxis, valueAxis) {}
+  QVector<QPointF> lineData() const
+  {
+    QVector<QPointF> result;
+    getPlotData(&result, 0);
+    return result;
+  }
+  QVector<QCPData> scatterData() const
+  {
+    QVector<QCPData> result;
+    getPlotData(0, &result);
+    return result;
+  }
+  QPointF pixel(double key, double value) const { return coordsToPixels(key, value); }
+  double distance(double key, double value) const { return selectTest(pixel(key, value), false); }
+};
+
 void TestQCPGraph::init()
 {
   mPlot = new QCustomPlot(0);
@@ -68,56 +89,53 @@ void TestQCPGraph::dataManipulation()
   mGraph->setData(x, y);
   QCOMPARE(mGraph->data()->size(), 4);
   // data should be sorted by x:
-  QCOMPARE((mGraph->data()->begin()+0).value().value, 0.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().value, 1.0);
-  QCOMPARE((mGraph->data()->begin()+2).value().value, 2.0);
-  QCOMPARE((mGraph->data()->begin()+3).value().value, 3.0);
-  QCOMPARE((mGraph->data()->begin()+0).value().key, -2.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().key, -1.0);
-  QCOMPARE((mGraph->data()->begin()+2).value().key, 1.0);
-  QCOMPARE((mGraph->data()->begin()+3).value().key, 2.0);
-  // map key should be identical to data key:
-  for (int i=0; i<4; ++i)
-    QCOMPARE((mGraph->data()->begin()+i).key(), (mGraph->data()->begin()+i).value().key);
-  
+  QCOMPARE(mGraph->data()->at(0).value, 0.0);
+  QCOMPARE(mGraph->data()->at(1).value, 1.0);
+  QCOMPARE(mGraph->data()->at(2).value, 2.0);
+  QCOMPARE(mGraph->data()->at(3).value, 3.0);
+  QCOMPARE(mGraph->data()->at(0).key, -2.0);
+  QCOMPARE(mGraph->data()->at(1).key, -1.0);
+  QCOMPARE(mGraph->data()->at(2).key, 1.0);
+  QCOMPARE(mGraph->data()->at(3).key, 2.0);
+
   // data removal:
   mGraph->removeDataBefore(0);
   QCOMPARE(mGraph->data()->size(), 2);
-  QCOMPARE((mGraph->data()->begin()+0).value().key, 1.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().key, 2.0);
+  QCOMPARE(mGraph->data()->at(0).key, 1.0);
+  QCOMPARE(mGraph->data()->at(1).key, 2.0);
   
   mGraph->setData(x, y);
   mGraph->removeDataAfter(0);
   QCOMPARE(mGraph->data()->size(), 2);
-  QCOMPARE((mGraph->data()->begin()+0).value().key, -2.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().key, -1.0);
+  QCOMPARE(mGraph->data()->at(0).key, -2.0);
+  QCOMPARE(mGraph->data()->at(1).key, -1.0);
   
   mGraph->setData(x, y);
   mGraph->removeData(-1.1, -0.9);
   QCOMPARE(mGraph->data()->size(), 3);
-  QCOMPARE((mGraph->data()->begin()+0).value().key, -2.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().key, 1.0);
-  QCOMPARE((mGraph->data()->begin()+2).value().key, 2.0);
+  QCOMPARE(mGraph->data()->at(0).key, -2.0);
+  QCOMPARE(mGraph->data()->at(1).key, 1.0);
+  QCOMPARE(mGraph->data()->at(2).key, 2.0);
   
   mGraph->setData(x, y);
   mGraph->removeData(-2.1, -1.9);
   QCOMPARE(mGraph->data()->size(), 3);
-  QCOMPARE((mGraph->data()->begin()+0).value().key, -1.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().key, 1.0);
-  QCOMPARE((mGraph->data()->begin()+2).value().key, 2.0);
+  QCOMPARE(mGraph->data()->at(0).key, -1.0);
+  QCOMPARE(mGraph->data()->at(1).key, 1.0);
+  QCOMPARE(mGraph->data()->at(2).key, 2.0);
   
   mGraph->setData(x, y);
   mGraph->removeData(1.9, 2.1);
   QCOMPARE(mGraph->data()->size(), 3);
-  QCOMPARE((mGraph->data()->begin()+0).value().key, -2.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().key, -1.0);
-  QCOMPARE((mGraph->data()->begin()+2).value().key, 1.0);
+  QCOMPARE(mGraph->data()->at(0).key, -2.0);
+  QCOMPARE(mGraph->data()->at(1).key, -1.0);
+  QCOMPARE(mGraph->data()->at(2).key, 1.0);
   
   mGraph->setData(x, y);
   mGraph->removeData(-1.1, 1.1);
   QCOMPARE(mGraph->data()->size(), 2);
-  QCOMPARE((mGraph->data()->begin()+0).value().key, -2.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().key, 2.0);
+  QCOMPARE(mGraph->data()->at(0).key, -2.0);
+  QCOMPARE(mGraph->data()->at(1).key, 2.0);
   
   mGraph->setData(x, y);
   mGraph->clearData();
@@ -128,28 +146,198 @@ void TestQCPGraph::dataManipulation()
   QCOMPARE(mGraph->data()->size(), 1);
   mGraph->addData(4, 5);
   QCOMPARE(mGraph->data()->size(), 2);
-  QCOMPARE((mGraph->data()->begin()+0).value().value, 5.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().value, 6.0);
+  QCOMPARE(mGraph->data()->at(0).value, 5.0);
+  QCOMPARE(mGraph->data()->at(1).value, 6.0);
   
   mGraph->setData(x, y);
   mGraph->addData(3, 4);
   QCOMPARE(mGraph->data()->size(), 5);
-  QCOMPARE((mGraph->data()->begin()+0).value().value, 0.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().value, 1.0);
-  QCOMPARE((mGraph->data()->begin()+2).value().value, 2.0);
-  QCOMPARE((mGraph->data()->begin()+3).value().value, 3.0);
-  QCOMPARE((mGraph->data()->begin()+4).value().value, 4.0);
+  QCOMPARE(mGraph->data()->at(0).value, 0.0);
+  QCOMPARE(mGraph->data()->at(1).value, 1.0);
+  QCOMPARE(mGraph->data()->at(2).value, 2.0);
+  QCOMPARE(mGraph->data()->at(3).value, 3.0);
+  QCOMPARE(mGraph->data()->at(4).value, 4.0);
   
   mGraph->setData(x, y);
   mGraph->addData(QVector<double>() << 3 << 4 << 5, QVector<double>() << 4 << 5 << 6);
   QCOMPARE(mGraph->data()->size(), 7);
-  QCOMPARE((mGraph->data()->begin()+0).value().value, 0.0);
-  QCOMPARE((mGraph->data()->begin()+1).value().value, 1.0);
-  QCOMPARE((mGraph->data()->begin()+2).value().value, 2.0);
-  QCOMPARE((mGraph->data()->begin()+3).value().value, 3.0);
-  QCOMPARE((mGraph->data()->begin()+4).value().value, 4.0);
-  QCOMPARE((mGraph->data()->begin()+5).value().value, 5.0);
-  QCOMPARE((mGraph->data()->begin()+6).value().value, 6.0);
+  QCOMPARE(mGraph->data()->at(0).value, 0.0);
+  QCOMPARE(mGraph->data()->at(1).value, 1.0);
+  QCOMPARE(mGraph->data()->at(2).value, 2.0);
+  QCOMPARE(mGraph->data()->at(3).value, 3.0);
+  QCOMPARE(mGraph->data()->at(4).value, 4.0);
+  QCOMPARE(mGraph->data()->at(5).value, 5.0);
+  QCOMPARE(mGraph->data()->at(6).value, 6.0);
+  
+  // add unsorted block of data points overlapping the existing key range:
+  mGraph->setData(x, y);
+  mGraph->addData(QVector<double>() << 1.5 << -3 << 0, QVector<double>() << 2.5 << -1 << 1.5);
+  QCOMPARE(mGraph->data()->size(), 7);
+  for (int i=1; i<mGraph->data()->size(); ++i)
+    QVERIFY(mGraph->data()->key(i-1) <= mGraph->data()->key(i));
+  QCOMPARE(mGraph->data()->at(0).value, -1.0);
+  QCOMPARE(mGraph->data()->at(3).value, 1.5);
+  QCOMPARE(mGraph->data()->at(5).value, 2.5);
+  
+  // equal keys replace existing data points, like QMap::insert:
+  mGraph->clearData();
+  mGraph->addData(1, 1);
+  mGraph->addData(1, 2);
+  mGraph->addData(0, 0);
+  mGraph->addData(0, 3);
+  QCOMPARE(mGraph->data()->size(), 2);
+  QCOMPARE(mGraph->data()->at(0).value, 3.0);
+  QCOMPARE(mGraph->data()->at(1).value, 2.0);
+  mGraph->addData(QVector<double>() << 1 << 2 << 2, QVector<double>() << 4 << 5 << 6);
+  QCOMPARE(mGraph->data()->size(), 3);
+  QCOMPARE(mGraph->data()->at(1).value, 4.0);
+  QCOMPARE(mGraph->data()->at(2).value, 6.0);
+  mGraph->addData(QVector<double>() << 2 << -1 << 0, QVector<double>() << 7 << 8 << 9);
+  QCOMPARE(mGraph->data()->size(), 4);
+  QCOMPARE(mGraph->data()->at(0).value, 8.0);
+  QCOMPARE(mGraph->data()->at(1).value, 9.0);
+  QCOMPARE(mGraph->data()->at(2).value, 4.0);
+  QCOMPARE(mGraph->data()->at(3).value, 7.0);
+  mGraph->setData(QVector<double>() << 0 << 0 << 1, QVector<double>() << 1 << 2 << 3);
+  QCOMPARE(mGraph->data()->size(), 2);
+  QCOMPARE(mGraph->data()->at(0).value, 2.0);
+  mGraph->removeData(1);
+  QCOMPARE(mGraph->data()->size(), 1);
+  QCOMPARE(mGraph->data()->at(0).key, 0.0);
+  
+  // error columns are only allocated once errors are set, existing points get zero errors:
+  mGraph->setData(x, y);
+  QVERIFY(!mGraph->data()->hasKeyErrors());
+  QVERIFY(!mGraph->data()->hasValueErrors());
+  QCPData errorPoint(0, 5);
+  errorPoint.valueErrorMinus = 0.5;
+  errorPoint.valueErrorPlus = 1.5;
+  mGraph->data()->add(errorPoint);
+  QVERIFY(!mGraph->data()->hasKeyErrors());
+  QVERIFY(mGraph->data()->hasValueErrors());
+  QCOMPARE(mGraph->data()->size(), 5);
+  QCOMPARE(mGraph->data()->at(2).value, 5.0);
+  QCOMPARE(mGraph->data()->valueErrorMinus(2), 0.5);
+  QCOMPARE(mGraph->data()->at(2).valueErrorPlus, 1.5);
+  QCOMPARE(mGraph->data()->valueErrorPlus(3), 0.0);
+  mGraph->removeData(-0.5, 0.5);
+  QCOMPARE(mGraph->data()->size(), 4);
+  QCOMPARE(mGraph->data()->valueErrorPlus(2), 0.0);
+  mGraph->setData(x, y);
+  QVERIFY(!mGraph->data()->hasValueErrors());
+}
+
+void TestQCPGraph::externalData()
+{
+  double keys[] = {0, 1, 2, 3, 4};
+  double values[] = {5, 6, 7, 8, 9};
+  mGraph->setExternalData(keys, values, 5);
+  QVERIFY(mGraph->data()->isExternal());
+  QCOMPARE(mGraph->data()->size(), 5);
+  QVERIFY(mGraph->data()->keyData() == keys);
+  QCOMPARE(mGraph->data()->findBegin(2.5), 3);
+  mPlot->rescaleAxes();
+  mPlot->replot();
+  
+  // modifying the external arrays only bumps the revision:
+  quint64 revision = mGraph->data()->revision();
+  values[2] = 10;
+  mGraph->data()->markModified();
+  QVERIFY(mGraph->data()->revision() != revision);
+  QCOMPARE(mGraph->data()->value(2), 10.0);
+  
+  // removing from the ends narrows the referenced window:
+  mGraph->removeDataBefore(0.5);
+  mGraph->removeDataAfter(3.5);
+  QVERIFY(mGraph->data()->isExternal());
+  QCOMPARE(mGraph->data()->size(), 3);
+  QCOMPARE(mGraph->data()->key(0), 1.0);
+  QCOMPARE(mGraph->data()->key(2), 3.0);
+  
+  // adding data detaches from the external arrays:
+  mGraph->addData(2.5, 0);
+  QVERIFY(!mGraph->data()->isExternal());
+  QCOMPARE(mGraph->data()->size(), 4);
+  QCOMPARE(mGraph->data()->value(1), 10.0);
+  QCOMPARE(mGraph->data()->value(2), 0.0);
+  QCOMPARE(keys[3], 3.0);
+  mPlot->replot();
+  
+  mGraph->setExternalData(keys, values, 5);
+  mGraph->clearData();
+  QVERIFY(!mGraph->data()->isExternal());
+  QCOMPARE(mGraph->data()->size(), 0);
+}
+
+void TestQCPGraph::dataCapacity()
+{
+  mGraph->data()->setCapacity(100);
+  QCOMPARE(mGraph->data()->capacity(), 100);
+  for (int i=0; i<1000; ++i)
+  {
+    mGraph->addData(i, -i);
+    mGraph->removeDataBefore(i-50);
+  }
+  QCOMPARE(mGraph->data()->size(), 51);
+  QCOMPARE(mGraph->data()->key(0), 949.0);
+  QCOMPARE(mGraph->data()->value(50), -999.0);
+  
+  for (int i=1000; i<1200; ++i)
+    mGraph->addData(i, -i);
+  QCOMPARE(mGraph->data()->size(), 100);
+  QCOMPARE(mGraph->data()->key(0), 1100.0);
+  QCOMPARE(mGraph->data()->findBegin(1150), 50);
+  mPlot->rescaleAxes();
+  mPlot->replot();
+  
+  // points inserted in the middle keep the smallest keys dropped first:
+  mGraph->addData(1100.5, 0);
+  QCOMPARE(mGraph->data()->size(), 100);
+  QCOMPARE(mGraph->data()->key(0), 1100.5);
+  
+  mGraph->data()->setCapacity(0);
+  mGraph->addData(1200, 0);
+  QCOMPARE(mGraph->data()->size(), 101);
+}
+
+void TestQCPGraph::dataValueMinMax()
+{
+  int n = 10000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i] = i;
+    y[i] = qSin(i*0.01)*i;
+  }
+  mGraph->setData(x, y);
+  
+  // compare block based result with direct scan, also after appending and dropping points:
+  for (int pass=0; pass<2; ++pass)
+  {
+    const int size = mGraph->data()->size();
+    int ranges[][2] = {{0, 1}, {0, size}, {7, 64}, {31, 5000}, {size-100, size}, {1234, 9000}};
+    for (int r=0; r<6; ++r)
+    {
+      double minValue, maxValue;
+      mGraph->data()->valueMinMax(ranges[r][0], ranges[r][1], minValue, maxValue);
+      double expectedMin = mGraph->data()->value(ranges[r][0]);
+      double expectedMax = expectedMin;
+      for (int i=ranges[r][0]; i<ranges[r][1]; ++i)
+      {
+        expectedMin = qMin(expectedMin, mGraph->data()->value(i));
+        expectedMax = qMax(expectedMax, mGraph->data()->value(i));
+      }
+      QCOMPARE(minValue, expectedMin);
+      QCOMPARE(maxValue, expectedMax);
+    }
+    for (int i=n; i<n+3000; ++i)
+      mGraph->addData(i, qCos(i*0.01)*i);
+    mGraph->removeDataBefore(2500);
+  }
+  
+  mGraph->setAdaptiveSampling(true);
+  mPlot->rescaleAxes();
+  mPlot->replot();
 }
 
 void TestQCPGraph::channelFill()
@@ -174,3 +362,156 @@ void TestQCPGraph::channelFill()
   mPlot->replot();
 }
 
+void TestQCPGraph::plotDataCache()
+{
+  mPlot->setGeometry(50, 50, 500, 500);
+  mPlot->show();
+  QTest::qWait(150);
+  PlotDataGraph *graph = new PlotDataGraph(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(graph);
+  QVector<double> keys, rising, falling;
+  for (int i=0; i<=10; ++i)
+  {
+    keys << i;
+    rising << i;
+    falling << 10-i;
+  }
+  graph->setData(keys, rising);
+  mPlot->xAxis->setRange(0, 10);
+  mPlot->yAxis->setRange(0, 10);
+  mPlot->replot();
+  
+  // without changes, the cached plot data is reused by draw and hit tests:
+  QVector<QPointF> lineData = graph->lineData();
+  QCOMPARE(lineData.size(), 11);
+  QCOMPARE(lineData.first(), graph->pixel(0, 0));
+  QVERIFY(graph->distance(2, 2) < 1);
+  mPlot->replot();
+  QVERIFY(graph->lineData().constData() == lineData.constData());
+  
+  // new data:
+  graph->setData(keys, falling);
+  QVERIFY(graph->lineData().constData() != lineData.constData());
+  lineData = graph->lineData();
+  QCOMPARE(lineData.first(), graph->pixel(0, 10));
+  QVERIFY(graph->distance(2, 8) < 1);
+  QVERIFY(graph->distance(2, 2) > 10);
+  QVERIFY(graph->lineData().constData() == lineData.constData());
+  
+  // new key and value ranges:
+  mPlot->xAxis->setRange(0, 20);
+  QVERIFY(graph->lineData().constData() != lineData.constData());
+  lineData = graph->lineData();
+  QCOMPARE(lineData.last(), graph->pixel(10, 0));
+  QVERIFY(graph->distance(2, 8) < 1);
+  mPlot->yAxis->setRange(-10, 20);
+  QVERIFY(graph->lineData().constData() != lineData.constData());
+  lineData = graph->lineData();
+  QCOMPARE(lineData.first(), graph->pixel(0, 10));
+  QVERIFY(graph->distance(2, 8) < 1);
+  QVERIFY(graph->lineData().constData() == lineData.constData());
+  
+  // new axis rect size:
+  mPlot->setGeometry(50, 50, 300, 400);
+  QTest::qWait(50);
+  mPlot->replot();
+  QVERIFY(graph->lineData().constData() != lineData.constData());
+  lineData = graph->lineData();
+  QCOMPARE(lineData.first(), graph->pixel(0, 10));
+  QVERIFY(graph->distance(2, 8) < 1);
+  mPlot->replot();
+  QVERIFY(graph->lineData().constData() == lineData.constData());
+  
+  // new line style, steps need additional points:
+  graph->setLineStyle(QCPGraph::lsStepLeft);
+  QVERIFY(graph->lineData().size() > 11);
+  QVERIFY(graph->distance(2.5, 8) < 1); // on the step between the data points (2, 8) and (3, 7)
+  lineData = graph->lineData();
+  mPlot->replot();
+  QVERIFY(graph->lineData().constData() == lineData.constData());
+  
+  // adaptive sampling reduces dense data, disabling it must give the full data again:
+  graph->setLineStyle(QCPGraph::lsLine);
+  QVector<double> denseKeys, denseValues;
+  for (int i=0; i<100000; ++i)
+  {
+    denseKeys << i*1e-4;
+    denseValues << qSin(i*0.01);
+  }
+  graph->setData(denseKeys, denseValues);
+  const int sampledSize = graph->lineData().size();
+  QVERIFY(sampledSize < 100000);
+  graph->setAdaptiveSampling(false);
+  QVERIFY(graph->lineData().size() >= 100000);
+  graph->setAdaptiveSampling(true);
+  QCOMPARE(graph->lineData().size(), sampledSize);
+}
+
+void TestQCPGraph::parallelPreparation()
+{
+  // two identical plots with several graphs, one of them prepares the plot data in parallel:
+  QList<QCustomPlot*> plots;
+  QList<QList<PlotDataGraph*> > graphs;
+  for (int p=0; p<2; ++p)
+  {
+    QCustomPlot *plot = new QCustomPlot(0);
+    plot->setPlottingHint(QCP::phParallelPreparation, p == 1);
+    plot->setGeometry(50, 50, 500, 400);
+    plot->show();
+    QList<PlotDataGraph*> plotGraphs;
+    for (int g=0; g<6; ++g)
+    {
+      PlotDataGraph *graph = new PlotDataGraph(plot->xAxis, plot->yAxis);
+      plot->addPlottable(graph);
+      QVector<double> keys, values;
+      for (int i=0; i<50000; ++i)
+      {
+        keys << i*1e-3;
+        values << qSin(i*0.001*(g+1))+g;
+      }
+      graph->setData(keys, values);
+      graph->setLineStyle((QCPGraph::LineStyle)(g % 6));
+      if (g % 2 == 0)
+        graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle));
+      plotGraphs << graph;
+    }
+    plot->xAxis->setRange(5, 40);
+    plot->yAxis->setRange(-2, 7);
+    plots << plot;
+    graphs << plotGraphs;
+  }
+  QTest::qWait(150);
+  
+  for (int round=0; round<2; ++round)
+  {
+    foreach (QCustomPlot *plot, plots)
+      plot->replot();
+    for (int g=0; g<graphs.first().size(); ++g)
+    {
+      PlotDataGraph *serial = graphs.at(0).at(g);
+      PlotDataGraph *parallel = graphs.at(1).at(g);
+      QCOMPARE(parallel->lineData(), serial->lineData());
+      QVector<QCPData> serialScatters = serial->scatterData();
+      QVector<QCPData> parallelScatters = parallel->scatterData();
+      QCOMPARE(parallelScatters.size(), serialScatters.size());
+      for (int i=0; i<serialScatters.size(); ++i)
+      {
+        QCOMPARE(parallelScatters.at(i).key, serialScatters.at(i).key);
+        QCOMPARE(parallelScatters.at(i).value, serialScatters.at(i).value);
+      }
+      for (int i=0; i<10; ++i)
+      {
+        const QPointF pos(60+i*35, 40+i*30);
+        QCOMPARE(parallel->selectTest(pos, false), serial->selectTest(pos, false));
+      }
+    }
+    // the second round prepares changed data and ranges:
+    foreach (QList<PlotDataGraph*> plotGraphs, graphs)
+      plotGraphs.first()->addData(45, 3);
+    foreach (QCustomPlot *plot, plots)
+      plot->xAxis->setRange(0, 46);
+  }
+  
+  qDeleteAll(plots);
+}
+
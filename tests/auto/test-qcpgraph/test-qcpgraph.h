@@ -10,7 +10,12 @@ private slots:
   
   void specializedGraphInterface();
   void dataManipulation();
+  void externalData();
+  void dataCapacity();
+  void dataValueMinMax();
   void channelFill();
+  void plotDataCache();
+  void parallelPreparation();
   
 private:
   QCustomPlot *mPlot;
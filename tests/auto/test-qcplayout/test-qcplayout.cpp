@@ -352,3 +352,69 @@ void TestQCPLayout::marginGroup()
 
 
 
+
+void TestQCPLayout::layoutCaching()
+{
+  mPlot->setGeometry(50, 50, 500, 500);
+  QCPLayoutGrid *mainLayout = mPlot->plotLayout();
+  QCPPlotTitle *title = new QCPPlotTitle(mPlot, "Title");
+  mainLayout->insertRow(0);
+  mainLayout->addElement(0, 0, title);
+  mPlot->legend->setVisible(true);
+  QCPGraph *graph = mPlot->addGraph();
+  graph->setName("a");
+  mPlot->replot();
+  
+  QRect titleRect = title->outerRect();
+  QRect axisRectRect = mPlot->axisRect()->outerRect();
+  QRect legendRect = mPlot->legend->outerRect();
+  QVERIFY(titleRect.height() > 0);
+  
+  // an unchanged plot keeps its arrangement:
+  mPlot->replot();
+  QCOMPARE(title->outerRect(), titleRect);
+  QCOMPARE(mPlot->axisRect()->outerRect(), axisRectRect);
+  QCOMPARE(mPlot->legend->outerRect(), legendRect);
+  
+  // changed size hints of leaf elements are picked up, also if set outside of the layout element:
+  title->setText("Title\nwith two lines");
+  graph->setName("a considerably longer graph name");
+  mPlot->replot();
+  QVERIFY(title->outerRect().height() > titleRect.height());
+  QVERIFY(mPlot->axisRect()->outerRect().height() < axisRectRect.height());
+  QVERIFY(mPlot->legend->outerRect().width() > legendRect.width());
+  
+  // margin changes due to wider tick labels are picked up:
+  int leftMargin = mPlot->axisRect()->margins().left();
+  mPlot->yAxis->setRange(0, 1e6);
+  mPlot->yAxis->setNumberFormat("f");
+  mPlot->yAxis->setNumberPrecision(3);
+  mPlot->replot();
+  QVERIFY(mPlot->axisRect()->margins().left() > leftMargin);
+  QCOMPARE(mPlot->axisRect()->rect().left(), mPlot->axisRect()->outerRect().left()+mPlot->axisRect()->margins().left());
+  
+  // panning with unchanged tick labels keeps the margin:
+  mPlot->yAxis->setTickStep(1e5);
+  mPlot->yAxis->setAutoTickStep(false);
+  mPlot->yAxis->setRange(0, 1e6);
+  mPlot->replot();
+  leftMargin = mPlot->axisRect()->margins().left();
+  mPlot->yAxis->setRange(-1e3, 1e6+1e3);
+  mPlot->replot();
+  QCOMPARE(mPlot->axisRect()->margins().left(), leftMargin);
+  
+  // outer rects changed externally are restored upon the next replot:
+  titleRect = title->outerRect();
+  title->setOuterRect(QRect(0, 0, 10, 10));
+  mPlot->replot();
+  QCOMPARE(title->outerRect(), titleRect);
+  
+  // structural changes and resizing invalidate the layout:
+  mainLayout->setRowSpacing(50);
+  mPlot->replot();
+  QCOMPARE(mPlot->axisRect()->outerRect().top(), title->outerRect().bottom()+1+50);
+  mPlot->setGeometry(50, 50, 400, 300);
+  mPlot->replot();
+  QCOMPARE(title->outerRect().width(), 400);
+  QCOMPARE(mPlot->axisRect()->outerRect().bottom(), 299);
+}
@@ -1,5 +1,28 @@
 #include "test-qcustomplot.h"
 
+// processes events until spy has recorded count signals, returns false if that takes more than timeout ms:
+static bool waitForSignalCount(const QSignalSpy &spy, int count, int timeout=5000)
+{
+  QTime time;
+  time.start();
+  while (spy.count() < count && time.elapsed() < timeout)
+    QTest::qWait(10);
+  return spy.count() >= count;
+}
+
+// replots and returns whether layerable was drawn, requires a replot timing history:
+static bool redrawnOnReplot(QCustomPlot *plot, QCPLayerable *layerable)
+{
+  plot->replot();
+  QCPReplotTiming timing = plot->replotTimings().last();
+  for (int i=0; i<timing.layerables.size(); ++i)
+  {
+    if (timing.layerables.at(i).first == layerable)
+      return true;
+  }
+  return false;
+}
+
 void TestQCustomPlot::init()
 {
   mPlot = new QCustomPlot(0);
@@ -91,3 +114,244 @@ void TestQCustomPlot::rescaleAxes_MultipleFlatGraphs()
 
 
 
+
+void TestQCustomPlot::layerBuffering()
+{
+  QCPLayer *mainLayer = mPlot->layer("main");
+  mainLayer->setMode(QCPLayer::lmBuffered);
+  QVERIFY(mainLayer->isDirty());
+  mPlot->replot();
+  QVERIFY(!mainLayer->isDirty());
+  
+  // adding a layerable dirties the layer:
+  mPlot->addGraph();
+  mPlot->graph(0)->setData(QVector<double>()<<1<<2<<3, QVector<double>()<<0<<1<<0);
+  QVERIFY(mainLayer->isDirty());
+  mPlot->replot();
+  QVERIFY(!mainLayer->isDirty());
+  
+  // replotting without changes keeps the buffer:
+  mPlot->replot();
+  QVERIFY(!mainLayer->isDirty());
+  
+  // changes of visibility, axis ranges and explicit marking cause the layer to be redrawn:
+  mPlot->graph(0)->setVisible(false);
+  QVERIFY(mainLayer->isDirty());
+  mPlot->replot();
+  QVERIFY(!mainLayer->isDirty());
+  mPlot->xAxis->setRange(-5, 5);
+  mPlot->replot();
+  QVERIFY(!mainLayer->isDirty());
+  mainLayer->markDirty();
+  QVERIFY(mainLayer->isDirty());
+  mPlot->replot();
+  QVERIFY(!mainLayer->isDirty());
+  
+  // exports draw the layer directly and don't touch the buffer state:
+  mainLayer->markDirty();
+  mPlot->toPixmap(100, 100);
+  QVERIFY(mainLayer->isDirty());
+  
+  mainLayer->setMode(QCPLayer::lmLogical);
+  QCOMPARE(mainLayer->mode(), QCPLayer::lmLogical);
+}
+
+void TestQCustomPlot::layerBufferingChanges()
+{
+  mPlot->setReplotTimingHistory(1);
+  mPlot->layer("main")->setMode(QCPLayer::lmBuffered);
+  QCPGraph *graph = mPlot->addGraph();
+  graph->setData(QVector<double>()<<1<<2<<3, QVector<double>()<<0<<1<<0);
+  QVERIFY(redrawnOnReplot(mPlot, graph));
+  QVERIFY(!redrawnOnReplot(mPlot, graph));
+  
+  // data changes are picked up, also when done directly on the data container:
+  graph->addData(4, 1);
+  QVERIFY(redrawnOnReplot(mPlot, graph));
+  graph->data()->add(QCPData(5, 0));
+  QVERIFY(redrawnOnReplot(mPlot, graph));
+  QVERIFY(!redrawnOnReplot(mPlot, graph));
+  
+  // property setters mark the layer dirty immediately:
+  graph->setPen(QPen(Qt::red));
+  QVERIFY(mPlot->layer("main")->isDirty());
+  QVERIFY(redrawnOnReplot(mPlot, graph));
+  
+  // the legend item is redrawn when the plottable changes:
+  mPlot->legend->setVisible(true);
+  mPlot->layer("legend")->setMode(QCPLayer::lmBuffered);
+  mPlot->replot();
+  graph->setName("renamed");
+  QVERIFY(mPlot->layer("legend")->isDirty());
+  
+  // items anchored to a moved item are redrawn, too:
+  mPlot->addLayer("overlay");
+  mPlot->layer("overlay")->setMode(QCPLayer::lmBuffered);
+  QCPItemTracer *tracer = new QCPItemTracer(mPlot);
+  mPlot->addItem(tracer);
+  QCPItemLine *line = new QCPItemLine(mPlot);
+  mPlot->addItem(line);
+  line->setLayer("overlay");
+  line->start->setParentAnchor(tracer->position);
+  mPlot->replot();
+  QVERIFY(!mPlot->layer("overlay")->isDirty());
+  tracer->position->setCoords(2, 1);
+  QVERIFY(mPlot->layer("overlay")->isDirty());
+}
+
+void TestQCustomPlot::layerReplot()
+{
+  mPlot->addGraph();
+  mPlot->graph(0)->setData(QVector<double>()<<1<<2<<3, QVector<double>()<<0<<1<<0);
+  mPlot->layer("main")->setMode(QCPLayer::lmBuffered);
+  mPlot->addLayer("overlay");
+  QCPLayer *overlay = mPlot->layer("overlay");
+  overlay->setMode(QCPLayer::lmBuffered);
+  QCPItemTracer *tracer = new QCPItemTracer(mPlot);
+  mPlot->addItem(tracer);
+  tracer->setLayer(overlay);
+  tracer->setGraph(mPlot->graph(0));
+  mPlot->replot();
+  QVERIFY(!mPlot->layer("main")->isDirty());
+  QVERIFY(!overlay->isDirty());
+  QSignalSpy spy(mPlot, SIGNAL(afterReplot()));
+  
+  // only the layer itself is redrawn, without a full replot:
+  tracer->setGraphKey(2);
+  overlay->replot();
+  QCOMPARE(spy.count(), 0);
+  QVERIFY(!overlay->isDirty());
+  
+  // dirty buffered layers are redrawn during recompositing, too:
+  mPlot->layer("main")->markDirty();
+  overlay->replot();
+  QCOMPARE(spy.count(), 0);
+  QVERIFY(!mPlot->layer("main")->isDirty());
+  
+  // layers in logical mode can't be redrawn on their own:
+  mPlot->layer("grid")->replot();
+  QCOMPARE(spy.count(), 1);
+  
+  // changed axis ranges invalidate all layer buffers, so a full replot is done:
+  mPlot->xAxis->setRange(-5, 5);
+  overlay->replot();
+  QCOMPARE(spy.count(), 2);
+  overlay->replot();
+  QCOMPARE(spy.count(), 2);
+}
+
+void TestQCustomPlot::queuedReplot()
+{
+  QSignalSpy spy(mPlot, SIGNAL(afterReplot()));
+  QTime time;
+  
+  // queued replot requests within one event loop iteration are merged:
+  for (int i=0; i<10; ++i)
+    mPlot->replot(QCustomPlot::rpQueuedReplot);
+  QCOMPARE(spy.count(), 0);
+  QVERIFY(waitForSignalCount(spy, 1));
+  QTest::qWait(50);
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(mPlot->queuedReplotRequests(), 10);
+  QCOMPARE(mPlot->mergedReplotRequests(), 9);
+  mPlot->resetReplotStatistics();
+  QCOMPARE(mPlot->queuedReplotRequests(), 0);
+  QCOMPARE(mPlot->mergedReplotRequests(), 0);
+  
+  // a direct replot satisfies a pending queued replot:
+  mPlot->replot(QCustomPlot::rpQueuedReplot);
+  mPlot->replot();
+  QCOMPARE(spy.count(), 2);
+  QTest::qWait(50);
+  QCOMPARE(spy.count(), 2);
+  
+  // the maximum replot rate delays queued replots by at least 1/rate since the last replot:
+  mPlot->setMaxReplotRate(5);
+  time.start();
+  mPlot->replot();
+  QCOMPARE(spy.count(), 3);
+  mPlot->replot(QCustomPlot::rpQueuedReplot);
+  QCOMPARE(spy.count(), 3);
+  QVERIFY(waitForSignalCount(spy, 4));
+  QVERIFY(time.elapsed() >= 150); // timers may fire slightly early, the nominal delay is 200 ms
+  QTest::qWait(50);
+  QCOMPARE(spy.count(), 4);
+}
+
+void TestQCustomPlot::replotTiming()
+{
+  QCPGraph *graph = mPlot->addGraph();
+  graph->setData(QVector<double>()<<1<<2<<3, QVector<double>()<<0<<1<<0);
+  mPlot->replot();
+  QVERIFY(mPlot->replotTimings().isEmpty());
+  
+  QSignalSpy spy(mPlot, SIGNAL(replotTimed(QCPReplotTiming)));
+  mPlot->setReplotTimingHistory(3);
+  for (int i=0; i<5; ++i)
+    mPlot->replot();
+  QCOMPARE(spy.count(), 5);
+  QCOMPARE(mPlot->replotTimings().size(), 3);
+  
+  QCPReplotTiming timing = mPlot->replotTimings().last();
+  QVERIFY(timing.total > 0);
+  QCOMPARE(timing.layers.size(), mPlot->layerCount());
+  QCOMPARE(timing.layers.first().first, QString("background"));
+  bool graphTimed = false;
+  for (int i=0; i<timing.layerables.size(); ++i)
+  {
+    if (timing.layerables.at(i).first == graph)
+      graphTimed = true;
+  }
+  QVERIFY(graphTimed);
+  
+  // exports aren't timed:
+  mPlot->toPixmap(100, 100);
+  QCOMPARE(spy.count(), 5);
+  
+  mPlot->setReplotTimingHistory(0);
+  QVERIFY(mPlot->replotTimings().isEmpty());
+  mPlot->replot();
+  QCOMPARE(spy.count(), 5);
+}
+
+void TestQCustomPlot::labelCache()
+{
+  QCPLabelCache *cache = QCPLabelCache::instance();
+  cache->clear();
+  mPlot->setGeometry(50, 50, 500, 500);
+  mPlot->setPlottingHint(QCP::phCacheLabels, true);
+  mPlot->xAxis->setRange(-10, 10);
+  mPlot->yAxis->setRange(-10, 10);
+  mPlot->replot();
+  QVERIFY(cache->count() > 0);
+  QVERIFY(cache->totalCost() <= cache->maximumCost());
+  
+  // a second plot with identical tick labels reuses the pixmaps of the first one:
+  QCustomPlot *plot2 = new QCustomPlot(0);
+  plot2->setGeometry(50, 50, 500, 500);
+  plot2->setPlottingHint(QCP::phCacheLabels, true);
+  plot2->xAxis->setRange(-10, 10);
+  plot2->yAxis->setRange(-10, 10);
+  plot2->show();
+  QTest::qWait(150);
+  cache->resetStatistics();
+  int countBefore = cache->count();
+  plot2->replot();
+  QVERIFY(cache->hits() > 0);
+  QCOMPARE(cache->misses(), 0);
+  QCOMPARE(cache->count(), countBefore);
+  delete plot2;
+  
+  // cache budget is respected:
+  int maximumCost = cache->maximumCost();
+  cache->setMaximumCost(0);
+  QCOMPARE(cache->count(), 0);
+  mPlot->replot();
+  QCOMPARE(cache->count(), 0);
+  cache->setMaximumCost(maximumCost);
+  mPlot->replot();
+  QVERIFY(cache->count() > 0);
+  
+  cache->clear();
+  QCOMPARE(cache->count(), 0);
+}
@@ -11,6 +11,12 @@ private slots:
   void rescaleAxes_GraphVisibility();
   void rescaleAxes_FlatGraph();
   void rescaleAxes_MultipleFlatGraphs();
+  void layerBuffering();
+  void layerBufferingChanges();
+  void layerReplot();
+  void queuedReplot();
+  void replotTiming();
+  void labelCache();
   
 private:
   QCustomPlot *mPlot;
@@ -17,9 +17,32 @@ private slots:
   void QCPGraph_RemoveDataAfter();
   void QCPGraph_RemoveDataBefore();
   void QCPGraph_AddData();
+  void QCPGraph_Streaming();
+  void QCPCurve_Streaming();
+  void QCPGraph_SelectTest();
+  void QCPGraph_ParallelPreparation_data();
+  void QCPGraph_ParallelPreparation();
+  void QCPLayer_BufferedReplot();
+  void QCPLayer_LayerReplot();
+  void QCPLayout_DataOnlyReplot();
 
   void QCPAxis_TickLabels();
   void QCPAxis_TickLabelsCached();
+  void QCPAxis_TickLabelsPanning();
+  void QCPAxis_DateTimeTickLabels();
+  
+  void QCPColorGradient_Colorize_data();
+  void QCPColorGradient_Colorize();
+  void QCPColorMap_UpdateMapImage_data();
+  void QCPColorMap_UpdateMapImage();
+  void QCPColorMap_Waterfall();
+  void QCPColorMap_ViewportResampling();
+  void QCPColorMap_CellTypes_data();
+  void QCPColorMap_CellTypes();
+  void QCPColorMap_RescaleDataRangeTracked();
+  void QCPColorMapData_BulkWrite_data();
+  void QCPColorMapData_BulkWrite();
+  void QCPColorMap_LogarithmicRecolor();
   
 private:
   QCustomPlot *mPlot;
@@ -256,6 +279,240 @@ void Benchmark::QCPGraph_AddData()
   }
 }
 
+void Benchmark::QCPGraph_Streaming()
+{
+  // 32 channels sampled at 1 kHz, showing the last 10 seconds, replotted at 20 Hz:
+  const int channels = 32;
+  const int rate = 1000;
+  const double window = 10;
+  for (int c=0; c<channels; ++c)
+    mPlot->addGraph()->data()->setCapacity(window*rate);
+  mPlot->yAxis->setRange(-1.5, channels+1.5);
+  
+  int tick = 0;
+  for (; tick<window*rate; ++tick) // fill the window before measuring
+  {
+    double key = tick/(double)rate;
+    for (int c=0; c<channels; ++c)
+      mPlot->graph(c)->addData(key, c+qSin(key*10+c));
+  }
+  QBENCHMARK_ONCE
+  {
+    for (int i=0; i<rate; ++i, ++tick) // one second of streamed data
+    {
+      double key = tick/(double)rate;
+      for (int c=0; c<channels; ++c)
+      {
+        mPlot->graph(c)->addData(key, c+qSin(key*10+c));
+        mPlot->graph(c)->removeDataBefore(key-window);
+      }
+      if (i % (rate/20) == 0)
+      {
+        mPlot->xAxis->setRange(key, window, Qt::AlignRight);
+        mPlot->replot();
+      }
+    }
+  }
+}
+
+void Benchmark::QCPCurve_Streaming()
+{
+  // 32 trajectories sampled at 1 kHz, showing the last 10 seconds, replotted at 20 Hz:
+  const int channels = 32;
+  const int rate = 1000;
+  const double window = 10;
+  QList<QCPCurve*> curves;
+  for (int c=0; c<channels; ++c)
+  {
+    QCPCurve *curve = new QCPCurve(mPlot->xAxis, mPlot->yAxis);
+    mPlot->addPlottable(curve);
+    curve->data()->setCapacity(window*rate);
+    curves.append(curve);
+  }
+  mPlot->xAxis->setRange(-1.5, 1.5);
+  mPlot->yAxis->setRange(-1.5, 1.5);
+  
+  int tick = 0;
+  for (; tick<window*rate; ++tick) // fill the window before measuring
+  {
+    double t = tick/(double)rate;
+    for (int c=0; c<channels; ++c)
+      curves.at(c)->addData(t, qCos(t*(1+c*0.1)), qSin(t*(2+c*0.1)));
+  }
+  QBENCHMARK_ONCE
+  {
+    for (int i=0; i<rate; ++i, ++tick) // one second of streamed data
+    {
+      double t = tick/(double)rate;
+      for (int c=0; c<channels; ++c)
+      {
+        curves.at(c)->addData(t, qCos(t*(1+c*0.1)), qSin(t*(2+c*0.1)));
+        curves.at(c)->removeDataBefore(t-window);
+      }
+      if (i % (rate/20) == 0)
+        mPlot->replot();
+    }
+  }
+}
+
+void Benchmark::QCPGraph_SelectTest()
+{
+  // hover tracking over a dense graph, data and axes stay unchanged between mouse moves:
+  QCPGraph *graph = mPlot->addGraph();
+  int n = 1000000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i] = i/(double)n;
+    y[i] = qSin(x[i]*10*M_PI)+qCos(x[i]*1000*M_PI)*0.2;
+  }
+  graph->setData(x, y);
+  mPlot->rescaleAxes();
+  mPlot->replot();
+  
+  int mouseX = 0;
+  QBENCHMARK
+  {
+    graph->selectTest(QPointF(mouseX % 640, 180), false);
+    ++mouseX;
+  }
+}
+
+void Benchmark::QCPGraph_ParallelPreparation_data()
+{
+  QTest::addColumn<int>("threads");
+  QTest::newRow("1 thread") << 1;
+  QTest::newRow("2 threads") << 2;
+  QTest::newRow("4 threads") << 4;
+  QTest::newRow("8 threads") << 8;
+}
+
+void Benchmark::QCPGraph_ParallelPreparation()
+{
+  QFETCH(int, threads);
+  int oldMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+  QThreadPool::globalInstance()->setMaxThreadCount(threads);
+  mPlot->setPlottingHint(QCP::phParallelPreparation, true);
+  
+  // 40 graphs with dense data, adaptive sampling is on by default:
+  int n = 200000;
+  QVector<double> x(n), y(n);
+  for (int g=0; g<40; ++g)
+  {
+    for (int i=0; i<n; ++i)
+    {
+      x[i] = i/(double)n;
+      y[i] = g+qSin(x[i]*(10+g)*M_PI)+qCos(x[i]*1000*M_PI)*0.3;
+    }
+    mPlot->addGraph()->setData(x, y);
+  }
+  mPlot->rescaleAxes();
+  
+  QBENCHMARK
+  {
+    mPlot->xAxis->moveRange(0.001); // change the key range so the graphs can't reuse their cached plot data
+    mPlot->replot();
+  }
+  
+  QThreadPool::globalInstance()->setMaxThreadCount(oldMaxThreadCount);
+}
+
+void Benchmark::QCPLayer_BufferedReplot()
+{
+  // static dense graphs on a buffered layer, only a tracer on a layer above moves between replots:
+  mPlot->layer("main")->setMode(QCPLayer::lmBuffered);
+  int n = 100000;
+  QVector<double> x(n), y(n);
+  for (int g=0; g<20; ++g)
+  {
+    for (int i=0; i<n; ++i)
+    {
+      x[i] = i/(double)n;
+      y[i] = g+qSin(x[i]*(10+g)*M_PI)+qCos(x[i]*1000*M_PI)*0.3;
+    }
+    mPlot->addGraph()->setData(x, y);
+  }
+  mPlot->rescaleAxes();
+  mPlot->addLayer("overlay");
+  QCPItemTracer *tracer = new QCPItemTracer(mPlot);
+  mPlot->addItem(tracer);
+  tracer->setLayer("overlay");
+  tracer->setGraph(mPlot->graph(0));
+  mPlot->replot();
+  
+  int step = 0;
+  QBENCHMARK
+  {
+    tracer->setGraphKey((step % 1000)/1000.0);
+    mPlot->replot();
+    ++step;
+  }
+}
+
+void Benchmark::QCPLayer_LayerReplot()
+{
+  // like QCPLayer_BufferedReplot, but only the overlay layer is replotted, without layout update:
+  foreach (QString name, QStringList() << "background" << "grid" << "main" << "axes" << "legend")
+    mPlot->layer(name)->setMode(QCPLayer::lmBuffered);
+  int n = 100000;
+  QVector<double> x(n), y(n);
+  for (int g=0; g<20; ++g)
+  {
+    for (int i=0; i<n; ++i)
+    {
+      x[i] = i/(double)n;
+      y[i] = g+qSin(x[i]*(10+g)*M_PI)+qCos(x[i]*1000*M_PI)*0.3;
+    }
+    mPlot->addGraph()->setData(x, y);
+  }
+  mPlot->rescaleAxes();
+  mPlot->addLayer("overlay");
+  QCPLayer *overlay = mPlot->layer("overlay");
+  overlay->setMode(QCPLayer::lmBuffered);
+  QCPItemTracer *tracer = new QCPItemTracer(mPlot);
+  mPlot->addItem(tracer);
+  tracer->setLayer(overlay);
+  tracer->setGraph(mPlot->graph(0));
+  mPlot->replot();
+  
+  int step = 0;
+  QBENCHMARK
+  {
+    tracer->setGraphKey((step % 1000)/1000.0);
+    overlay->replot();
+    ++step;
+  }
+}
+
+void Benchmark::QCPLayout_DataOnlyReplot()
+{
+  // only plottable data changes between replots, so the layout (title, legend, margins) stays the same:
+  mPlot->plotLayout()->insertRow(0);
+  mPlot->plotLayout()->addElement(0, 0, new QCPPlotTitle(mPlot, "Data only replot"));
+  mPlot->legend->setVisible(true);
+  int n = 100;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+    x[i] = i/(double)n;
+  for (int g=0; g<20; ++g)
+    mPlot->addGraph()->setName(QString("Graph number %1").arg(g));
+  mPlot->xAxis->setRange(0, 1);
+  mPlot->yAxis->setRange(-2, 22);
+  mPlot->replot();
+  int iteration = 0;
+  QBENCHMARK
+  {
+    for (int g=0; g<mPlot->graphCount(); ++g)
+    {
+      for (int i=0; i<n; ++i)
+        y[i] = g+qSin((x[i]+iteration*0.01)*(10+g)*M_PI);
+      mPlot->graph(g)->setData(x, y);
+    }
+    mPlot->replot();
+    ++iteration;
+  }
+}
+
 void Benchmark::QCPAxis_TickLabels()
 {
   mPlot->setPlottingHint(QCP::phCacheLabels, false);
@@ -287,3 +544,279 @@ void Benchmark::QCPAxis_TickLabelsCached()
     mPlot->replot();
   }
 }
+
+void Benchmark::QCPAxis_TickLabelsPanning()
+{
+  mPlot->axisRect()->setupFullAxesBox();
+  mPlot->xAxis2->setTickLabels(true);
+  mPlot->yAxis2->setTickLabels(true);
+  mPlot->xAxis2->setTickLabelType(QCPAxis::ltDateTime);
+  mPlot->xAxis2->setDateTimeFormat("dd.MM.yy\nhh:mm:ss");
+  mPlot->xAxis->setRange(-10, 10);
+  mPlot->yAxis->setRange(0.001, 0.002);
+  mPlot->xAxis2->setRange(1.4e9, 1.4e9+3600);
+  mPlot->yAxis2->setRange(-1e100, 1e100);
+  mPlot->replot();
+  QBENCHMARK
+  {
+    // simulates a range drag, which shifts the ticks but keeps the tick step:
+    mPlot->xAxis->moveRange(mPlot->xAxis->range().size()*0.01);
+    mPlot->yAxis->moveRange(mPlot->yAxis->range().size()*0.01);
+    mPlot->xAxis2->moveRange(mPlot->xAxis2->range().size()*0.01);
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPAxis_DateTimeTickLabels()
+{
+  mPlot->axisRect()->setupFullAxesBox();
+  QList<QCPAxis*> axes = mPlot->axisRect()->axes();
+  for (int i=0; i<axes.size(); ++i)
+  {
+    axes.at(i)->setTickLabels(true);
+    axes.at(i)->setTickLabelType(QCPAxis::ltDateTime);
+    axes.at(i)->setDateTimeFormat("dd.MM.yy\nhh:mm:ss.zzz");
+    axes.at(i)->setAutoTickCount(12);
+  }
+  int iteration = 0;
+  QBENCHMARK
+  {
+    // zooming changes the tick step, so every label has to be formatted anew:
+    for (int i=0; i<axes.size(); ++i)
+      axes.at(i)->setRange(1.4e9, 1.4e9+3600*(1+iteration%5));
+    mPlot->replot();
+    ++iteration;
+  }
+}
+
+void Benchmark::QCPColorGradient_Colorize_data()
+{
+  QTest::addColumn<bool>("periodic");
+  QTest::addColumn<bool>("logarithmic");
+  QTest::newRow("linear") << false << false;
+  QTest::newRow("periodic") << true << false;
+  QTest::newRow("logarithmic") << false << true;
+}
+
+void Benchmark::QCPColorGradient_Colorize()
+{
+  QFETCH(bool, periodic);
+  QFETCH(bool, logarithmic);
+  
+  // colorize a 4096x256 slice of a spectrogram, row by row like QCPColorMap::updateMapImage:
+  int keySize = 4096;
+  int valueSize = 256;
+  QVector<double> data(keySize*valueSize);
+  for (int i=0; i<data.size(); ++i)
+    data[i] = 1.0+qAbs(qSin(i*0.001)*qCos(i*0.37))*1000;
+  QVector<QRgb> scanLine(keySize);
+  QCPColorGradient gradient(QCPColorGradient::gpSpectrum);
+  gradient.setPeriodic(periodic);
+  QCPRange range(1, 1001);
+  QBENCHMARK
+  {
+    for (int row=0; row<valueSize; ++row)
+      gradient.colorize(data.constData()+row*keySize, range, scanLine.data(), keySize, 1, logarithmic);
+  }
+}
+
+void Benchmark::QCPColorMap_UpdateMapImage_data()
+{
+  QTest::addColumn<int>("threads");
+  QTest::newRow("1 thread") << 1;
+  QTest::newRow("2 threads") << 2;
+  QTest::newRow("4 threads") << 4;
+  QTest::newRow("8 threads") << 8;
+}
+
+void Benchmark::QCPColorMap_UpdateMapImage()
+{
+  QFETCH(int, threads);
+  int oldMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+  QThreadPool::globalInstance()->setMaxThreadCount(threads);
+  
+  // 2048x2048 cell heatmap, the data range changes every replot so the map image must be recolorized:
+  QCPColorMap *colorMap = new QCPColorMap(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(colorMap);
+  int n = 2048;
+  colorMap->data()->setSize(n, n);
+  colorMap->data()->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  for (int x=0; x<n; ++x)
+    for (int y=0; y<n; ++y)
+      colorMap->data()->setCell(x, y, qSin(x*0.01)*qCos(y*0.013));
+  colorMap->setGradient(QCPColorGradient::gpJet);
+  mPlot->rescaleAxes();
+  
+  int step = 0;
+  QBENCHMARK
+  {
+    colorMap->setDataRange(QCPRange(-1, 1+(step % 10)*0.01));
+    mPlot->replot();
+    ++step;
+  }
+  
+  QThreadPool::globalInstance()->setMaxThreadCount(oldMaxThreadCount);
+}
+
+void Benchmark::QCPColorMap_Waterfall()
+{
+  // spectrogram waterfall with 2048 frequency bins and 1024 frames, a new frame is added every replot:
+  QCPColorMap *colorMap = new QCPColorMap(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(colorMap);
+  int bins = 2048;
+  int frames = 1024;
+  colorMap->data()->setSize(bins, frames);
+  colorMap->data()->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  colorMap->setDataRange(QCPRange(-1, 1));
+  colorMap->setGradient(QCPColorGradient::gpJet);
+  mPlot->rescaleAxes();
+  mPlot->replot();
+  
+  QVector<double> spectrum(bins);
+  int frame = 0;
+  QBENCHMARK
+  {
+    for (int i=0; i<bins; ++i)
+      spectrum[i] = qSin(i*0.01+frame*0.1);
+    colorMap->data()->addRow(spectrum.constData());
+    mPlot->replot();
+    ++frame;
+  }
+}
+
+void Benchmark::QCPColorMap_ViewportResampling()
+{
+  // map with 4000x4000 cells in a 640x360 plot, panned horizontally every replot:
+  QCPColorMap *colorMap = new QCPColorMap(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(colorMap);
+  int n = 4000;
+  colorMap->data()->setSize(n, n);
+  colorMap->data()->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  for (int x=0; x<n; ++x)
+    for (int y=0; y<n; ++y)
+      colorMap->data()->setCell(x, y, qSin(x*0.01)*qCos(y*0.013));
+  colorMap->setDataRange(QCPRange(-1, 1));
+  colorMap->setGradient(QCPColorGradient::gpJet);
+  colorMap->setViewportResampling(QCPColorMap::vrMaximum);
+  mPlot->rescaleAxes();
+  mPlot->xAxis->setRange(0, 0.5);
+  mPlot->replot();
+  
+  QBENCHMARK
+  {
+    mPlot->xAxis->moveRange(0.001);
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPColorMap_CellTypes_data()
+{
+  QTest::addColumn<int>("cellType");
+  QTest::newRow("double") << (int)QCPColorMapData::ctDouble;
+  QTest::newRow("float") << (int)QCPColorMapData::ctFloat;
+  QTest::newRow("uint16") << (int)QCPColorMapData::ctUInt16;
+  QTest::newRow("uint8") << (int)QCPColorMapData::ctUInt8;
+}
+
+void Benchmark::QCPColorMap_CellTypes()
+{
+  QFETCH(int, cellType);
+  
+  // 2048x2048 cell image with 8 bit values, where the gradient is inverted every replot:
+  QCPColorMap *colorMap = new QCPColorMap(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(colorMap);
+  int n = 2048;
+  QCPColorMapData data(n, n, QCPRange(0, 1), QCPRange(0, 1), (QCPColorMapData::CellType)cellType);
+  for (int x=0; x<n; ++x)
+    for (int y=0; y<n; ++y)
+      data.setCell(x, y, (x*31+y*17) % 256);
+  colorMap->setData(&data, true);
+  colorMap->setDataRange(QCPRange(0, 255));
+  colorMap->setGradient(QCPColorGradient::gpJet);
+  mPlot->rescaleAxes();
+  
+  QBENCHMARK
+  {
+    colorMap->setGradient(colorMap->gradient().inverted());
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPColorMap_RescaleDataRangeTracked()
+{
+  // 2048x2048 heatmap where 100 cells change and the data range is rescaled exactly every frame:
+  QCPColorMap *colorMap = new QCPColorMap(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(colorMap);
+  int n = 2048;
+  colorMap->data()->setSize(n, n);
+  colorMap->data()->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  for (int x=0; x<n; ++x)
+    for (int y=0; y<n; ++y)
+      colorMap->data()->setCell(x, y, qSin(x*0.01)*qCos(y*0.013));
+  colorMap->data()->setBoundsTracking(true);
+  
+  int step = 0;
+  QBENCHMARK
+  {
+    for (int i=0; i<100; ++i, ++step)
+      colorMap->data()->setCell((step*7919) % n, (step*104729) % n, qSin(step*0.1)*2);
+    colorMap->rescaleDataRange(true);
+  }
+}
+
+void Benchmark::QCPColorMapData_BulkWrite_data()
+{
+  QTest::addColumn<bool>("bulk");
+  QTest::newRow("setCell") << false;
+  QTest::newRow("setBlock") << true;
+}
+
+void Benchmark::QCPColorMapData_BulkWrite()
+{
+  QFETCH(bool, bulk);
+  
+  // copy a 3840x2160 frame into the map data, cell by cell or as one block:
+  int keySize = 3840;
+  int valueSize = 2160;
+  QCPColorMapData data(keySize, valueSize, QCPRange(0, 1), QCPRange(0, 1));
+  QVector<double> frame(keySize*valueSize);
+  for (int i=0; i<frame.size(); ++i)
+    frame[i] = qSin(i*0.001);
+  
+  QBENCHMARK
+  {
+    if (bulk)
+    {
+      data.setBlock(0, 0, keySize, valueSize, frame.constData());
+    } else
+    {
+      for (int v=0; v<valueSize; ++v)
+        for (int k=0; k<keySize; ++k)
+          data.setCell(k, v, frame.at(v*keySize+k));
+    }
+  }
+}
+
+void Benchmark::QCPColorMap_LogarithmicRecolor()
+{
+  // 2048x2048 heatmap with logarithmic data scale, the data range changes every replot:
+  QCPColorMap *colorMap = new QCPColorMap(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(colorMap);
+  int n = 2048;
+  colorMap->data()->setSize(n, n);
+  colorMap->data()->setRange(QCPRange(0, 1), QCPRange(0, 1));
+  for (int x=0; x<n; ++x)
+    for (int y=0; y<n; ++y)
+      colorMap->data()->setCell(x, y, 1.0+qAbs(qSin(x*0.01)*qCos(y*0.013))*1000);
+  colorMap->setDataScaleType(QCPAxis::stLogarithmic);
+  colorMap->setGradient(QCPColorGradient::gpJet);
+  mPlot->rescaleAxes();
+  
+  int step = 0;
+  QBENCHMARK
+  {
+    colorMap->setDataRange(QCPRange(1, 1001+(step % 10)*10));
+    mPlot->replot();
+    ++step;
+  }
+}
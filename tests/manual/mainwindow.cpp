@@ -926,8 +926,8 @@ void MainWindow::daqPerformanceReplotSlot()
 {
 #if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
   double lastX = 0;
-  if (mCustomPlot->graph(0)->data()->end() != mCustomPlot->graph(0)->data()->begin())
-    lastX = (mCustomPlot->graph(0)->data()->end()-1).key();
+  if (!mCustomPlot->graph(0)->data()->isEmpty())
+    lastX = mCustomPlot->graph(0)->data()->key(mCustomPlot->graph(0)->data()->size()-1);
   mCustomPlot->xAxis->setRange(lastX, 10, Qt::AlignRight);
   mCustomPlot->replot();
   